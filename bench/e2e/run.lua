@@ -0,0 +1,218 @@
+-- Headless end-to-end latency benchmark: source edit to updated asm buffer.
+--
+-- nvim --headless -u NONE -i NONE --cmd 'set rtp^=.' -c 'luafile bench/e2e/run.lua'
+--
+-- Environment:
+--   NEOBOLT_E2E_ITERATIONS  edits per fixture (default 30)
+--   NEOBOLT_E2E_DELAY       stub compiler delay in seconds (default 0.05)
+--   NEOBOLT_E2E_OUTPUT      append tab-separated results here (default bench_e2e_output.txt)
+--   NEOBOLT_E2E_COMMIT      commit ID recorded in the results
+
+local api = vim.api
+local uv = vim.loop
+
+local root = vim.fn.fnamemodify(debug.getinfo(1, 'S').source:sub(2), ':p:h:h:h')
+local stub = root .. '/bench/e2e/stub_compiler.sh'
+
+local ITERATIONS = tonumber(vim.env.NEOBOLT_E2E_ITERATIONS) or 30
+local DELAY = vim.env.NEOBOLT_E2E_DELAY or '0.05'
+local OUTPUT = vim.env.NEOBOLT_E2E_OUTPUT or (root .. '/bench_e2e_output.txt')
+local COMMIT = vim.env.NEOBOLT_E2E_COMMIT or '-'
+local TIMEOUT = 10000
+
+-- source line count -> canned compiler output, roughly matching in size
+local FIXTURES = {
+  { name = 'small', lines = 100, asm = '_bench/gcc-c-hello-O0-g.s' },
+  { name = 'medium', lines = 2000, asm = '_bench/gcc-cpp-iostream-O0-g.s' },
+  { name = 'large', lines = 20000, asm = '_bench/gcc-cpp-templates-O0-g.s' },
+  { name = 'huge', lines = 100000, asm = '_bench/gcc-cpp-templates-O2-g.s' },
+}
+
+local function out(fmt, ...)
+  io.stdout:write(fmt:format(...))
+end
+
+local function percentile(sorted, p)
+  if #sorted == 0 then return 0 end
+  local idx = math.max(1, math.ceil(#sorted * p))
+  return sorted[math.min(idx, #sorted)]
+end
+
+local function summarize(samples)
+  local sorted = vim.deepcopy(samples)
+  table.sort(sorted)
+  return {
+    p50 = percentile(sorted, 0.50),
+    p90 = percentile(sorted, 0.90),
+    p99 = percentile(sorted, 0.99),
+    max = sorted[#sorted] or 0,
+  }
+end
+
+local function make_source(lines)
+  local src = {}
+  for i = 1, lines do
+    if i % 10 == 1 then
+      src[i] = ('int f%d(int x) {'):format(i)
+    elseif i % 10 == 0 then
+      src[i] = '}'
+    else
+      src[i] = ('  x = x * %d + %d;'):format(i % 7 + 1, i)
+    end
+  end
+  return src
+end
+
+-- render completions, keyed by source changedtick
+local rendered = {}
+local Compiler
+
+local function hook_render(compiler)
+  Compiler = getmetatable(compiler)
+  if Compiler._bench_hooked then return end
+  Compiler._bench_hooked = true
+  local render = Compiler.render
+  Compiler.render = function(self, proc, state)
+    render(self, proc, state)
+    rendered[state.changedtick] = uv.hrtime()
+  end
+end
+
+local function wait_rendered(tick)
+  return vim.wait(TIMEOUT, function() return rendered[tick] ~= nil end, 1)
+end
+
+local function run_fixture(fixture)
+  local asm = root .. '/' .. fixture.asm
+  if not uv.fs_stat(asm) then
+    out('%-8s skipped, %s is missing (run make bench first)\n', fixture.name, fixture.asm)
+    return nil
+  end
+
+  vim.cmd('enew!')
+  local src_buf = api.nvim_get_current_buf()
+  vim.bo[src_buf].buftype = 'nofile'
+  api.nvim_buf_set_lines(src_buf, 0, -1, false, make_source(fixture.lines))
+
+  vim.cmd('vnew')
+  local asm_buf = api.nvim_get_current_buf()
+  local compiler = require('neobolt.compiler')._new_compiler(asm_buf, src_buf, {
+    exe = stub,
+    base_args = { asm, DELAY },
+    user_args = {},
+  })
+  hook_render(compiler)
+  compiler:init()
+  vim.cmd('wincmd p')
+  assert(api.nvim_get_current_buf() == src_buf)
+
+  -- initial compile
+  compiler:update()
+  assert(wait_rendered(api.nvim_buf_get_changedtick(src_buf)), 'initial render timed out')
+
+  collectgarbage('collect')
+  local mem_start = collectgarbage('count')
+
+  local latency = {} -- TextChanged -> render, ms
+  local burst = {} -- first of 5 rapid edits -> render of the last one, ms
+  local cursor = {} -- CursorMoved highlight, ms
+
+  for i = 1, ITERATIONS do
+    -- single edit, alternate between inserting and removing a line
+    local row = (i * 7919) % fixture.lines
+    if i % 2 == 1 then
+      api.nvim_buf_set_lines(src_buf, row, row, false, { ('  int bench_%d = %d;'):format(i, i) })
+    else
+      api.nvim_buf_set_lines(src_buf, row, row + 1, false, {})
+    end
+    local ts = uv.hrtime()
+    api.nvim_exec_autocmds('TextChanged', { buffer = src_buf })
+    local tick = api.nvim_buf_get_changedtick(src_buf)
+    assert(wait_rendered(tick), 'render timed out')
+    table.insert(latency, (rendered[tick] - ts) / 1e6)
+
+    -- burst of edits, faster than the compiler
+    local burst_ts = uv.hrtime()
+    for j = 1, 5 do
+      api.nvim_buf_set_lines(src_buf, row, row + 1, false, { ('  x = %d;'):format(i * 10 + j) })
+      api.nvim_exec_autocmds('TextChanged', { buffer = src_buf })
+      vim.wait(20)
+    end
+    tick = api.nvim_buf_get_changedtick(src_buf)
+    assert(wait_rendered(tick), 'burst render timed out')
+    table.insert(burst, (rendered[tick] - burst_ts) / 1e6)
+
+    -- cursor movement in the source buffer highlights the asm
+    api.nvim_win_set_cursor(0, { 1 + (i * 104729) % fixture.lines, 0 })
+    ts = uv.hrtime()
+    api.nvim_exec_autocmds('CursorMoved', { buffer = src_buf })
+    table.insert(cursor, (uv.hrtime() - ts) / 1e6)
+  end
+
+  collectgarbage('collect')
+  local mem_end = collectgarbage('count')
+
+  compiler:destroy()
+  vim.cmd('silent! bwipeout! ' .. asm_buf)
+  vim.cmd('silent! bwipeout! ' .. src_buf)
+
+  return {
+    name = fixture.name,
+    lines = fixture.lines,
+    asm_bytes = uv.fs_stat(asm).size,
+    latency = summarize(latency),
+    burst = summarize(burst),
+    cursor = summarize(cursor),
+    mem_kb = mem_end - mem_start,
+  }
+end
+
+local function main()
+  out('%-8s %8s %10s | %-26s | %-26s | %-26s | %10s\n', 'fixture', 'lines', 'asm bytes',
+    'edit->render p50/p90/p99', 'burst->render p50/p90/p99', 'cursor hl p50/p90/p99', 'mem KiB')
+
+  local results = {}
+  for _, fixture in ipairs(FIXTURES) do
+    local ok, res = pcall(run_fixture, fixture)
+    if not ok then
+      out('%-8s failed: %s\n', fixture.name, res)
+    elseif res then
+      local l, b, c = res.latency, res.burst, res.cursor
+      out('%-8s %8d %10d | %7.1f %7.1f %7.1f ms  | %7.1f %7.1f %7.1f ms  | %6.2f %6.2f %6.2f ms  | %10.1f\n',
+        res.name, res.lines, res.asm_bytes, l.p50, l.p90, l.p99, b.p50, b.p90, b.p99,
+        c.p50, c.p90, c.p99, res.mem_kb)
+      table.insert(results, res)
+    end
+  end
+
+  local new = not uv.fs_stat(OUTPUT)
+  local file = io.open(OUTPUT, 'a')
+  if file then
+    if new then
+      file:write(table.concat({
+        'commit', 'fixture', 'lines', 'asm_bytes', 'delay_s', 'iterations',
+        'edit_p50_ms', 'edit_p90_ms', 'edit_p99_ms', 'edit_max_ms',
+        'burst_p50_ms', 'burst_p90_ms', 'burst_p99_ms', 'burst_max_ms',
+        'cursor_p50_ms', 'cursor_p90_ms', 'cursor_p99_ms', 'cursor_max_ms',
+        'mem_growth_kib',
+      }, '\t') .. '\n')
+    end
+    for _, r in ipairs(results) do
+      file:write(table.concat({
+        COMMIT, r.name, r.lines, r.asm_bytes, DELAY, ITERATIONS,
+        r.latency.p50, r.latency.p90, r.latency.p99, r.latency.max,
+        r.burst.p50, r.burst.p90, r.burst.p99, r.burst.max,
+        r.cursor.p50, r.cursor.p90, r.cursor.p99, r.cursor.max,
+        r.mem_kb,
+      }, '\t') .. '\n')
+    end
+    file:close()
+  end
+end
+
+local ok, err = pcall(main)
+if not ok then
+  out('e2e benchmark failed: %s\n', err)
+  vim.cmd('cquit! 1')
+end
+vim.cmd('qall!')
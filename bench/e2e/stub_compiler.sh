@@ -0,0 +1,15 @@
+#!/bin/sh
+# Stub compiler for the end-to-end benchmark. Replays canned asm after a delay, so
+# the numbers don't depend on how fast the real compiler is.
+#
+# usage: stub_compiler.sh ASM_FILE DELAY_SECONDS [ignored compiler args...]
+
+asm=$1
+delay=$2
+
+# consume the source like a real compiler would
+cat > /dev/null
+if [ "$delay" != "0" ]; then
+  sleep "$delay"
+fi
+exec cat "$asm"
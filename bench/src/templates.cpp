@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Item {
+  std::string name;
+  int weight;
+};
+
+template <typename T, typename F>
+static std::vector<T> filter(const std::vector<T>& in, F pred)
+{
+  std::vector<T> out;
+  std::copy_if(in.begin(), in.end(), std::back_inserter(out), pred);
+  return out;
+}
+
+int run(int n)
+{
+  std::vector<Item> items;
+  for (int i = 0; i < n; ++i)
+    items.push_back({ std::to_string(i), i * 7 % 13 });
+
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+    return a.weight < b.weight;
+  });
+
+  auto heavy = filter(items, [](const Item& it) { return it.weight > 6; });
+
+  std::map<std::string, int> by_name;
+  std::unordered_map<int, std::vector<std::string>> by_weight;
+  for (const auto& it : heavy) {
+    by_name[it.name] = it.weight;
+    by_weight[it.weight].push_back(it.name);
+  }
+
+  std::vector<std::unique_ptr<std::function<int(int)>>> fns;
+  for (int i = 0; i < 4; ++i)
+    fns.push_back(std::make_unique<std::function<int(int)>>([i](int x) { return x * i; }));
+
+  int acc = 0;
+  for (auto& [k, v] : by_weight)
+    for (auto& f : fns)
+      acc += (*f)(k) + static_cast<int>(v.size());
+  return acc + static_cast<int>(by_name.size());
+}
@@ -0,0 +1,368 @@
+-- Microbenchmark of one function of the source, compiled exactly like the asm buffer.
+-- The source becomes a shared object, a generated C harness dlopens it, pins itself
+-- to a cpu, calls the function through a warmup and then times batches of calls.
+-- Median and MAD (median absolute deviation) per call go to the summary header of
+-- the asm buffer, next to the previous and the best run, and every compile of the
+-- buffer runs it again, so regressions show up while editing.
+--
+-- The function is the one after a `// neobolt:bench` comment, or `benchmark`. It gets
+-- called without arguments, and for C++ it can be extern "C" or not.
+
+local api = vim.api
+local uv = vim.loop
+local lib = require('libneobolt')
+local spawn = require('neobolt.spawn')
+local source = require('neobolt.source')
+local options = require('neobolt.options')
+local pch = require('neobolt.pch')
+
+local M = {}
+
+-- kept between runs of a buffer
+local HISTORY = 16
+
+local HARNESS = [[
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__linux__)
+# include <sched.h>
+#endif
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int cmp(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return x < y ? -1 : x > y;
+}
+
+static double median(double* v, int n)
+{
+  qsort(v, (size_t)n, sizeof(*v), cmp);
+  return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+/* harness <so> <symbol> <warmup> <reps> <cpu> <max ms>, prints
+   `ok <median ns> <mad ns> <reps> <calls per rep>` or `error <message>` */
+int main(int argc, char** argv)
+{
+  if (argc != 7) {
+    printf("error usage\n");
+    return 1;
+  }
+  void* so = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  if (!so) {
+    printf("error %s\n", dlerror());
+    return 1;
+  }
+  void (*fn)(void);
+  *(void**)&fn = dlsym(so, argv[2]);
+  if (!fn) {
+    printf("error %s\n", dlerror());
+    return 1;
+  }
+  int warmup = atoi(argv[3]), reps = atoi(argv[4]), cpu = atoi(argv[5]);
+  double max_ns = atof(argv[6]) * 1e6;
+#if defined(__linux__)
+  if (cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+#else
+  (void)cpu;
+#endif
+
+  /* calls per rep, so that a rep takes at least 1ms and timer overhead is noise */
+  long calls = 1;
+  for (;;) {
+    double t = now_ns();
+    for (long i = 0; i < calls; ++i)
+      fn();
+    t = now_ns() - t;
+    if (t >= 1e6 || calls >= (1L << 30))
+      break;
+    calls *= 2;
+  }
+  for (int r = 0; r < warmup; ++r)
+    for (long i = 0; i < calls; ++i)
+      fn();
+
+  double* v = malloc(sizeof(*v) * (size_t)(reps > 0 ? reps : 1));
+  double start = now_ns();
+  int n = 0;
+  while (n < reps) {
+    double t = now_ns();
+    for (long i = 0; i < calls; ++i)
+      fn();
+    v[n++] = (now_ns() - t) / (double)calls;
+    if (n >= 5 && now_ns() - start > max_ns)
+      break;
+  }
+  double med = median(v, n);
+  for (int i = 0; i < n; ++i)
+    v[i] = v[i] > med ? v[i] - med : med - v[i];
+  printf("ok %.3f %.3f %d %ld\n", med, median(v, n), n, calls);
+  return 0;
+}
+]]
+
+-- asm buffer -> { history = { { median, mad, reps, calls } }, name?, proc?, token?, error? }
+local benches = {}
+
+local dir = nil
+
+local function work_dir()
+  if not dir then
+    dir = vim.fn.tempname() .. '-neobolt-bench'
+    vim.fn.mkdir(dir, 'p')
+  end
+  return dir
+end
+
+--- Name of the function to time, from the marker comment or `benchmark`
+---@param src string
+---@return string?
+local function find_function(src)
+  local marker = src:find('//%s*neobolt:bench')
+  if marker then
+    -- first identifier followed by a parenthesis after the comment
+    local name = src:match('\n[^(]-([%a_][%w_]*)%s*%(', marker)
+    if name then
+      return name
+    end
+  end
+  if src:find('[^%w_]benchmark%s*%(') or src:find('^benchmark%s*%(') then
+    return 'benchmark'
+  end
+end
+
+--- Symbol of a function in the asm, the mangled one for C++ without arguments
+---@param asm table lib.parse result
+---@param name string
+---@return string
+local function find_symbol(asm, name)
+  local mangled = ('_Z%d%s'):format(#name, name)
+  local fallback = nil
+  for i = 1, #asm.kinds do
+    if asm.kinds:byte(i) == 108 then -- 'l'
+      local label = asm.lines[i]:match('^%s*([^:%s]+):')
+      if label == name or label == mangled .. 'v' then
+        return label
+      elseif label and not fallback and label:sub(1, #mangled) == mangled then
+        fallback = label
+      end
+    end
+  end
+  return fallback or name
+end
+
+local function format_time(ns)
+  if ns < 1e3 then
+    return ('%.2fns'):format(ns)
+  elseif ns < 1e6 then
+    return ('%.3fus'):format(ns / 1e3)
+  elseif ns < 1e9 then
+    return ('%.3fms'):format(ns / 1e6)
+  end
+  return ('%.3fs'):format(ns / 1e9)
+end
+
+--- Summary line of the asm buffer, nil when not benchmarking
+---@param asm_buf integer
+---@param running boolean? A new run is about to start
+---@return string?
+function M.summary(asm_buf, running)
+  local bench = benches[asm_buf]
+  if not bench then
+    return nil
+  end
+  local prefix = '#    bench: '
+  local history = bench.history
+  local last = history[#history]
+  if running and not last then
+    return prefix .. 'running'
+  elseif bench.error and not running then
+    return prefix .. bench.error
+  elseif not last then
+    return prefix .. 'not run, the compile failed'
+  end
+
+  local text = ('%s() %s ±%s (median, MAD of %d×%d calls)'):format(
+    bench.name, format_time(last.median), format_time(last.mad), last.reps, last.calls)
+  local prev = history[#history - 1]
+  if prev then
+    text = text .. (', %+.1f%% vs previous'):format((last.median / prev.median - 1) * 100)
+  end
+  local best = last
+  for _, run in ipairs(history) do
+    if run.median < best.median then
+      best = run
+    end
+  end
+  if best ~= last then
+    text = text .. ', best ' .. format_time(best.median)
+  end
+  return prefix .. text .. (running and ', running' or '')
+end
+
+-- replace the summary line, when the buffer still shows the same render
+local function update_line(compiler, state, row)
+  if compiler:destroyed() or compiler.state ~= state then
+    return
+  end
+  local buf = compiler.asm_buf
+  local undolevels = api.nvim_buf_get_option(buf, 'undolevels')
+  api.nvim_buf_set_option(buf, 'undolevels', -1)
+  api.nvim_buf_set_lines(buf, row, row + 1, false, { M.summary(buf) })
+  api.nvim_buf_set_option(buf, 'undolevels', undolevels)
+end
+
+local function cancel(bench)
+  if bench.proc then
+    bench.proc:abort()
+    bench.proc = nil
+  end
+  bench.token = nil
+end
+
+local function fail(compiler, state, row, bench, msg)
+  bench.proc = nil
+  bench.error = msg
+  update_line(compiler, state, row)
+end
+
+--- Compile and time the source of a compiler, for the render of `state`. The result
+--- replaces the summary line at `row`.
+---@param compiler table
+---@param state table Rendered compiler state
+---@param row integer 0-based row of the summary line from M.summary
+function M.run(compiler, state, row)
+  local asm_buf = compiler.asm_buf
+  local bench = benches[asm_buf]
+  if not bench then
+    return
+  end
+  cancel(bench)
+  bench.error = nil
+
+  local src = source.get(compiler.src_buf)
+  local name = find_function(src)
+  if not name then
+    return fail(compiler, state, row, bench, 'no `// neobolt:bench` function or benchmark()')
+  end
+  bench.name = name
+  local symbol = state.asm and find_symbol(state.asm, name) or name
+  local config = state.config
+  local lang, flags = pch.flags(config)
+  local opts = options.options.bench
+  local work = work_dir()
+  local so = ('%s/%d.so'):format(work, asm_buf)
+  local harness = ('%s/harness-%s'):format(work, lib.hash(config.exe))
+
+  local token = {}
+  bench.token = token
+  local function step(exe, args, input, callback)
+    local proc, err = spawn(exe, args, config.cwd, input, function(proc)
+      if bench.token ~= token then
+        return
+      end
+      bench.proc = nil
+      callback(proc)
+    end)
+    if not proc then
+      return fail(compiler, state, row, bench, ('%s: %s'):format(exe, err))
+    end
+    bench.proc = proc
+  end
+
+  local function time()
+    local cpu = opts.cpu
+    if cpu == nil then
+      cpu = #(uv.cpu_info() or {}) - 1 -- away from nvim, usually
+    end
+    step(harness, { so, symbol, tostring(opts.warmup), tostring(opts.reps),
+      tostring(cpu or -1), tostring(opts.max_time) }, '', function(proc)
+      local median, mad, reps, calls = proc.stdout:match('^ok (%S+) (%S+) (%d+) (%d+)')
+      if not median then
+        local msg = proc.stdout:match('^error ([^\n]*)') or vim.trim(proc.stderr)
+        if msg == '' then
+          msg = ('harness exited with code %d, signal %d'):format(proc.code, proc.signal)
+        end
+        return fail(compiler, state, row, bench, symbol .. ': ' .. msg)
+      end
+      table.insert(bench.history, {
+        median = tonumber(median),
+        mad = tonumber(mad),
+        reps = tonumber(reps),
+        calls = tonumber(calls),
+      })
+      if #bench.history > HISTORY then
+        table.remove(bench.history, 1)
+      end
+      update_line(compiler, state, row)
+    end)
+  end
+
+  local function build_so()
+    local args = vim.list_extend({}, flags)
+    vim.list_extend(args, { '-shared', '-fPIC', '-o', so, '-x', lang or 'c', '-' })
+    step(config.exe, args, src, function(proc)
+      if proc.code ~= 0 then
+        local msg = vim.trim(proc.stderr):match('[^\n]*$')
+        return fail(compiler, state, row, bench, 'shared object: ' .. msg)
+      end
+      time()
+    end)
+  end
+
+  if uv.fs_stat(harness) then
+    build_so()
+    return
+  end
+  local file = io.open(harness .. '.c', 'wb')
+  if not file then
+    return fail(compiler, state, row, bench, 'cannot write ' .. harness .. '.c')
+  end
+  file:write(HARNESS)
+  file:close()
+  -- the compiler under test builds the harness too, the host may not have another
+  step(config.exe, { '-O2', '-x', 'c', harness .. '.c', '-x', 'none', '-o', harness, '-ldl' }, '',
+    function(proc)
+      if proc.code ~= 0 then
+        local msg = vim.trim(proc.stderr):match('[^\n]*$')
+        return fail(compiler, state, row, bench, 'harness: ' .. msg)
+      end
+      build_so()
+    end)
+end
+
+--- Benchmark on every compile of an asm buffer from now on
+---@param asm_buf integer
+function M.enable(asm_buf)
+  benches[asm_buf] = benches[asm_buf] or { history = {} }
+end
+
+--- Stop benchmarking an asm buffer, and forget its results
+---@param asm_buf integer
+function M.detach(asm_buf)
+  local bench = benches[asm_buf]
+  if bench then
+    cancel(bench)
+    benches[asm_buf] = nil
+    if dir then
+      uv.fs_unlink(('%s/%d.so'):format(dir, asm_buf))
+    end
+  end
+end
+
+return M
@@ -0,0 +1,265 @@
+-- Compile result cache. Undo/redo, toggling flags back and forth, or reopening the asm
+-- buffer often recompiles something we have already seen, so results are kept by a
+-- hash of everything that goes into the compiler: source text, executable, arguments
+-- and working directory. Headers are dependencies, checked on every lookup.
+--
+-- Entries are kept in memory, least recently used are evicted when over the size
+-- limit. Optionally they are also written to a directory, and read back on a memory
+-- miss (re-parsed, only compiler output is stored).
+
+local uv = vim.loop
+local lib = require('libneobolt')
+local options = require('neobolt.options')
+
+local M = {}
+
+-- bump when the disk format changes
+local VERSION = 1
+
+---@class neobolt.CacheDep
+---@field [1] string path
+---@field [2] integer mtime seconds
+---@field [3] integer mtime nanoseconds
+---@field [4] integer size
+
+---@class neobolt.Result
+---@field code integer
+---@field signal integer
+---@field time number Compiler run time, in seconds
+---@field stdout string? Compiler output, nil when it was parsed from `fd`
+---@field fd integer? lib.memfd with the compiler output, until parsed
+---@field bytes integer? Compiler output size
+---@field stderr string
+---@field asm table? Parsed output, with normalized paths
+---@field asm_err string?
+---@field parse_time number? Parse time, in seconds
+---@field deps neobolt.CacheDep[]?
+---@field remarks string? Optimization remarks, in lib.remarks_load form
+---@field remarks_pending boolean? Remarks are still being read
+
+-- key -> { result, used }
+local entries = {} ---@type table<string, { result: neobolt.Result, used: integer, size: integer }>
+local total_size = 0
+-- LRU clock
+local clock = 0
+
+local function result_size(result)
+  return (result.bytes or #result.stdout) + #result.stderr + #(result.remarks or '')
+end
+
+local function stat_dep(path)
+  local stat = uv.fs_stat(path)
+  if stat then
+    return { path, stat.mtime.sec, stat.mtime.nsec, stat.size }
+  end
+end
+
+local function deps_valid(deps)
+  for _, dep in ipairs(deps or {}) do
+    local stat = uv.fs_stat(dep[1])
+    if not stat or stat.mtime.sec ~= dep[2] or stat.mtime.nsec ~= dep[3] or stat.size ~= dep[4] then
+      return false
+    end
+  end
+  return true
+end
+
+local function disk_path(key)
+  local dir = options.options.cache.dir
+  return dir and (dir .. '/' .. key .. '.mpack')
+end
+
+local function evict(key)
+  local entry = entries[key]
+  if entry then
+    total_size = total_size - entry.size
+    entries[key] = nil
+  end
+end
+
+local function evict_lru(limit)
+  while total_size > limit do
+    local lru_key, lru_used = nil, math.huge
+    for key, entry in pairs(entries) do
+      if entry.used < lru_used then
+        lru_key, lru_used = key, entry.used
+      end
+    end
+    if not lru_key then break end
+    evict(lru_key)
+  end
+end
+
+--- Cache key for a compile, nil when caching is disabled or the compiler is missing
+---@param config { cwd: string, exe: string, base_args: string[], user_args: string[], uarch: string?, remarks: string? }
+---@param src string Compiler input
+---@return string?
+function M.key(config, src)
+  if not options.options.cache.enabled then
+    return nil
+  end
+  -- a rebuilt or upgraded compiler has a new mtime
+  local stat = uv.fs_stat(config.exe)
+  if not stat then
+    return nil
+  end
+  return lib.hash(
+    config.exe,
+    ('%d.%d'):format(stat.mtime.sec, stat.mtime.nsec),
+    config.cwd,
+    table.concat(config.base_args, '\0'),
+    table.concat(config.user_args, '\0'),
+    config.uarch or '',
+    config.remarks or '',
+    src)
+end
+
+local function read_disk(key)
+  local path = disk_path(key)
+  if not path then return nil end
+  local file = io.open(path, 'rb')
+  if not file then return nil end
+  local data = file:read('*a')
+  file:close()
+
+  local ok, obj = pcall(vim.mpack.decode, data)
+  if not ok or type(obj) ~= 'table' or obj.version ~= VERSION then
+    os.remove(path)
+    return nil
+  end
+  return {
+    code = obj.code,
+    signal = obj.signal,
+    time = obj.time,
+    stdout = obj.stdout,
+    stderr = obj.stderr,
+    deps = obj.deps,
+    remarks = obj.remarks,
+  }
+end
+
+-- remove oldest files over the limit
+local function prune_disk(dir, max_files)
+  local files = {}
+  local handle = uv.fs_scandir(dir)
+  while handle do
+    local name, kind = uv.fs_scandir_next(handle)
+    if not name then break end
+    if kind == 'file' and name:find('%.mpack$') then
+      local stat = uv.fs_stat(dir .. '/' .. name)
+      if stat then
+        table.insert(files, { dir .. '/' .. name, stat.mtime.sec })
+      end
+    end
+  end
+  if #files <= max_files then return end
+  table.sort(files, function(a, b) return a[2] < b[2] end)
+  for i = 1, #files - max_files do
+    uv.fs_unlink(files[i][1])
+  end
+end
+
+local function write_disk(key, result)
+  local path = disk_path(key)
+  -- output parsed straight from memory isn't kept around
+  if not path or not result.stdout then return end
+  local dir = options.options.cache.dir
+  vim.fn.mkdir(dir, 'p')
+  local data = vim.mpack.encode({
+    version = VERSION,
+    code = result.code,
+    signal = result.signal,
+    time = result.time,
+    stdout = result.stdout,
+    stderr = result.stderr,
+    deps = result.deps or {},
+    remarks = result.remarks,
+  })
+  -- write in the background, rename so readers never see partial files
+  local tmp = ('%s.%d.tmp'):format(path, uv.os_getpid())
+  uv.fs_open(tmp, 'w', 420, function(err, fd)
+    if err then return end
+    uv.fs_write(fd, data, 0, function(write_err)
+      uv.fs_close(fd, function()
+        if write_err then
+          uv.fs_unlink(tmp, function() end)
+        else
+          uv.fs_rename(tmp, path, function()
+            vim.schedule(function()
+              prune_disk(dir, options.options.cache.max_files)
+            end)
+          end)
+        end
+      end)
+    end)
+  end)
+end
+
+--- Look up a result. Results read from disk aren't parsed yet, `asm` and `asm_err`
+--- are both nil.
+---@param key string
+---@return neobolt.Result?
+function M.get(key)
+  local entry = entries[key]
+  local result = entry and entry.result
+  if not result then
+    result = read_disk(key)
+    if not result then return nil end
+  end
+
+  if not deps_valid(result.deps) then
+    evict(key)
+    local path = disk_path(key)
+    if path then os.remove(path) end
+    return nil
+  end
+
+  if entry then
+    clock = clock + 1
+    entry.used = clock
+  end
+  return result
+end
+
+--- Store a result. Files referenced by `.file` directives become dependencies.
+---@param key string
+---@param result neobolt.Result
+---@param persist boolean? Also write it to the cache directory
+function M.put(key, result, persist)
+  local opts = options.options.cache
+  if not opts.enabled then return end
+
+  if not result.deps then
+    result.deps = {}
+    for _, path in ipairs(result.asm and result.asm.files or {}) do
+      -- skip <stdin>, <built-in> and such
+      if path:sub(1, 1) ~= '<' then
+        local dep = stat_dep(path)
+        if dep then
+          table.insert(result.deps, dep)
+        end
+      end
+    end
+  end
+
+  local size = result_size(result)
+  if size > opts.max_bytes then return end
+  evict(key)
+  evict_lru(opts.max_bytes - size)
+
+  clock = clock + 1
+  entries[key] = { result = result, used = clock, size = size }
+  total_size = total_size + size
+
+  if persist then
+    write_disk(key, result)
+  end
+end
+
+--- Drop all in-memory entries
+function M.clear()
+  entries = {}
+  total_size = 0
+end
+
+return M
@@ -51,6 +51,7 @@ local function make_opts(name, config, args)
     exe = path,
     base_args = base_args,
     user_args = user_args,
+    probe_debug = config.probe_debug,
   }
 end
 
@@ -3,6 +3,21 @@ local fn = vim.fn
 local uv = vim.loop
 
 local spawn = require('neobolt.spawn')
+local trace = require('neobolt.trace')
+local cache = require('neobolt.cache')
+local scheduler = require('neobolt.scheduler')
+local preprocess = require('neobolt.preprocess')
+local pch = require('neobolt.pch')
+local source = require('neobolt.source')
+local options = require('neobolt.options')
+local probe = require('neobolt.probe')
+local uarch = require('neobolt.uarch')
+local mca = require('neobolt.mca')
+local profile = require('neobolt.profile')
+local bench = require('neobolt.bench')
+local remarks = require('neobolt.remarks')
+local layout = require('neobolt.layout')
+local diff = require('neobolt.diff')
 local Registry = require('neobolt.registry')
 
 local lib_ok, lib = pcall(require, 'libneobolt')
@@ -12,7 +27,7 @@ if not lib_ok then
     {'neobolt: libneobolt module is missing! Run `make` in neobolt plugin directory.', 'ErrorMsg'},
   }, true, {})
   error(lib)
-elseif lib.VERSION ~= 0 then
+elseif lib.VERSION ~= 1 then
   api.nvim_echo({
     {'neobolt: Incompatible libneobolt version! Run `make` in neobolt plugin directory.', 'ErrorMsg'},
   }, true, {})
@@ -20,9 +35,14 @@ elseif lib.VERSION ~= 0 then
 end
 
 
--- TODO: try to make the time adaptive. maybe the first change should start compiling
---       instantly, and only if more changes happen during that, it can start debouncing
+-- debounce time in ms, until we know how long the compiler takes. after that the
+-- first change compiles instantly, and further changes wait between DEBOUNCE_MIN and
+-- DEBOUNCE_MAX, longer when compiles are slower than the user types.
 local DEBOUNCE = 100
+local DEBOUNCE_MIN = 20
+local DEBOUNCE_MAX = 1000
+-- weight of the newest sample in latency averages
+local EWMA_ALPHA = 0.25
 
 
 local t_insert = table.insert
@@ -34,7 +54,6 @@ local w_set_cursor = api.nvim_win_set_cursor
 local b_get = api.nvim_get_current_buf
 local b_valid = api.nvim_buf_is_valid
 local b_changedtick = api.nvim_buf_get_changedtick
-local b_get_lines = api.nvim_buf_get_lines
 local b_set_lines = api.nvim_buf_set_lines
 local b_get_opt = api.nvim_buf_get_option
 local b_set_opt = api.nvim_buf_set_option
@@ -60,6 +79,15 @@ local NS = api.nvim_create_namespace('neobolt')
 -- only for extmarks with associated source locations
 local NS_LOC = api.nvim_create_namespace('neobolt_loc')
 
+api.nvim_set_hl(0, 'NeoboltLoopBody', { link = 'LineNr', default = true })
+api.nvim_set_hl(0, 'NeoboltLoopHeader', { link = 'Title', default = true })
+api.nvim_set_hl(0, 'NeoboltBackEdge', { link = 'WarningMsg', default = true })
+api.nvim_set_hl(0, 'NeoboltCost', { link = 'Comment', default = true })
+api.nvim_set_hl(0, 'NeoboltMix', { link = 'Comment', default = true })
+api.nvim_set_hl(0, 'NeoboltFrame', { link = 'Comment', default = true })
+api.nvim_set_hl(0, 'NeoboltSpill', { link = 'Comment', default = true })
+api.nvim_set_hl(0, 'NeoboltLoopSpill', { link = 'DiffDelete', default = true })
+
 
 local function normalize_bufnr(bufnr)
   if bufnr == nil or bufnr == 0 then
@@ -91,12 +119,23 @@ local g_asm_hls = {}
 local Compiler = {}
 Compiler.__index = Compiler
 
+local function ewma(avg, sample)
+  if avg == nil then
+    return sample
+  end
+  return avg + EWMA_ALPHA * (sample - avg)
+end
+
 local function new_state()
   return {
     -- source buffer changedtick
     changedtick = nil, ---@type integer?
     -- source buffer changenr
     changenr = nil, ---@type integer?
+    -- uv.hrtime of the first source change that led to this state, for tracing
+    ts_changed = nil, ---@type number?
+    -- rendered from the compile cache
+    cached = false,
 
     config = {
       -- working directory
@@ -107,6 +146,10 @@ local function new_state()
       base_args = {},
       -- user provided arguments
       user_args = {},
+      -- cost model for cycle estimates, nil when disabled
+      uarch = nil, ---@type string?
+      -- compiler family for optimization remark flags, nil when disabled
+      remarks = nil, ---@type string?
     },
 
     -- maps extmark ids onto {file, line, column} tuples
@@ -115,6 +158,9 @@ local function new_state()
     loc_to_mark = {},
     -- currently highlighted marks in asm buffer
     asm_hls = {}, ---@type integer[]
+    -- rendered lib.parse result, and the 0-based row before its first line
+    asm = nil, ---@type table?
+    asm_row = 0,
   }
 end
 
@@ -145,19 +191,41 @@ local function new_compiler(asm_buf, src_buf, opts)
       base_args = vim.deepcopy(opts.base_args),
       -- user provided arguments
       user_args = vim.deepcopy(opts.user_args),
+      -- replace -g with probed debug flags
+      probe_debug = opts.probe_debug or false,
     },
 
     changed = true,
     in_insert = false,
     user_paused = false, -- TODO: unused, expose it
     debounce = uv.new_timer(),
+    -- uv.hrtime of the first change that wasn't compiled yet, for tracing
+    ts_changed = nil,
+    -- uv.hrtime of the last change
+    ts_last_change = nil,
+    -- moving averages in ms, nil until measured
+    latency = {
+      compile = nil, ---@type number?
+      parse = nil, ---@type number?
+      -- time between changes
+      interval = nil, ---@type number?
+    },
+    -- recompile once the running compiler finishes
+    pending = false,
+    -- set while waiting for shared preprocessor output
+    pp_wait = nil,
 
     -- running compiler process
     proc = nil,
+    -- its output memfd and remarks file, until its callback takes them
+    out_fd = nil,
+    remarks_path = nil,
     -- recreated on every update
     state = new_state(),
     -- array of used autocmd IDs
     autocmds = {},
+    -- instruction mix virtual text in the source buffer, one namespace per compiler
+    ns_mix = api.nvim_create_namespace(('neobolt_mix_%d'):format(asm_buf)),
 
     _destroyed = false,
   }, Compiler)
@@ -188,7 +256,15 @@ function Compiler:init()
 
   autocmd({'TextChanged', 'TextChangedI', 'TextChangedP'}, self.src_buf, function()
     if not self:destroyed() then
+      local now = uv.hrtime()
+      if self.ts_last_change then
+        -- idle gaps would make it look like the user never types fast
+        local interval = math.min((now - self.ts_last_change) / 1e6, DEBOUNCE_MAX)
+        self.latency.interval = ewma(self.latency.interval, interval)
+      end
+      self.ts_last_change = now
       self.changed = true
+      self.ts_changed = self.ts_changed or now
       self:highlight_asm(nil) -- TODO: call update_hls?
       self:schedule_update()
     end
@@ -232,7 +308,53 @@ function Compiler:init()
     end,
   })
 
+  -- llvm-mca on the selected lines, or on the loop under the cursor
+  api.nvim_buf_create_user_command(self.asm_buf, 'NeoboltMca', function(ev)
+    if not self:destroyed() then
+      if ev.range > 0 then
+        mca.run(self.asm_buf, self.state, ev.line1, ev.line2)
+      else
+        mca.run(self.asm_buf, self.state, w_get_cursor(0)[1])
+      end
+    end
+  end, { range = true })
+
+  -- perf samples from a dump, kept across recompiles. no argument removes them
+  api.nvim_buf_create_user_command(self.asm_buf, 'NeoboltPerf', function(ev)
+    if self:destroyed() then
+      return
+    elseif ev.args == '' then
+      profile.detach(self.asm_buf)
+      return
+    end
+    profile.load(self.asm_buf, ev.args, function()
+      if not self:destroyed() and self.state.asm then
+        profile.render(self.asm_buf, self.state.asm, self.state.asm_row)
+      end
+    end)
+  end, { nargs = '?', complete = 'file' })
+
+  -- time a function of the source on every compile. `off` stops
+  api.nvim_buf_create_user_command(self.asm_buf, 'NeoboltBench', function(ev)
+    if self:destroyed() then
+      return
+    elseif ev.args == 'off' then
+      bench.detach(self.asm_buf)
+    else
+      bench.enable(self.asm_buf)
+    end
+    self:update()
+  end, { nargs = '?', complete = function() return { 'off' } end })
+
+  -- side-by-side diff against another asm buffer of the same source
+  api.nvim_buf_create_user_command(self.asm_buf, 'NeoboltDiff', function(ev)
+    if not self:destroyed() then
+      diff.pick(self, tonumber(ev.args))
+    end
+  end, { nargs = '?' })
+
   Registry.register(self)
+  source.attach(self.src_buf)
 end
 
 
@@ -241,6 +363,7 @@ function Compiler:destroy()
   self._destroyed = true
 
   Registry.unregister(self)
+  source.detach(self.src_buf)
 
   -- close debounce timer
   if self.debounce then
@@ -250,9 +373,15 @@ function Compiler:destroy()
   end
 
   -- kill running process
-  if self.proc then
-    self.proc:abort()
-    self.proc = nil
+  self:abort()
+  mca.detach(self.asm_buf)
+  profile.detach(self.asm_buf)
+  bench.detach(self.asm_buf)
+  remarks.detach(self.asm_buf, self.src_buf)
+  layout.detach(self.asm_buf)
+  diff.detach(self)
+  if b_valid(self.src_buf) then
+    b_del_marks(self.src_buf, self.ns_mix, 0, -1)
   end
 
   -- remove all autocmds
@@ -279,18 +408,159 @@ function Compiler:destroyed()
 end
 
 
-function Compiler:update()
-  -- kill currently running process
+local function trace_proc(proc, tid)
+  if not trace.enabled() then return end
+  trace.span(tid, 'spawn', proc.ts_start, proc.ts_spawned)
+  trace.span(tid, 'compiler', proc.ts_start, proc.ts_exit, {
+    exe = proc.exe,
+    code = proc.code,
+    signal = proc.signal,
+    stdout = #proc.stdout,
+  })
+  trace.instant(tid, 'first stdout byte', proc.ts_first_byte)
+  trace.instant(tid, 'process exit', proc.ts_exit)
+end
+
+--- Replace -g with other debug flags
+---@param args string[]
+---@param debug_args string[]
+---@return string[]
+local function replace_debug_args(args, debug_args)
+  local res = {}
+  for _, arg in ipairs(args) do
+    if arg == '-g' then
+      vim.list_extend(res, debug_args)
+    else
+      t_insert(res, arg)
+    end
+  end
+  return res
+end
+
+--- Point `-o -` at fd 3 of the compiler, an in-memory file that libneobolt maps
+--- directly, so the output never goes through a pipe and Lua strings.
+---@param args string[]
+---@return string[] args
+---@return integer? fd
+local function output_to_memfd(args)
+  if not options.options.memfd or not lib.memfd then
+    return args
+  end
+  for i = 1, #args - 1 do
+    if args[i] == '-o' and args[i + 1] == '-' then
+      local fd = lib.memfd()
+      if not fd then
+        return args
+      end
+      local res = vim.list_slice(args)
+      res[i + 1] = '/proc/self/fd/3'
+      return res, fd
+    end
+  end
+  return args
+end
+
+--- Parse compiler output into `result.asm` (or `result.asm_err`), with file paths
+--- normalized and resolved in locations. Results are cached, so this must not depend
+--- on the buffers it gets rendered into.
+---@param result neobolt.Result
+---@param tid integer Trace track
+---@param cost_model string? Microarchitecture for cycle estimates, part of the cache key
+local function parse_result(result, tid, cost_model)
+  local tracing = trace.enabled()
+
+  -- TODO: option to disable filtering
+  local parse_time = uv.hrtime()
+  -- TODO: should this run on a separate thread?
+  -- c and c++ translation units should be generally small. but zig's hello world is
+  -- already ~4 MB, and right now it parses in about ~20-15ms, so ~200-260 MiB/s.
+  -- this is still acceptable, but if it takes any longer then it becomes a problem.
+  -- not sure how big input should i reasonably expect. i could optimize it and halve
+  -- the running time or more probably, but maybe making this async is just the safest
+  -- option.
+  -- blocks and loops are cheap next to the rest, get them even when they aren't
+  -- shown so cached results don't depend on options
+  local parse_opts = { trace = tracing, cfg = true, mix = true, frames = true, uarch = cost_model }
+  local asm, asm_err
+  if result.fd then
+    asm, asm_err = lib.parse_fd(result.fd, parse_opts)
+    lib.close(result.fd)
+    result.fd = nil
+    result.bytes = asm and asm.bytes or 0
+  else
+    asm, asm_err = lib.parse(result.stdout, parse_opts)
+    result.bytes = #result.stdout
+  end
+  if tracing then
+    trace.span(tid, 'lib.parse', parse_time, uv.hrtime(), { bytes = result.bytes })
+    -- C timestamps are in microseconds of the same monotonic clock
+    for _, span in ipairs(asm and asm.trace or {}) do
+      trace.span(tid, span[1], span[2] * 1e3, (span[2] + span[3]) * 1e3)
+    end
+  end
+
+  local ts_normalize = uv.hrtime()
+  if asm then
+    -- normalize paths
+    for i, path in ipairs(asm.files) do
+      -- TODO: there is also "<built-in>", check wtf is that
+      if path ~= '<stdin>' then
+        asm.files[i] = fn.fnamemodify(path, ':p')
+      end
+    end
+
+    -- replace file IDs with paths
+    for _, loc in ipairs(asm.locations) do
+      loc[1] = asm.files[loc[1]]
+    end
+  end
+  trace.span(tid, 'normalize paths', ts_normalize, uv.hrtime())
+
+  result.asm, result.asm_err = asm, asm_err
+  result.parse_time = (uv.hrtime() - parse_time) / 1e+9
+end
+
+
+--- Kill the running compiler, if any
+function Compiler:abort()
   if self.proc then
+    -- spawn closes the memfd of a compiler it kills, not of one that already exited
+    if self.out_fd and self.proc.code ~= nil then
+      lib.close(self.out_fd)
+    end
     self.proc:abort()
     self.proc = nil
   end
+  self.out_fd = nil
+  if self.remarks_path then
+    os.remove(self.remarks_path)
+    self.remarks_path = nil
+  end
+  self.pp_wait = nil
+  scheduler.cancel(self)
+end
+
+--- Compile the current source. Starts when the scheduler has a free slot and the
+--- asm buffer is visible, repeated calls before that are coalesced.
+function Compiler:update()
+  self:abort()
+  self.pending = false
 
   if self:destroyed() then
     return
   end
 
   self.changed = false
+  scheduler.submit(self)
+end
+
+--- Start the compiler now, called by the scheduler. Must always end with
+--- scheduler.finished(), unless aborted.
+function Compiler:start()
+  if self:destroyed() then
+    scheduler.finished(self)
+    return
+  end
 
   -- TODO: expose the status to the user, so they can have a nice statusline or whatever
 
@@ -301,86 +571,370 @@ function Compiler:update()
   assert(state.config.exe and state.config.exe ~= '', 'invalid executable') -- TODO: error handling
   state.config.base_args = vim.deepcopy(self.config.base_args)
   state.config.user_args = vim.deepcopy(self.config.user_args)
+  if self.config.probe_debug then
+    -- plain -g until probing finishes
+    local info = probe.get(state.config.exe)
+    if info then
+      state.config.base_args = replace_debug_args(state.config.base_args, info.debug_args)
+    end
+  end
+  state.config.uarch = uarch.get(state.config)
+  state.config.remarks = remarks.family(state.config)
 
   state.changedtick = b_changedtick(self.src_buf)
   state.changenr = b_changenr(self.src_buf)
+  state.ts_changed = self.ts_changed
+  self.ts_changed = nil
 
-  local src = b_get_lines(self.src_buf, 0, -1, false)
-  t_insert(src, '\n')
-  src = t_concat(src, '\n')
+  local src = source.get(self.src_buf)
 
   local args = {}
-  for i = 1, #self.config.base_args do
-    t_insert(args, self.config.base_args[i])
+  for i = 1, #state.config.base_args do
+    t_insert(args, state.config.base_args[i])
   end
-  for i = 1, #self.config.user_args do
-    t_insert(args, self.config.user_args[i])
+  for i = 1, #state.config.user_args do
+    t_insert(args, state.config.user_args[i])
+  end
+
+  -- same input compiled before, skip the compiler
+  local key = cache.key(state.config, src)
+  local result = key and cache.get(key)
+  if result then
+    if not result.asm and not result.asm_err then
+      -- read from disk, keep it in memory from now on
+      parse_result(result, self.asm_buf, state.config.uarch)
+      cache.put(key, result, false)
+    end
+    trace.instant(self.asm_buf, 'cache hit', uv.hrtime(), { key = key })
+    state.cached = true
+    scheduler.finished(self)
+    self:render(result, state)
+    return
   end
 
-  -- TODO: limit the number of max parallel jobs. eg when you have multiple compilers
-  --       attached to a single source buffer
   -- TODO: handle errors
   -- TODO: timeout
-  self.proc = spawn(state.config.exe, args, state.config.cwd, src, function(proc)
-    if self.proc == proc then
-      self.proc = nil
+  local function compile(compile_args, input, pp, pch_key)
+    local out_fd, remarks_path
+    compile_args, remarks_path = remarks.args(state.config, compile_args)
+    compile_args, out_fd = output_to_memfd(compile_args)
+
+    local spawn_err
+    self.proc, spawn_err = spawn(state.config.exe, compile_args, state.config.cwd, input, function(proc)
+      if self.proc ~= proc then
+        return -- aborted after it exited, abort cleaned up
+      end
+      self.proc, self.out_fd, self.remarks_path = nil, nil, nil
+      scheduler.finished(self)
+      trace_proc(proc, self.asm_buf)
+
+      local res = {
+        code = proc.code,
+        signal = proc.signal,
+        time = proc.time + (pp and pp.time or 0),
+        stdout = not out_fd and proc.stdout or nil,
+        fd = out_fd,
+        stderr = (pp and pp.stderr or '') .. proc.stderr,
+        remarks_pending = remarks_path ~= nil,
+      }
+      parse_result(res, self.asm_buf, state.config.uarch)
+      self.latency.compile = ewma(self.latency.compile, proc.time * 1e3)
+      self.latency.parse = ewma(self.latency.parse, res.parse_time * 1e3)
+      -- killed compilers don't say anything about the input, and a failed compile with
+      -- a PCH may be the PCH's fault. the key doesn't have it, the retry without it
+      -- would hit the cache
+      local cacheable = key and proc.signal == 0 and not (pch_key and proc.code ~= 0)
+      if cacheable and not remarks_path then
+        cache.put(key, res, true)
+      end
+      self:render(res, state)
+
+      -- cached once the remarks are in
+      if remarks_path then
+        remarks.load(remarks_path, function(data)
+          res.remarks, res.remarks_pending = data, nil
+          if cacheable then
+            cache.put(key, res, true)
+          end
+          if not self:destroyed() and self.state == state then
+            remarks.render(self.asm_buf, self.src_buf, state, data)
+          end
+        end)
+      end
+
+      -- source changed while compiling
+      if self.pending then
+        self:update()
+      elseif pch_key and proc.code ~= 0 and pch.rejected(proc.stderr) then
+        -- compiler rejected the PCH, try again without it
+        pch.invalidate(pch_key)
+        self:update()
+      end
+    end, out_fd and { out_fd } or nil)
+    if not self.proc then
+      if out_fd then lib.close(out_fd) end
+      if remarks_path then os.remove(remarks_path) end
+      scheduler.finished(self)
+      error(('neobolt: failed to start %s: %s'):format(state.config.exe, spawn_err))
     end
-    self:render(proc, state)
-  end)
+    self.out_fd, self.remarks_path = out_fd, remarks_path
+  end
+
+  -- headers precompiled, compile only the rest
+  local with_pch = pch.get(state.config, src)
+  if with_pch then
+    trace.instant(self.asm_buf, 'pch', uv.hrtime(), { key = with_pch.key })
+    compile(with_pch.args, with_pch.src, nil, with_pch.key)
+    return
+  end
+
+  -- other views of this source with the same compiler and preprocessor flags
+  -- preprocess it only once
+  local split = preprocess.split(state.config)
+  if split and preprocess.count_sharing(Registry.src_map[self.src_buf], split.key) > 1 then
+    local token = {}
+    self.pp_wait = token
+    local ts = uv.hrtime()
+    preprocess.run(self.src_buf, state.changedtick, split, state.config.exe,
+      state.config.cwd, src, function(pp)
+        if self.pp_wait ~= token then
+          return -- aborted
+        end
+        self.pp_wait = nil
+        if self:destroyed() then
+          scheduler.finished(self)
+          return
+        end
+        trace.span(self.asm_buf, 'preprocess', ts, uv.hrtime())
+        if pp and pp.code == 0 then
+          compile(split.backend_args, pp.stdout, pp)
+        else
+          -- full compile reports the errors
+          compile(args, src, nil)
+        end
+      end)
+    return
+  end
+
+  compile(args, src, nil)
+end
+
+--- Debounce time in ms for a change right now, 0 to compile immediately
+---@return integer
+function Compiler:debounce_time()
+  local compile, parse = self.latency.compile, self.latency.parse
+  if compile == nil then
+    return DEBOUNCE
+  end
+  if self.proc == nil and not self.debounce:is_active() and not scheduler.is_queued(self) then
+    return 0
+  end
+  local cost = compile + parse
+  local interval = self.latency.interval or DEBOUNCE_MAX
+  if cost <= interval then
+    return DEBOUNCE_MIN
+  end
+  -- typing faster than it compiles, wait for a pause long enough to be worth it
+  return math.floor(math.min(math.max(cost, DEBOUNCE_MIN), DEBOUNCE_MAX))
+end
+
+--- Whether to let the running compiler finish before starting a new one
+---@return boolean
+function Compiler:should_wait()
+  if not self.proc or not self.latency.compile then
+    return false
+  end
+  -- a compiler that just started is cheap to restart, one that's almost done
+  -- would rather give us intermediate results
+  local elapsed = (uv.hrtime() - self.proc.ts_start) / 1e6
+  return elapsed >= self.latency.compile / 2
 end
 
 function Compiler:schedule_update()
-  -- TODO: suppress also when asm_buf is not visible in the current tab
   if not self.changed or self.in_insert or self.user_paused then
     return
   end
   self.changed = false
 
-  self.debounce:start(DEBOUNCE, 0, function()
-    vim.schedule(function()
+  local ts = uv.hrtime()
+  local delay = self:debounce_time()
+  local function fire()
+    trace.span(self.asm_buf, 'debounce', ts, uv.hrtime(), { delay = delay })
+    if self:should_wait() then
+      self.pending = true
+    else
       self:update()
+    end
+  end
+
+  if delay == 0 then
+    self.debounce:stop()
+    fire()
+    return
+  end
+  self.debounce:start(delay, 0, function()
+    vim.schedule(function()
+      if not self:destroyed() then
+        fire()
+      end
     end)
   end)
 end
 
-function Compiler:render(proc, state)
-  if self:destroyed() then
-    return
+--- Loop nesting depth in the sign column, loop headers and back-edges as virtual text
+---@param buf integer
+---@param asm table lib.parse result
+---@param offset integer 0-based row of the first asm line
+local function mark_loops(buf, asm, offset)
+  for i, block in ipairs(asm.blocks) do
+    local first, last, depth, loop = block[1], block[2], block[3], block[4]
+    if depth > 0 then
+      local sign = depth < 10 and tostring(depth) or '+'
+      for lnum = first, last do
+        b_set_mark(buf, NS, lnum + offset - 1, 0, {
+          sign_text = sign,
+          sign_hl_group = 'NeoboltLoopBody',
+        })
+      end
+      if loop == i then
+        b_set_mark(buf, NS, first + offset - 1, 0, {
+          virt_text = { { ('loop, depth %d'):format(depth), 'NeoboltLoopHeader' } },
+        })
+      end
+    end
   end
+  for _, edge in ipairs(asm.backedges) do
+    b_set_mark(buf, NS, edge[1] + offset - 1, 0, {
+      virt_text = { { '↑ ' .. vim.trim(asm.lines[edge[2]]), 'NeoboltBackEdge' } },
+    })
+  end
+end
 
-  -- TODO: option to disable filtering
-  local parse_time = uv.hrtime()
-  -- TODO: should this run on a separate thread?
-  -- c and c++ translation units should be generally small. but zig's hello world is
-  -- already ~4 MB, and right now it parses in about ~20-15ms, so ~200-260 MiB/s.
-  -- this is still acceptable, but if it takes any longer then it becomes a problem.
-  -- not sure how big input should i reasonably expect. i could optimize it and halve
-  -- the running time or more probably, but maybe making this async is just the safest
-  -- option.
-  local asm, asm_err = lib.parse(proc.stdout)
-  parse_time = (uv.hrtime() - parse_time) / 1e+9
+--- Estimated cycles of every block as right aligned virtual text, and per iteration
+--- on loop headers. `?` when some instructions are missing from the cost table.
+---@param buf integer
+---@param asm table lib.parse result
+---@param offset integer 0-based row of the first asm line
+local function mark_costs(buf, asm, offset)
+  for i, block in ipairs(asm.blocks) do
+    local first, loop, cycles, unknown = block[1], block[4], block[5], block[6]
+    local text = ('~%.2fc%s'):format(cycles, unknown > 0 and '?' or '')
+    if loop == i then
+      text = ('~%.2f cycles/iter, '):format(block[7]) .. text
+    end
+    b_set_mark(buf, NS, first + offset - 1, 0, {
+      virt_text = { { text, 'NeoboltCost' } },
+      virt_text_pos = 'right_align',
+    })
+  end
+end
 
+local STACK_TEXT = { l = 'reload', s = 'spill', b = 'spill+reload' }
+
+--- Stack frame size and spill counts on function labels, and stack slot accesses as
+--- virtual text. The ones in loops get the whole line highlighted.
+---@param buf integer
+---@param asm table lib.parse result
+---@param offset integer 0-based row of the first asm line
+local function mark_frames(buf, asm, offset)
+  for _, f in ipairs(asm.functions) do
+    local text = ('frame %dB, %d spills, %d reloads'):format(f[3], f[4], f[5])
+    if f[6] > 0 then
+      text = text .. (', %d in loops'):format(f[6])
+    end
+    b_set_mark(buf, NS, f[1] + offset - 1, 0, {
+      virt_text = { { text, f[6] > 0 and 'NeoboltLoopSpill' or 'NeoboltFrame' } },
+    })
+  end
 
-  -- discard previous state
-  self.state = state
+  local stack = asm.stack
+  local in_loop = {}
+  for _, block in ipairs(asm.blocks or {}) do
+    if block[3] > 0 then
+      for lnum = block[1], block[2] do
+        in_loop[lnum] = true
+      end
+    end
+  end
+  local pos = stack:find('[lsb]')
+  while pos do
+    local text = STACK_TEXT[stack:sub(pos, pos)]
+    if in_loop[pos] then
+      b_set_mark(buf, NS, pos + offset - 1, 0, {
+        virt_text = { { text .. ' in loop', 'NeoboltLoopSpill' } },
+        line_hl_group = 'NeoboltLoopSpill',
+      })
+    else
+      b_set_mark(buf, NS, pos + offset - 1, 0, {
+        virt_text = { { text, 'NeoboltSpill' } },
+      })
+    end
+    pos = stack:find('[lsb]', pos + 1)
+  end
+end
 
-  if asm then
-    -- normalize paths
-    for i, path in ipairs(asm.files) do
-      -- TODO: there is also "<built-in>", check wtf is that
-      if path ~= '<stdin>' then
-        asm.files[i] = fn.fnamemodify(path, ':p')
+-- lib.parse mix classes, in order
+local MIX_NAMES = { 'scalar', 'xmm', 'ymm', 'zmm', 'vec', 'mem', 'branch', 'call' }
+local MIX_CLASSES = #MIX_NAMES
+
+--- Instruction mix of every source line as virtual text, like "ymm×12, scalar×2"
+---@param buf integer Source buffer
+---@param ns integer
+---@param asm table lib.parse result
+local function mark_mix(buf, ns, asm)
+  local lines = {}
+  local mix = asm.mix
+  -- parse_result replaced file IDs with paths
+  for i, loc in ipairs(asm.locations) do
+    if loc[1] == '<stdin>' then
+      local counts = lines[loc[2]]
+      if not counts then
+        counts = {}
+        for k = 1, MIX_CLASSES do counts[k] = 0 end
+        lines[loc[2]] = counts
+      end
+      local base = (i - 1) * MIX_CLASSES
+      for k = 1, MIX_CLASSES do
+        counts[k] = counts[k] + mix[base + k]
       end
     end
+  end
 
-    -- replace file IDs with paths
-    for _, loc in ipairs(asm.locations) do
-      loc[1] = asm.files[loc[1]]
+  for line, counts in pairs(lines) do
+    local order = {}
+    for k = 1, MIX_CLASSES do
+      if counts[k] > 0 then
+        t_insert(order, k)
+      end
+    end
+    table.sort(order, function(a, b)
+      return counts[a] > counts[b] or (counts[a] == counts[b] and a < b)
+    end)
+    local parts = {}
+    for _, k in ipairs(order) do
+      t_insert(parts, ('%s×%d'):format(MIX_NAMES[k], counts[k]))
     end
+    -- the source can be shorter than what got compiled
+    pcall(b_set_mark, buf, ns, line - 1, 0, {
+      virt_text = { { t_concat(parts, ', '), 'NeoboltMix' } },
+    })
   end
+end
 
+function Compiler:render(result, state)
+  if self:destroyed() then
+    return
+  end
+
+  local ts_render = uv.hrtime()
+  local tracing = trace.enabled()
+  local asm, asm_err = result.asm, result.asm_err
+
+  -- discard previous state
+  self.state = state
+  mca.cancel(self.asm_buf)
 
-  local stderr = vim.split(proc.stderr, '\n', { plain = true })
+  local stderr = vim.split(result.stderr, '\n', { plain = true })
   -- trim trailing empty lines
   for i = #stderr, 1, -1 do
     if stderr[i] == '' then
@@ -399,9 +953,22 @@ function Compiler:render(proc, state)
     ('# compiler: %s'):format(state.config.exe),
     ('#    flags: %s'):format(t_concat(state.config.user_args, ' ')),
     '',
-    ('# exited with code %d, signal %d'):format(proc.code, proc.signal),
-    ('# compiler %.6fs, process %.6fs'):format(proc.time, parse_time),
+    ('# exited with code %d, signal %d'):format(result.code, result.signal),
+    ('# compiler %.6fs, process %.6fs%s'):format(result.time, result.parse_time,
+      state.cached and ' (cached)' or ''),
   }
+  if state.config.uarch then
+    t_insert(summary, 4, ('#    costs: ~cycles on %s, throughput only'):format(state.config.uarch))
+  end
+  -- output of the current source, benchmark and layout compile it again
+  local fresh = result.code == 0 and self:in_sync()
+  -- filled in when the benchmark finishes
+  local bench_line = bench.summary(self.asm_buf, fresh)
+  local bench_row = nil
+  if bench_line then
+    bench_row = #summary - 3
+    t_insert(summary, bench_row + 1, bench_line)
+  end
 
 
   -- extmark IDs overflow after UINT32_MAX, and if i'm reading it right it's
@@ -424,7 +991,11 @@ function Compiler:render(proc, state)
     if last >= line_count then
       last = -1
     end
+    local ts = tracing and uv.hrtime()
     b_set_lines(self.asm_buf, lnum_curr, last, false, lines)
+    if tracing then
+      trace.span(self.asm_buf, 'nvim_buf_set_lines', ts, uv.hrtime(), { lines = #lines })
+    end
     lnum_last = lnum_curr
     lnum_curr = lnum_curr + #lines
   end
@@ -459,12 +1030,50 @@ function Compiler:render(proc, state)
   if asm and #asm.lines > 0 then
     append_lines({''})
     append_lines(asm.lines)
+    state.asm, state.asm_row = asm, lnum_last
     -- store source locations as extmarks
+    local ts = uv.hrtime()
     for i, range in ipairs(asm.location_ranges) do
       local first, last = range[1] + lnum_last, range[2] + lnum_last
       local mark = b_set_mark(self.asm_buf, NS_LOC, first - 1, 0, { end_row = last })
       state.mark_to_loc[mark] = asm.locations[i]
     end
+    trace.span(self.asm_buf, 'extmarks', ts, uv.hrtime(), { count = #asm.location_ranges })
+    if options.options.loops and asm.blocks then
+      ts = uv.hrtime()
+      mark_loops(self.asm_buf, asm, lnum_last)
+      trace.span(self.asm_buf, 'loop marks', ts, uv.hrtime(), { blocks = #asm.blocks })
+    end
+    if options.options.spills and asm.stack then
+      ts = uv.hrtime()
+      mark_frames(self.asm_buf, asm, lnum_last)
+      trace.span(self.asm_buf, 'frame marks', ts, uv.hrtime(), { functions = #asm.functions })
+    end
+    if asm.blocks and asm.blocks[1] and asm.blocks[1][5] then
+      ts = uv.hrtime()
+      mark_costs(self.asm_buf, asm, lnum_last)
+      trace.span(self.asm_buf, 'cost marks', ts, uv.hrtime(), { blocks = #asm.blocks })
+    end
+    ts = uv.hrtime()
+    profile.render(self.asm_buf, asm, lnum_last)
+    trace.span(self.asm_buf, 'profile marks', ts, uv.hrtime())
+  else
+    profile.render(self.asm_buf, nil, 0)
+  end
+
+  -- fresh compiles read theirs in the background, until then the source keeps the
+  -- previous ones
+  if result.remarks_pending then
+    remarks.clear_asm(self.asm_buf)
+  else
+    remarks.render(self.asm_buf, self.src_buf, state, result.remarks)
+  end
+
+  b_del_marks(self.src_buf, self.ns_mix, 0, -1)
+  if options.options.mix and asm and asm.mix then
+    local ts = uv.hrtime()
+    mark_mix(self.src_buf, self.ns_mix, asm)
+    trace.span(self.asm_buf, 'mix marks', ts, uv.hrtime(), { locations = #asm.locations })
   end
 
   -- trim remaining lines
@@ -476,6 +1085,16 @@ function Compiler:render(proc, state)
   -- restore undolevels
   b_set_opt(self.asm_buf, 'undolevels', undolevels)
 
+  if bench_row and fresh then
+    bench.run(self, state, bench_row)
+  end
+  if fresh then
+    layout.run(self, state)
+  else
+    layout.detach(self.asm_buf)
+  end
+  diff.update(self)
+
   -- populate file map
   for mark, loc in pairs(state.mark_to_loc) do
     local file, line = loc[1], loc[2]
@@ -494,6 +1113,13 @@ function Compiler:render(proc, state)
       t_insert(g_asm_hls, self)
     end
   end
+
+  if tracing then
+    local ts = uv.hrtime()
+    trace.span(self.asm_buf, 'render', ts_render, ts)
+    -- keypress to asm latency
+    trace.span(self.asm_buf, 'change to render', state.ts_changed, ts)
+  end
 end
 
 function Compiler:in_sync()
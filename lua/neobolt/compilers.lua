@@ -5,6 +5,8 @@ local M = {}
 ---@field path string
 ---@field base_args string[]
 ---@field user_args string[]
+---@field probe_debug boolean? Replace -g in base_args with the cheapest debug flags
+---                            that still map all lines, see probe.lua
 
 ---@alias neobolt.ConfigMap table<string, neobolt.Config>
 
@@ -39,14 +41,15 @@ end
 M.templates = {
 
   gnu_c = M.Config {
-    -- TODO: -g1 produces shorter output. check if there aren't any downsides
     base_args = { '-S', '-g', '-x', 'c', '-o', '-', '-' },
     user_args = gnu_default_user_args(),
+    probe_debug = true,
   },
 
   gnu_cpp = M.Config {
     base_args = { '-S', '-g', '-x', 'c++', '-o', '-', '-' },
     user_args = gnu_default_user_args(),
+    probe_debug = true,
   },
 
   -- TODO: complains about no main function
@@ -143,6 +146,138 @@ M.detect_compilers = function()
 end
 
 
+-- detection cache, PATH directory -> { mtime, executable names }
+---@alias neobolt.DetectCache table<string, { mtime: integer, names: string[] }>
+
+local function detect_cache_path()
+  return vim.fn.stdpath('cache') .. '/neobolt/compilers.json'
+end
+
+---@return neobolt.DetectCache?
+local function read_detect_cache()
+  local file = io.open(detect_cache_path(), 'r')
+  if not file then return nil end
+  local data = file:read('*a')
+  file:close()
+  local ok, obj = pcall(vim.json.decode, data)
+  if not ok or type(obj) ~= 'table' or obj.version ~= 1 or type(obj.dirs) ~= 'table' then
+    return nil
+  end
+  return obj.dirs
+end
+
+---@param dirs neobolt.DetectCache
+local function write_detect_cache(dirs)
+  vim.fn.mkdir(vim.fn.fnamemodify(detect_cache_path(), ':h'), 'p')
+  local file = io.open(detect_cache_path(), 'w')
+  if not file then return end
+  file:write(vim.json.encode({ version = 1, dirs = dirs }))
+  file:close()
+end
+
+--- Configs of compilers in the detection cache, PATH order decides between equal names
+---@param dirs neobolt.DetectCache
+---@return neobolt.ConfigMap
+local function configs_from_cache(dirs)
+  local PATH = vim.split(assert(vim.env.PATH), ':', { trimempty = true, plain = true })
+  local res = {} ---@type neobolt.ConfigMap
+  for i = #PATH, 1, -1 do
+    local entry = dirs[PATH[i]]
+    for _, name in ipairs(entry and entry.names or {}) do
+      local template = match_name(name)
+      if template then
+        res[name] = M.Config({ path = PATH[i] .. '/' .. name }, template)
+      end
+    end
+  end
+  return res
+end
+
+-- runs on the uv threadpool, in a separate Lua state. no upvalues, only strings in
+-- and out. `cached` is lines of "dir\tmtime", the result is lines of
+-- "dir\tmtime\tnames..." for directories that changed, and "dir\tmtime" for
+-- unchanged ones.
+local function scan_path_work(path, cached)
+  local uv = vim and (vim.uv or vim.loop) or require('luv')
+  local known = {}
+  for line in cached:gmatch('[^\n]+') do
+    local dir, mtime = line:match('^(.*)\t(%d+)$')
+    if dir then known[dir] = tonumber(mtime) end
+  end
+
+  local out = {}
+  for dir in path:gmatch('[^:]+') do
+    local stat = uv.fs_stat(dir)
+    if stat and stat.type == 'directory' then
+      local mtime = stat.mtime.sec
+      local line = { dir, tostring(mtime) }
+      if known[dir] ~= mtime then
+        table.insert(line, '')
+        local handle = uv.fs_scandir(dir)
+        while handle do
+          local name = uv.fs_scandir_next(handle)
+          if not name then break end
+          -- loose filter, exact matching happens on the main thread
+          if (name:find('gcc') or name:find('g%+%+') or name:find('clang') or
+              name == 'cc' or name == 'c++') and uv.fs_access(dir .. '/' .. name, 'X') then
+            table.insert(line, name)
+          end
+        end
+      end
+      table.insert(out, table.concat(line, '\t'))
+    end
+  end
+  return table.concat(out, '\n')
+end
+
+local detecting = false
+local on_detected = {} ---@type fun(configs: neobolt.ConfigMap)[]
+
+--- Compiler detection on the uv threadpool. Directories are only listed when their
+--- mtime differs from the cached one, results are written back to the cache.
+---@param callback fun(configs: neobolt.ConfigMap)?
+function M.detect_compilers_async(callback)
+  if callback then
+    table.insert(on_detected, callback)
+  end
+  if detecting then return end
+  detecting = true
+
+  local dirs = read_detect_cache() or {}
+  local cached = {}
+  for dir, entry in pairs(dirs) do
+    table.insert(cached, ('%s\t%d'):format(dir, entry.mtime))
+  end
+
+  local work = vim.loop.new_work(scan_path_work, function(result)
+    vim.schedule(function()
+      local new_dirs = {} ---@type neobolt.DetectCache
+      for line in result:gmatch('[^\n]+') do
+        local fields = vim.split(line, '\t', { plain = true })
+        local dir, mtime = fields[1], tonumber(fields[2])
+        if #fields == 2 and dirs[dir] then
+          new_dirs[dir] = dirs[dir]
+        else
+          new_dirs[dir] = { mtime = mtime, names = { unpack(fields, 4) } }
+        end
+      end
+      if not vim.deep_equal(new_dirs, dirs) then
+        write_detect_cache(new_dirs)
+      end
+
+      detecting = false
+      local configs = configs_from_cache(new_dirs)
+      local callbacks = on_detected
+      on_detected = {}
+      for _, cb in ipairs(callbacks) do
+        cb(configs)
+      end
+    end)
+  end)
+  work:queue(vim.env.PATH or '', table.concat(cached, '\n'))
+end
+
+
 ---@param config neobolt.Config?
 local function validate_compiler_config(config)
   assert(type(config) == 'table')
@@ -168,22 +303,57 @@ function M.set_compiler(name, config)
   compilers[name] = config
 end
 
---- Get compilers
+---@param configs neobolt.ConfigMap
+local function set_detected(configs)
+  for _, config in pairs(configs) do
+    validate_compiler_config(config)
+  end
+  -- replace previously detected ones, but not ones set by the user
+  for name, config in pairs(detected_compilers or {}) do
+    if compilers[name] == config then
+      compilers[name] = nil
+    end
+  end
+  detected_compilers = configs
+  for name, config in pairs(configs) do
+    if compilers[name] == nil then
+      compilers[name] = config
+    end
+  end
+end
+
+--- Get compilers. Uses the detection cache when there is one, and refreshes it in
+--- the background, otherwise detects them synchronously.
 ---@return neobolt.ConfigMap
 function M.get_compilers()
   if detected_compilers == nil then
-    detected_compilers = M.detect_compilers()
-    assert(type(detected_compilers) == 'table')
-    for name, config in pairs(detected_compilers) do
-      validate_compiler_config(config)
-      if compilers[name] == nil then
-        compilers[name] = config
-      end
+    local dirs = read_detect_cache()
+    if dirs then
+      set_detected(configs_from_cache(dirs))
+      M.detect_compilers_async(set_detected)
+    else
+      local configs = M.detect_compilers()
+      assert(type(configs) == 'table')
+      set_detected(configs)
+      -- next session can use the cache
+      M.detect_compilers_async()
     end
   end
   return compilers
 end
 
+--- Start detecting compilers in the background, so the first :Neobolt or completion
+--- doesn't wait for it
+function M.prefetch()
+  if detected_compilers == nil then
+    M.detect_compilers_async(function(configs)
+      if detected_compilers == nil then
+        set_detected(configs)
+      end
+    end)
+  end
+end
+
 
 --- Maps filetype to default compiler name(s)
 ---@type table<string, string|string[]>
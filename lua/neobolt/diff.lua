@@ -0,0 +1,218 @@
+-- Side-by-side codegen diff of two asm buffers of the same source, like -O2 against
+-- -O3 -march=native or gcc against clang. libneobolt pairs functions by name and
+-- aligns their lines, with registers renamed alike and source lines kept apart. The
+-- two sides open in a new tabpage with scrollbind, filler rows keep them aligned, and
+-- function labels show how many instructions each side has. Every render of either
+-- asm buffer updates the diff.
+
+local api = vim.api
+local lib = require('libneobolt')
+local Registry = require('neobolt.registry')
+
+local M = {}
+
+local NS = api.nvim_create_namespace('neobolt_diff')
+
+api.nvim_set_hl(0, 'NeoboltDiffAdded', { link = 'DiffAdd', default = true })
+api.nvim_set_hl(0, 'NeoboltDiffRemoved', { link = 'DiffDelete', default = true })
+api.nvim_set_hl(0, 'NeoboltDiffChanged', { link = 'DiffChange', default = true })
+api.nvim_set_hl(0, 'NeoboltDiffStat', { link = 'Comment', default = true })
+
+-- rows before the first diff row: compiler and flags, and an empty line
+local HEADER = 2
+
+-- { a = compiler, b = compiler, left = buf, right = buf }
+local views = {}
+
+local function describe(compiler)
+  local config = compiler.state and compiler.state.config or compiler.config
+  return ('%s %s'):format(config.exe, table.concat(config.user_args, ' '))
+end
+
+local function set_lines(buf, lines)
+  local cursors = {}
+  for _, win in ipairs(vim.fn.win_findbuf(buf)) do
+    cursors[win] = api.nvim_win_get_cursor(win)
+  end
+  api.nvim_buf_set_option(buf, 'modifiable', true)
+  api.nvim_buf_set_lines(buf, 0, -1, false, lines)
+  api.nvim_buf_set_option(buf, 'modifiable', false)
+  for win, cursor in pairs(cursors) do
+    pcall(api.nvim_win_set_cursor, win, { math.min(cursor[1], #lines), cursor[2] })
+  end
+end
+
+local function stat_text(f)
+  local a_insns, b_insns, removed, added = f[3], f[4], f[5], f[6]
+  if b_insns == 0 then
+    return ('only on the left, %d instructions'):format(a_insns)
+  elseif a_insns == 0 then
+    return ('only on the right, %d instructions'):format(b_insns)
+  end
+  return ('%d → %d instructions (%+d), -%d +%d'):format(a_insns, b_insns, b_insns - a_insns,
+    removed, added)
+end
+
+local function render(view)
+  local a, b = view.a.state and view.a.state.asm, view.b.state and view.b.state.asm
+  if not a or not b then
+    return -- a failed compile keeps the last diff
+  end
+  local d, err = lib.diff(a, b)
+  if not d then
+    vim.notify('neobolt: ' .. err, vim.log.levels.WARN)
+    return
+  end
+
+  local a_total, b_total = 0, 0
+  for _, f in ipairs(d.functions) do
+    a_total, b_total = a_total + f[3], b_total + f[4]
+  end
+  local left = { ('# %s: %d instructions'):format(describe(view.a), a_total), '' }
+  local right = { ('# %s: %d instructions (%+d)'):format(describe(view.b), b_total,
+    b_total - a_total), '' }
+  local a_lines, b_lines, da, db = a.lines, b.lines, d.a, d.b
+  for i = 1, #d.ops do
+    local ia, ib = da[i], db[i]
+    left[i + HEADER] = ia > 0 and a_lines[ia] or ''
+    right[i + HEADER] = ib > 0 and b_lines[ib] or ''
+  end
+  set_lines(view.left, left)
+  set_lines(view.right, right)
+
+  api.nvim_buf_clear_namespace(view.left, NS, 0, -1)
+  api.nvim_buf_clear_namespace(view.right, NS, 0, -1)
+  local ops = d.ops
+  local pos = ops:find('[~+-]')
+  while pos do
+    local op, row = ops:byte(pos), pos + HEADER - 1
+    if op == 126 then -- '~'
+      api.nvim_buf_set_extmark(view.left, NS, row, 0, { line_hl_group = 'NeoboltDiffChanged' })
+      api.nvim_buf_set_extmark(view.right, NS, row, 0, { line_hl_group = 'NeoboltDiffChanged' })
+    elseif op == 45 then -- '-'
+      api.nvim_buf_set_extmark(view.left, NS, row, 0, { line_hl_group = 'NeoboltDiffRemoved' })
+    else
+      api.nvim_buf_set_extmark(view.right, NS, row, 0, { line_hl_group = 'NeoboltDiffAdded' })
+    end
+    pos = ops:find('[~+-]', pos + 1)
+  end
+  for _, f in ipairs(d.functions) do
+    api.nvim_buf_set_extmark(view.right, NS, f[2] + HEADER - 1, 0, {
+      virt_text = { { stat_text(f), 'NeoboltDiffStat' } },
+    })
+  end
+end
+
+local function new_buf(name)
+  local buf = api.nvim_create_buf(false, true)
+  api.nvim_buf_set_option(buf, 'bufhidden', 'wipe')
+  api.nvim_buf_set_option(buf, 'modifiable', false)
+  api.nvim_buf_set_option(buf, 'filetype', 'asm')
+  pcall(api.nvim_buf_set_name, buf, name)
+  return buf
+end
+
+local function remove(view)
+  for i, v in ipairs(views) do
+    if v == view then
+      table.remove(views, i)
+      return
+    end
+  end
+end
+
+--- Open a diff of two compilers' asm in a new tabpage, `a` on the left
+---@param a table Compiler
+---@param b table Compiler
+function M.open(a, b)
+  local name = ('neobolt-diff://%d-%d'):format(a.asm_buf, b.asm_buf)
+  local view = { a = a, b = b, left = new_buf(name .. '/a'), right = new_buf(name .. '/b') }
+
+  vim.cmd('tab split')
+  local left_win = api.nvim_get_current_win()
+  api.nvim_win_set_buf(left_win, view.left)
+  vim.cmd('rightbelow vsplit')
+  local right_win = api.nvim_get_current_win()
+  api.nvim_win_set_buf(right_win, view.right)
+  for _, win in ipairs({ left_win, right_win }) do
+    api.nvim_win_set_option(win, 'scrollbind', true)
+    api.nvim_win_set_option(win, 'cursorbind', true)
+    api.nvim_win_set_option(win, 'wrap', false)
+  end
+  api.nvim_set_current_win(left_win)
+
+  -- closing one side closes the diff
+  for _, buf in ipairs({ view.left, view.right }) do
+    api.nvim_create_autocmd('BufWipeout', {
+      buffer = buf,
+      once = true,
+      callback = function()
+        remove(view)
+        vim.schedule(function()
+          for _, other in ipairs({ view.left, view.right }) do
+            if api.nvim_buf_is_valid(other) then
+              api.nvim_buf_delete(other, { force = true })
+            end
+          end
+        end)
+      end,
+    })
+  end
+
+  table.insert(views, view)
+  render(view)
+end
+
+--- Diff a compiler against another one of the same source: the one of asm buffer
+--- `other_buf`, the only other one, or one picked from a list
+---@param compiler table
+---@param other_buf integer?
+function M.pick(compiler, other_buf)
+  local others = {}
+  for buf, other in pairs(Registry.src_map[compiler.src_buf] or {}) do
+    if other ~= compiler and (other_buf == nil or buf == other_buf) then
+      table.insert(others, other)
+    end
+  end
+  table.sort(others, function(x, y) return x.asm_buf < y.asm_buf end)
+
+  if #others == 0 then
+    vim.notify('neobolt: no other asm buffer of this source to diff against',
+      vim.log.levels.WARN)
+  elseif #others == 1 then
+    M.open(compiler, others[1])
+  else
+    vim.ui.select(others, {
+      prompt = 'Diff against',
+      format_item = function(other)
+        return ('%d: %s'):format(other.asm_buf, describe(other))
+      end,
+    }, function(other)
+      if other and not other:destroyed() and not compiler:destroyed() then
+        M.open(compiler, other)
+      end
+    end)
+  end
+end
+
+--- Update the diffs of a compiler after it rendered
+---@param compiler table
+function M.update(compiler)
+  for _, view in ipairs(views) do
+    if view.a == compiler or view.b == compiler then
+      render(view)
+    end
+  end
+end
+
+--- Stop updating the diffs of a compiler, they keep its last asm
+---@param compiler table
+function M.detach(compiler)
+  for i = #views, 1, -1 do
+    if views[i].a == compiler or views[i].b == compiler then
+      table.remove(views, i)
+    end
+  end
+end
+
+return M
@@ -1,5 +1,11 @@
 local M = {}
 
+--- Set global options, see lua/neobolt/options.lua for the defaults
+---@param opts table?
+function M.setup(opts)
+  require('neobolt.options').set(opts or {})
+end
+
 function M.get_config(bufnr)
   return require('neobolt.compiler').get_config(bufnr)
 end
@@ -8,4 +14,17 @@ function M.set_config(bufnr, config)
   return require('neobolt.compiler').set_config(bufnr, config)
 end
 
+--- Start recording a Chrome trace of compile, parse and render stages
+---@param path string Output JSON file
+function M.trace_start(path)
+  require('neobolt.trace').start(path)
+end
+
+--- Stop recording and write the trace file
+---@return boolean ok
+---@return string? err
+function M.trace_stop()
+  return require('neobolt.trace').stop()
+end
+
 return M
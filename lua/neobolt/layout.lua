@@ -0,0 +1,165 @@
+-- Code layout from an object file. The asm doesn't say how many bytes instructions
+-- encode to, so after a render the source is compiled again with `-c` into an
+-- in-memory object, and libneobolt reads its symbol table: function labels get their
+-- size in bytes, loop headers their offset in the section modulo a cache line, for
+-- i-cache footprint and loops that straddle 32/64-byte fetch and uop cache windows.
+--
+-- gcc keeps `.L` labels in the object with `-Wa,-L`, clang's integrated assembler
+-- doesn't, so with clang only functions get sizes. Offsets are relative to the
+-- section, known modulo 64 only when the section is aligned to at least that.
+
+local api = vim.api
+local lib = require('libneobolt')
+local spawn = require('neobolt.spawn')
+local source = require('neobolt.source')
+local probe = require('neobolt.probe')
+local options = require('neobolt.options')
+local pch = require('neobolt.pch')
+
+local M = {}
+
+local NS = api.nvim_create_namespace('neobolt_layout')
+
+api.nvim_set_hl(0, 'NeoboltLayout', { link = 'Comment', default = true })
+
+local CACHE_LINE = 64
+
+-- asm buffer -> { proc, path? } of the running compile, the memfd is closed by abort
+local running = {}
+
+local function cancel(asm_buf)
+  local run = running[asm_buf]
+  if run then
+    run.proc:abort()
+    if run.path then
+      os.remove(run.path)
+    end
+    running[asm_buf] = nil
+  end
+end
+
+--- Rows and labels to annotate: function labels and loop headers
+---@param asm table lib.parse result
+---@return { [1]: integer, [2]: string, [3]: boolean }[] { lnum, label, is function }
+local function targets(asm)
+  local res = {}
+  local function add(lnum, is_function)
+    local label = asm.lines[lnum] and asm.lines[lnum]:match('^%s*([^:%s]+):')
+    if label then
+      table.insert(res, { lnum, label, is_function })
+    end
+  end
+  for _, f in ipairs(asm.functions or {}) do
+    add(f[1], true)
+  end
+  for i, block in ipairs(asm.blocks or {}) do
+    if block[4] == i then
+      add(block[1], false)
+    end
+  end
+  return res
+end
+
+local function show(asm_buf, asm_row, list, symbols)
+  api.nvim_buf_clear_namespace(asm_buf, NS, 0, -1)
+  for i, target in ipairs(list) do
+    local sym = symbols[i]
+    if sym then
+      local offset, size, align = sym[1], sym[2], sym[3]
+      local mod = offset % CACHE_LINE
+      local text
+      if target[3] then
+        text = ('%dB, @%d mod %d'):format(size, mod, CACHE_LINE)
+      else
+        text = ('+0x%x, @%d mod %d'):format(offset, mod, CACHE_LINE)
+      end
+      if align < CACHE_LINE then
+        text = text .. (' (section align %d)'):format(align)
+      end
+      pcall(api.nvim_buf_set_extmark, asm_buf, NS, target[1] + asm_row - 1, 0, {
+        virt_text = { { text, 'NeoboltLayout' } },
+      })
+    end
+  end
+end
+
+--- Compile the source of a compiler to an object and annotate the render of `state`
+--- with sizes and offsets, when it's still the one shown
+---@param compiler table
+---@param state table Rendered compiler state
+function M.run(compiler, state)
+  local asm_buf = compiler.asm_buf
+  cancel(asm_buf)
+  api.nvim_buf_clear_namespace(asm_buf, NS, 0, -1)
+  if not options.options.layout.enabled or not state.asm then
+    return
+  end
+  local list = targets(state.asm)
+  if #list == 0 then
+    return
+  end
+
+  local config = state.config
+  local lang, flags = pch.flags(config)
+  local args = vim.list_extend({}, flags)
+  if probe.family(config.exe) == 'gcc' then
+    table.insert(args, '-Wa,-L')
+  end
+  -- the object can't go to a pipe, the assembler seeks
+  local fd = lib.memfd and lib.memfd()
+  local path = not fd and vim.fn.tempname() .. '.o' or nil
+  vim.list_extend(args, { '-c', '-o', path or '/proc/self/fd/3', '-x', lang or 'c', '-' })
+
+  local run = { path = path }
+  local proc, err = spawn(config.exe, args, config.cwd, source.get(compiler.src_buf), function(p)
+    -- a run cancelled after it exited still gets here, it only closes the object
+    local current = running[asm_buf] == run
+    if current then
+      running[asm_buf] = nil
+    end
+    local symbols = nil
+    if current and p.code == 0 then
+      local names = {}
+      for i, target in ipairs(list) do
+        names[i] = target[2]
+      end
+      if fd then
+        symbols = lib.elf(fd, names)
+      else
+        local file = io.open(path, 'rb')
+        if file then
+          symbols = lib.elf(file:read('*a'), names)
+          file:close()
+        end
+      end
+    end
+    if fd then
+      lib.close(fd)
+    else
+      os.remove(path)
+    end
+    if symbols and not compiler:destroyed() and compiler.state == state then
+      show(asm_buf, state.asm_row, list, symbols)
+    end
+  end, fd and { fd } or nil)
+  if not proc then
+    if fd then
+      lib.close(fd)
+    end
+    vim.notify(('neobolt: layout: %s: %s'):format(config.exe, err), vim.log.levels.WARN)
+    return
+  end
+  run.proc = proc
+  running[asm_buf] = run
+end
+
+--- Stop annotating an asm buffer
+---@param asm_buf integer
+function M.detach(asm_buf)
+  cancel(asm_buf)
+  if api.nvim_buf_is_valid(asm_buf) then
+    api.nvim_buf_clear_namespace(asm_buf, NS, 0, -1)
+  end
+end
+
+return M
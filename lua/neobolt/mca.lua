@@ -0,0 +1,202 @@
+-- llvm-mca on a range of an asm buffer, for when the built-in cycle estimates aren't
+-- enough. Instruction lines of the selection, or of the loop under the cursor, are
+-- piped into llvm-mca with the target and cpu from the compiler flags, and the report
+-- goes to a scratch buffer next to the asm. A new compile result cancels a running
+-- analysis, its lines would no longer match.
+
+local api = vim.api
+local fs = vim.fs
+local uv = vim.loop
+local spawn = require('neobolt.spawn')
+local options = require('neobolt.options')
+
+local M = {}
+
+-- asm buffer -> { proc, buf }
+local runs = {}
+
+-- triple from a cross compiler name, like aarch64-linux-gnu-gcc-12
+local function exe_triple(exe)
+  local name = fs.basename(exe)
+  local triple = name:match('^(.*)%-gcc') or name:match('^(.*)%-g%+%+')
+    or name:match('^(.*)%-clang') or name:match('^(.*)%-c%+%+')
+  if triple and triple:find('-', 1, true) then
+    return triple
+  end
+end
+
+--- llvm-mca arguments for the compiler flags, and whether the asm is Intel syntax
+---@param config { exe: string, base_args: string[], user_args: string[] }
+---@return string[] args
+---@return boolean intel
+local function mca_args(config)
+  local march, mcpu, mtune, triple, intel = nil, nil, nil, nil, false
+  for _, args in ipairs({ config.base_args, config.user_args }) do
+    for i, arg in ipairs(args) do
+      march = arg:match('^%-march=(.+)') or march
+      mcpu = arg:match('^%-mcpu=(.+)') or mcpu
+      mtune = arg:match('^%-mtune=(.+)') or mtune
+      triple = arg:match('^%-%-target=(.+)') or arg:match('^%-target=(.+)')
+        or (arg == '-target' and args[i + 1]) or triple
+      if arg == '-masm=intel' then
+        intel = true
+      elseif arg == '-masm=att' then
+        intel = false
+      end
+    end
+  end
+  -- -march is a cpu on x86, and an architecture version on arm
+  if march and (march:find('^armv') or march:find('^rv')) then
+    march = nil
+  end
+
+  local res = { '-bottleneck-analysis' }
+  triple = triple or exe_triple(config.exe)
+  if triple then
+    table.insert(res, '-mtriple=' .. triple)
+  end
+  local cpu = mtune or mcpu or march
+  if cpu and cpu ~= 'generic' then
+    table.insert(res, '-mcpu=' .. cpu)
+  end
+  vim.list_extend(res, options.options.mca.args)
+  return res, intel
+end
+
+--- Rows of the loop around a row, from the header to the last back-edge into it
+---@param asm table lib.parse result
+---@param idx integer asm line
+---@return integer? first
+---@return integer? last
+local function loop_range(asm, idx)
+  local header = nil
+  for _, block in ipairs(asm.blocks) do
+    if block[1] <= idx and idx <= block[2] then
+      header = block[4] ~= 0 and block[4] or nil
+      break
+    end
+  end
+  if not header then
+    return nil
+  end
+
+  local first, last = asm.blocks[header][1], asm.blocks[header][2]
+  for _, block in ipairs(asm.blocks) do
+    if block[4] == header then
+      first, last = math.min(first, block[1]), math.max(last, block[2])
+    end
+  end
+  for _, edge in ipairs(asm.backedges) do
+    if edge[2] == asm.blocks[header][1] then
+      last = math.max(last, edge[1])
+    end
+  end
+  return first, last
+end
+
+local function show(asm_buf, text)
+  local run = runs[asm_buf]
+  if not run.buf or not api.nvim_buf_is_valid(run.buf) then
+    run.buf = api.nvim_create_buf(false, true)
+    api.nvim_buf_set_option(run.buf, 'bufhidden', 'hide')
+    pcall(api.nvim_buf_set_name, run.buf, ('neobolt-mca://%d'):format(asm_buf))
+  end
+  api.nvim_buf_set_lines(run.buf, 0, -1, false, vim.split(text, '\n', { plain = true }))
+
+  if vim.fn.bufwinid(run.buf) == -1 then
+    local win = api.nvim_get_current_win()
+    local asm_win = vim.fn.bufwinid(asm_buf)
+    if asm_win ~= -1 then
+      api.nvim_set_current_win(asm_win)
+    end
+    vim.cmd('belowright split')
+    api.nvim_win_set_buf(0, run.buf)
+    api.nvim_set_current_win(win)
+  end
+end
+
+--- Stop the analysis of an asm buffer, eg when it gets new asm
+---@param asm_buf integer
+function M.cancel(asm_buf)
+  local run = runs[asm_buf]
+  if run and run.proc then
+    run.proc:abort()
+    run.proc = nil
+  end
+end
+
+--- Run llvm-mca on asm lines, or on the loop around `first` when `last` is nil
+---@param asm_buf integer
+---@param state table Compiler state with the rendered asm
+---@param first integer 1-based buffer row
+---@param last integer?
+function M.run(asm_buf, state, first, last)
+  local asm, row = state.asm, state.asm_row
+  if not asm or not asm.kinds then
+    api.nvim_err_writeln('neobolt: no asm to analyze')
+    return
+  end
+
+  first = first - row
+  if last then
+    last = last - row
+  else
+    first, last = loop_range(asm, first)
+    if not first then
+      api.nvim_err_writeln('neobolt: cursor is not in a loop')
+      return
+    end
+  end
+  first, last = math.max(first, 1), math.min(last, #asm.lines)
+
+  local args, intel = mca_args(state.config)
+  local input = intel and { '.intel_syntax noprefix' } or {}
+  local kinds = asm.kinds
+  for i = first, last do
+    if kinds:byte(i) == 105 then -- 'i'
+      table.insert(input, asm.lines[i])
+    end
+  end
+  if #input == (intel and 1 or 0) then
+    api.nvim_err_writeln('neobolt: no instructions in range')
+    return
+  end
+
+  M.cancel(asm_buf)
+  runs[asm_buf] = runs[asm_buf] or {}
+  local run = runs[asm_buf]
+  local header = ('# %s %s, asm lines %d-%d'):format(
+    options.options.mca.exe, table.concat(args, ' '), first + row, last + row)
+
+  local proc, err
+  proc, err = spawn(options.options.mca.exe, args, uv.cwd(), table.concat(input, '\n') .. '\n',
+    function(p)
+      if run.proc ~= p then
+        return
+      end
+      run.proc = nil
+      local text = header
+      if p.stderr ~= '' then
+        text = text .. '\n#\n# ' .. vim.trim(p.stderr):gsub('\n', '\n# ')
+      end
+      show(asm_buf, text .. '\n\n' .. p.stdout)
+    end)
+  if not proc then
+    api.nvim_err_writeln(('neobolt: %s: %s'):format(options.options.mca.exe, err))
+    return
+  end
+  run.proc = proc
+end
+
+--- Forget an asm buffer, and close its report
+---@param asm_buf integer
+function M.detach(asm_buf)
+  M.cancel(asm_buf)
+  local run = runs[asm_buf]
+  runs[asm_buf] = nil
+  if run and run.buf and api.nvim_buf_is_valid(run.buf) then
+    api.nvim_buf_delete(run.buf, { force = true })
+  end
+end
+
+return M
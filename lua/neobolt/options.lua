@@ -0,0 +1,102 @@
+-- Global options, see `require('neobolt').setup()`
+
+local M = {}
+
+---@class neobolt.CacheOptions
+---@field enabled boolean Reuse results of identical compiles
+---@field max_bytes integer In-memory cache size limit, compiler output bytes
+---@field dir string? Also persist results in this directory
+---@field max_files integer Limit of files kept in `dir`
+
+---@class neobolt.PchOptions
+---@field enabled boolean Precompile the leading #include block of sources
+---@field dir string? PCH directory, default is stdpath('cache')/neobolt/pch
+---@field max_files integer Limit of PCH files kept in `dir`
+
+---@class neobolt.CostOptions
+---@field enabled boolean Estimate cycles per block and loop iteration in asm buffers
+---@field uarch string? 'skylake', 'zen3' or 'neoverse-n1', default follows -march/-mtune/-mcpu
+
+---@class neobolt.McaOptions
+---@field exe string llvm-mca executable for `:NeoboltMca`
+---@field args string[] Extra llvm-mca arguments
+
+---@class neobolt.RemarksOptions
+---@field enabled boolean Optimization remarks of clang or gcc as diagnostics on the source and asm
+---@field analysis boolean Also analysis remarks and gcc notes, there are a lot of them
+
+---@class neobolt.BenchOptions
+---@field warmup integer Untimed batches of calls before timing `:NeoboltBench`
+---@field reps integer Timed batches, median and MAD are per call over them
+---@field max_time number Stop timing after this many milliseconds, after at least 5 batches
+---@field cpu integer|false|nil Pin the benchmark to this cpu, default is the last one, false doesn't pin
+
+---@class neobolt.LayoutOptions
+---@field enabled boolean Compile to an object too, for function sizes and loop header offsets modulo 64
+
+---@class neobolt.Options
+---@field cache neobolt.CacheOptions
+---@field pch neobolt.PchOptions
+---@field jobs integer? Max concurrent compilers, default is core count minus one
+---@field memfd boolean Linux: compiler writes to an in-memory file parsed in place
+---@field loops boolean Mark loop headers, bodies and back-edges in asm buffers
+---@field costs neobolt.CostOptions
+---@field spills boolean Mark stack slot accesses and frame sizes in asm buffers, highlight the ones in loops
+---@field mix boolean Instruction mix of every source line as virtual text, like "ymm×12, scalar×2"
+---@field mca neobolt.McaOptions
+---@field remarks neobolt.RemarksOptions
+---@field bench neobolt.BenchOptions
+---@field layout neobolt.LayoutOptions
+
+---@type neobolt.Options
+M.defaults = {
+  cache = {
+    enabled = true,
+    max_bytes = 64 * 1024 * 1024,
+    dir = nil,
+    max_files = 256,
+  },
+  pch = {
+    enabled = false,
+    dir = nil,
+    max_files = 8,
+  },
+  jobs = nil,
+  memfd = false,
+  loops = true,
+  costs = {
+    enabled = true,
+    uarch = nil,
+  },
+  mix = true,
+  spills = true,
+  mca = {
+    exe = 'llvm-mca',
+    args = {},
+  },
+  remarks = {
+    enabled = false,
+    analysis = false,
+  },
+  bench = {
+    warmup = 3,
+    reps = 31,
+    max_time = 2000,
+    cpu = nil,
+  },
+  layout = {
+    enabled = false,
+  },
+}
+
+---@type neobolt.Options
+M.options = vim.deepcopy(M.defaults)
+
+--- Merge user options over the current ones
+---@param opts table
+function M.set(opts)
+  assert(type(opts) == 'table', 'expected table')
+  M.options = vim.tbl_deep_extend('force', M.options, opts)
+end
+
+return M
@@ -0,0 +1,239 @@
+-- Precompiled headers for the leading include block of a source buffer. Most of a
+-- C++ compile is spent parsing the same standard headers on every change, so the
+-- block is compiled once into a gcc `.gch` or a clang `.pch`, keyed by compiler,
+-- flags and the block itself. Compiles then get the source with the block blanked
+-- out, which keeps line numbers, and include the PCH instead.
+--
+-- A PCH is built in the background when the block changes, until it is ready the
+-- source compiles as usual.
+
+local uv = vim.loop
+local lib = require('libneobolt')
+local spawn = require('neobolt.spawn')
+local options = require('neobolt.options')
+
+local M = {}
+
+-- key -> 'building' | 'ready' | 'failed'
+local status = {}
+
+-- what gcc and clang say when they can't use a PCH. errors of the source itself can
+-- mention the header too, in "In file included from" notes
+local REJECTED = {
+  'one or more PCH files were found, but they were invalid',
+  'while reading precompiled header',
+  'not using precompiled header',
+  '%.gch: not used because',
+  "PCH file '[^\n]-' was compiled",
+  "AST file '[^\n]-' was compiled",
+  'has been modified since the precompiled header',
+  'differs between the precompiled header',
+  "in precompiled file '",
+  'PCH file uses an? %a+ PCH format',
+  'PCH file built from a different branch',
+  'input is not a PCH file',
+  'malformed or corrupted AST file',
+}
+
+local function cache_dir()
+  return options.options.pch.dir or (vim.fn.stdpath('cache') .. '/neobolt/pch')
+end
+
+local function is_clang(exe)
+  return vim.fs.basename(exe):find('clang') ~= nil
+end
+
+-- lines that can be part of the block
+local function is_prefix_line(line)
+  return line:find('^%s*$') ~= nil or
+         line:find('^%s*//') ~= nil or
+         line:find('^%s*#%s*include%s*[<"]') ~= nil or
+         line:find('^%s*#%s*define%s') ~= nil or
+         line:find('^%s*#%s*undef%s') ~= nil
+end
+
+--- Leading include block of the source, nil when there are no includes
+---@param src string
+---@return string? prefix
+---@return string? rest Source with the block blanked out
+local function split_source(src)
+  local pos, block_end = 1, 0
+  local has_include = false
+  while pos <= #src do
+    local eol = src:find('\n', pos, true) or #src
+    local line = src:sub(pos, eol)
+    if not is_prefix_line(line:gsub('\n$', '')) then
+      break
+    end
+    if line:find('^%s*#%s*include') then
+      has_include = true
+      block_end = eol
+    end
+    pos = eol + 1
+  end
+  if not has_include then
+    return nil
+  end
+  local prefix = src:sub(1, block_end)
+  return prefix, prefix:gsub('[^\n]+', '') .. src:sub(block_end + 1)
+end
+
+--- Compiler arguments without the ones choosing input, output and the action, and
+--- the `-x` language
+---@param config { base_args: string[], user_args: string[] }
+---@return string? lang
+---@return string[] args
+function M.flags(config)
+  local res = {}
+  local lang = nil
+  local base = config.base_args
+  local i = 1
+  while i <= #base do
+    local arg = base[i]
+    if arg == '-x' then
+      lang = base[i + 1]
+      i = i + 1
+    elseif arg == '-o' then
+      i = i + 1
+    elseif arg ~= '-S' and arg ~= '-c' and arg ~= '-' then
+      table.insert(res, arg)
+    end
+    i = i + 1
+  end
+  for _, arg in ipairs(config.user_args) do
+    table.insert(res, arg)
+  end
+  return lang, res
+end
+
+-- remove oldest files over the limit, each PCH can be tens of MiB
+local function prune(dir, max_files)
+  local files = {}
+  local handle = uv.fs_scandir(dir)
+  while handle do
+    local name, kind = uv.fs_scandir_next(handle)
+    if not name then break end
+    if kind == 'file' and (name:find('%.gch$') or name:find('%.pch$')) then
+      local stat = uv.fs_stat(dir .. '/' .. name)
+      if stat then
+        table.insert(files, { name, stat.mtime.sec })
+      end
+    end
+  end
+  if #files <= max_files then return end
+  table.sort(files, function(a, b) return a[2] < b[2] end)
+  for i = 1, #files - max_files do
+    local key = files[i][1]:match('^(%x+)')
+    uv.fs_unlink(dir .. '/' .. files[i][1])
+    uv.fs_unlink(dir .. '/' .. key .. '.h')
+    status[key] = nil
+  end
+end
+
+local function build(key, exe, cwd, lang, args, prefix)
+  local dir = cache_dir()
+  vim.fn.mkdir(dir, 'p')
+  local header = ('%s/%s.h'):format(dir, key)
+  local file = io.open(header, 'wb')
+  if not file then
+    status[key] = 'failed'
+    return
+  end
+  file:write(prefix)
+  file:close()
+
+  local out = is_clang(exe) and (dir .. '/' .. key .. '.pch') or (header .. '.gch')
+  local build_args = { '-x', lang .. '-header' }
+  vim.list_extend(build_args, args)
+  -- quoted includes are relative to the source, not to the cache directory
+  vim.list_extend(build_args, { '-iquote', cwd, '-o', out, header })
+
+  status[key] = 'building'
+  local proc = spawn(exe, build_args, cwd, '', function(proc)
+    if proc.code == 0 then
+      status[key] = 'ready'
+      prune(dir, options.options.pch.max_files)
+    else
+      status[key] = 'failed'
+    end
+  end)
+  if not proc then
+    status[key] = 'failed'
+  end
+end
+
+--- Compile arguments and input using a PCH, or nil when it's disabled or not ready
+---@param config { cwd: string, exe: string, base_args: string[], user_args: string[] }
+---@param src string
+---@return { key: string, args: string[], src: string }?
+function M.get(config, src)
+  if not options.options.pch.enabled then
+    return nil
+  end
+  local lang, args = M.flags(config)
+  if lang ~= 'c' and lang ~= 'c++' then
+    return nil
+  end
+  local prefix, rest = split_source(src)
+  if not prefix then
+    return nil
+  end
+  local stat = uv.fs_stat(config.exe)
+  if not stat then
+    return nil
+  end
+
+  local key = lib.hash(config.exe, ('%d.%d'):format(stat.mtime.sec, stat.mtime.nsec),
+    config.cwd, lang, table.concat(args, '\0'), prefix)
+  local dir = cache_dir()
+  local header = ('%s/%s.h'):format(dir, key)
+  local clang = is_clang(config.exe)
+  local out = clang and (dir .. '/' .. key .. '.pch') or (header .. '.gch')
+
+  if status[key] == nil and uv.fs_stat(out) and uv.fs_stat(header) then
+    -- built by a previous session
+    status[key] = 'ready'
+  end
+  if status[key] == nil then
+    build(key, config.exe, config.cwd, lang, args, prefix)
+  end
+  if status[key] ~= 'ready' then
+    return nil
+  end
+
+  local compile_args = {}
+  for _, arg in ipairs(config.base_args) do
+    table.insert(compile_args, arg)
+  end
+  for _, arg in ipairs(config.user_args) do
+    table.insert(compile_args, arg)
+  end
+  if clang then
+    vim.list_extend(compile_args, { '-include-pch', out })
+  else
+    -- gcc falls back to the header text when the .gch doesn't fit, its quoted
+    -- includes need the source directory like in the build
+    vim.list_extend(compile_args, { '-iquote', config.cwd, '-include', header })
+  end
+  return { key = key, args = compile_args, src = rest }
+end
+
+--- Whether a failed compile's stderr says the compiler couldn't use the PCH
+---@param stderr string
+---@return boolean
+function M.rejected(stderr)
+  for _, pattern in ipairs(REJECTED) do
+    if stderr:find(pattern) then
+      return true
+    end
+  end
+  return false
+end
+
+--- Don't use a PCH again, eg when the compiler rejected it
+---@param key string
+function M.invalidate(key)
+  status[key] = 'failed'
+end
+
+return M
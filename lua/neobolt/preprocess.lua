@@ -0,0 +1,200 @@
+-- Shared preprocessing. Several asm buffers of one source, like -O0/-O2/-O3 views,
+-- would each preprocess the same headers. When their compilers and preprocessor
+-- flags match, the preprocessor runs once per source revision and every view
+-- compiles its output with `-x cpp-output` or `-x c++-cpp-output`. Linemarkers are
+-- kept, so `.loc` directives still point at `<stdin>`.
+
+local spawn = require('neobolt.spawn')
+
+local M = {}
+
+-- source language -> preprocessed language, for gcc and clang
+local OUTPUT_LANG = {
+  ['c'] = 'cpp-output',
+  ['c++'] = 'c++-cpp-output',
+}
+
+-- options taking a separate argument, that only the preprocessor uses
+local PP_ONLY_ARG = {
+  ['-D'] = true, ['-U'] = true, ['-I'] = true,
+  ['-include'] = true, ['-imacros'] = true,
+  ['-isystem'] = true, ['-iquote'] = true, ['-idirafter'] = true,
+}
+
+---@param arg string
+---@return boolean
+local function is_pp_only(arg)
+  return arg:find('^%-[DUI].') ~= nil or arg:find('^%-include.') ~= nil or
+         arg:find('^%-isystem.') ~= nil or arg:find('^%-iquote.') ~= nil or
+         arg:find('^%-nostdinc') ~= nil or arg:find('^%-Wp,') ~= nil
+end
+
+-- options that change the assembly, but not what the preprocessor produces. -Wp, is
+-- for the preprocessor, like -Wp,-D_FORTIFY_SOURCE=2 in distro CFLAGS
+---@param arg string
+---@return boolean
+local function is_backend_only(arg)
+  return (arg:find('^%-W') ~= nil and arg:find('^%-Wp,') == nil) or arg == '-w' or
+         arg:find('^%-g') ~= nil or arg:find('^%-masm=') ~= nil or
+         arg == '-fverbose-asm' or arg:find('^%-fopt%-info') ~= nil or
+         arg:find('^%-fsave%-optimization%-record') ~= nil or
+         arg:find('^%-fdiagnostics') ~= nil
+end
+
+-- -O1 to -O3 all define just __OPTIMIZE__
+local function normalize_arg(arg)
+  if arg == '-O' or arg == '-O1' or arg == '-O2' or arg == '-O3' then
+    return '-O2'
+  end
+  return arg
+end
+
+--- Split a compile into a preprocessor and a backend command. Returns nil when the
+--- config doesn't look like gcc or clang compiling C/C++ from stdin.
+---@param config { exe: string, base_args: string[], user_args: string[] }
+---@return { key: string, pp_args: string[], backend_args: string[] }?
+function M.split(config)
+  local base = config.base_args
+  local lang, lang_idx = nil, nil
+  local has_stdin = false
+  for i = 1, #base do
+    if base[i] == '-x' then
+      lang, lang_idx = base[i + 1], i + 1
+    elseif base[i] == '-' then
+      has_stdin = true
+    end
+  end
+  if not lang or not OUTPUT_LANG[lang] or not has_stdin then
+    return nil
+  end
+
+  local pp_args = { '-E', '-x', lang }
+  local backend_args = {}
+  local key = { config.exe, lang }
+
+  for i = 1, #base do
+    table.insert(backend_args, i == lang_idx and OUTPUT_LANG[lang] or base[i])
+  end
+
+  local user = config.user_args
+  local i = 1
+  while i <= #user do
+    local arg = user[i]
+    if PP_ONLY_ARG[arg] and user[i + 1] then
+      table.insert(pp_args, arg)
+      table.insert(pp_args, user[i + 1])
+      table.insert(key, arg .. user[i + 1])
+      i = i + 1
+    elseif is_pp_only(arg) then
+      table.insert(pp_args, arg)
+      table.insert(key, arg)
+    elseif is_backend_only(arg) then
+      table.insert(backend_args, arg)
+    else
+      -- -std, -m, -f and -O flags can define macros, both sides need them
+      table.insert(pp_args, arg)
+      table.insert(backend_args, arg)
+      table.insert(key, normalize_arg(arg))
+    end
+    i = i + 1
+  end
+  table.insert(pp_args, '-')
+
+  return {
+    key = table.concat(key, '\0'),
+    pp_args = pp_args,
+    backend_args = backend_args,
+  }
+end
+
+-- source buffer -> preprocessor key -> job
+---@type table<integer, table<string, { changedtick: integer, result: table?, waiters: function[], proc: table? }>>
+local jobs = {}
+
+--- Preprocess the source, or wait for the same revision to finish preprocessing.
+--- The callback gets the process, or nil when preprocessing failed to start.
+---@param src_buf integer
+---@param changedtick integer
+---@param split table From M.split
+---@param exe string
+---@param cwd string
+---@param src string
+---@param callback fun(proc: table?)
+function M.run(src_buf, changedtick, split, exe, cwd, src, callback)
+  jobs[src_buf] = jobs[src_buf] or {}
+  local job = jobs[src_buf][split.key]
+
+  if job and job.changedtick == changedtick then
+    if job.result then
+      callback(job.result)
+    else
+      table.insert(job.waiters, callback)
+    end
+    return
+  end
+
+  -- new revision. the old job still finishes for whoever waits on it
+  job = { changedtick = changedtick, result = nil, waiters = { callback } }
+  jobs[src_buf][split.key] = job
+
+  local proc, err = spawn(exe, split.pp_args, cwd, src, function(proc)
+    job.proc = nil
+    job.result = proc
+    local waiters = job.waiters
+    job.waiters = {}
+    for _, cb in ipairs(waiters) do
+      cb(proc)
+    end
+  end)
+  if not proc then
+    jobs[src_buf][split.key] = nil
+    vim.schedule(function()
+      vim.notify(('neobolt: preprocessor failed to start: %s'):format(err), vim.log.levels.WARN)
+    end)
+    callback(nil)
+    return
+  end
+  job.proc = proc
+end
+
+--- Number of compilers of a source buffer that would share preprocessing with a key
+---@param compilers table<integer, table> Registry.src_map entry
+---@param key string
+---@return integer
+function M.count_sharing(compilers, key)
+  local n = 0
+  for _, compiler in pairs(compilers or {}) do
+    local split = M.split({
+      exe = vim.fn.exepath(compiler.config.exe),
+      base_args = compiler.config.base_args,
+      user_args = compiler.config.user_args,
+    })
+    if split and split.key == key then
+      n = n + 1
+    end
+  end
+  return n
+end
+
+--- Forget cached output of a source buffer
+---@param src_buf integer
+function M.clear(src_buf)
+  local bufjobs = jobs[src_buf]
+  if bufjobs then
+    for _, job in pairs(bufjobs) do
+      if job.proc then job.proc:abort() end
+    end
+  end
+  jobs[src_buf] = nil
+end
+
+-- keep only the latest revision around, cleared when the buffer goes away
+vim.api.nvim_create_autocmd('BufUnload', {
+  group = vim.api.nvim_create_augroup('neobolt_preprocess', { clear = true }),
+  desc = 'neobolt: drop preprocessed source',
+  callback = function(ev)
+    M.clear(ev.buf)
+  end,
+})
+
+return M
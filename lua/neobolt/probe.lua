@@ -0,0 +1,212 @@
+-- Compiler capability probing, once per executable and cached on disk. Finds the
+-- compiler family, and the cheapest debug info flags that still map every source
+-- line. `-g` emits full .debug_info that gets piped, parsed and thrown away, while we
+-- only need .file and .loc directives.
+
+local uv = vim.loop
+local spawn = require('neobolt.spawn')
+
+local M = {}
+
+-- bump when probing changes
+local VERSION = 1
+
+-- small program with inlining, a loop and a branch, so optimized builds show which
+-- flags lose line info
+local PROBE_SRC = [[
+static inline int sq(int x) { return x * x; }
+int f(int *a, int n) {
+  int s = 0;
+  for (int i = 0; i < n; ++i)
+    s += sq(a[i]);
+  if (s > 100)
+    s -= 100;
+  return s;
+}
+]]
+
+-- candidates for replacing -g, any that map the same lines as -g can be used.
+-- gcc -g1 alone drops some statements at -O2, statement frontiers bring them back.
+local DEBUG_CANDIDATES = {
+  { '-gline-tables-only' },
+  { '-g1' },
+  { '-g1', '-gstatement-frontiers' },
+}
+
+---@class neobolt.ProbeInfo
+---@field family 'gcc'|'clang'|'unknown'
+---@field version string First line of --version
+---@field debug_args string[] Replacement for -g
+
+-- exe -> info, or false while probing
+local probed = {} ---@type table<string, neobolt.ProbeInfo|false>
+local disk = nil ---@type table?
+
+local function cache_path()
+  return vim.fn.stdpath('cache') .. '/neobolt/probe.json'
+end
+
+local function load_disk()
+  if disk then return disk end
+  disk = {}
+  local file = io.open(cache_path(), 'r')
+  if file then
+    local ok, obj = pcall(vim.json.decode, file:read('*a'))
+    file:close()
+    if ok and type(obj) == 'table' and obj.version == VERSION and type(obj.exes) == 'table' then
+      disk = obj.exes
+    end
+  end
+  return disk
+end
+
+local function save_disk()
+  vim.fn.mkdir(vim.fn.fnamemodify(cache_path(), ':h'), 'p')
+  local file = io.open(cache_path(), 'w')
+  if file then
+    file:write(vim.json.encode({ version = VERSION, exes = disk }))
+    file:close()
+  end
+end
+
+local function exe_id(exe)
+  local stat = uv.fs_stat(exe)
+  return stat and ('%d:%d'):format(stat.mtime.sec, stat.size)
+end
+
+-- source lines with a .loc, nil when there are none
+local function stdin_lines(asm)
+  local ids = {}
+  for id in asm:gmatch('%.file%s+(%d+)%s+"<stdin>"') do
+    ids[id] = true
+  end
+  for id in asm:gmatch('%.file%s+(%d+)%s+"[^"]*"%s+"<stdin>"') do
+    ids[id] = true
+  end
+  local lines, any = {}, false
+  for id, line in asm:gmatch('%.loc%s+(%d+)%s+(%d+)') do
+    if ids[id] then
+      lines[#lines + 1] = line
+      any = true
+    end
+  end
+  if not any then return nil end
+  table.sort(lines)
+  return table.concat(vim.fn.uniq(lines), ',')
+end
+
+-- run steps of an async probe as a coroutine
+local function run(exe, args, input)
+  local co = coroutine.running()
+  local proc = spawn(exe, args, uv.cwd(), input, function(proc)
+    coroutine.resume(co, proc)
+  end)
+  if not proc then
+    return nil
+  end
+  return coroutine.yield()
+end
+
+-- compile the probe program at -O0 and -O2, total output size and line maps
+local function compile(exe, debug_args)
+  local bytes, maps = 0, {}
+  for _, opt in ipairs({ '-O0', '-O2' }) do
+    local args = { '-S', '-x', 'c', '-o', '-', opt }
+    vim.list_extend(args, debug_args)
+    table.insert(args, '-')
+    local proc = run(exe, args, PROBE_SRC)
+    if not proc or proc.code ~= 0 then
+      return nil
+    end
+    local lines = stdin_lines(proc.stdout)
+    if not lines then
+      return nil
+    end
+    bytes = bytes + #proc.stdout
+    table.insert(maps, lines)
+  end
+  return bytes, table.concat(maps, ';')
+end
+
+local function probe(exe)
+  local info = { family = 'unknown', version = '', debug_args = { '-g' } }
+
+  local proc = run(exe, { '--version' }, '')
+  if proc and proc.code == 0 then
+    info.version = proc.stdout:match('[^\n]*') or ''
+    if proc.stdout:find('clang') then
+      info.family = 'clang'
+    elseif proc.stdout:find('Free Software Foundation') or proc.stdout:find('GCC') then
+      info.family = 'gcc'
+    end
+  end
+
+  local best_bytes, baseline = compile(exe, { '-g' })
+  if best_bytes then
+    for _, candidate in ipairs(DEBUG_CANDIDATES) do
+      local bytes, map = compile(exe, candidate)
+      if bytes and map == baseline and bytes < best_bytes then
+        best_bytes, info.debug_args = bytes, candidate
+      end
+    end
+  end
+  return info
+end
+
+--- Probe results for a compiler executable. Returns nil until known, and starts
+--- probing in the background.
+---@param exe string Full path
+---@param callback fun(info: neobolt.ProbeInfo)? Called when probing finishes
+---@return neobolt.ProbeInfo?
+function M.get(exe, callback)
+  local info = probed[exe]
+  if info then
+    return info
+  elseif info == false then
+    return nil -- probing
+  end
+
+  local id = exe_id(exe)
+  if not id then
+    return nil
+  end
+  local cached = load_disk()[exe]
+  if cached and cached.id == id then
+    probed[exe] = cached.info
+    return cached.info
+  end
+
+  probed[exe] = false
+  coroutine.wrap(function()
+    local ok, res = pcall(probe, exe)
+    if not ok then
+      res = { family = 'unknown', version = '', debug_args = { '-g' } }
+    end
+    probed[exe] = res
+    load_disk()[exe] = { id = id, info = res }
+    save_disk()
+    if callback then
+      callback(res)
+    end
+  end)()
+  return nil
+end
+
+--- Compiler family, from the executable name or else from probing. nil until known.
+---@param exe string Full path
+---@return 'gcc'|'clang'|nil
+function M.family(exe)
+  local name = vim.fs.basename(exe)
+  if name:find('clang') then
+    return 'clang'
+  elseif name:find('gcc') or name:find('g%+%+') then
+    return 'gcc'
+  end
+  -- cc, c++ and such
+  local info = M.get(exe)
+  if info and info.family ~= 'unknown' then
+    return info.family
+  end
+end
+
+return M
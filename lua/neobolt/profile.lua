@@ -0,0 +1,139 @@
+-- perf samples on asm lines. A `perf annotate --stdio` or `perf script` dump is read on
+-- a worker thread, libneobolt keeps per-instruction sums and matches them to the asm by
+-- normalized instruction text, so they follow the asm through recompiles. Lines show
+-- their share of all samples, colored from cold to hot relative to the hottest line.
+
+local api = vim.api
+local uv = vim.loop
+local lib = require('libneobolt')
+
+local M = {}
+
+local NS = api.nvim_create_namespace('neobolt_profile')
+
+-- from cold to hot, by share of the hottest line
+local HEAT = {
+  { 0.05, 'NeoboltHeat1' },
+  { 0.2, 'NeoboltHeat2' },
+  { 0.4, 'NeoboltHeat3' },
+  { 0.7, 'NeoboltHeat4' },
+  { math.huge, 'NeoboltHeat5' },
+}
+
+api.nvim_set_hl(0, 'NeoboltHeat1', { fg = '#5f87af', ctermfg = 67, default = true })
+api.nvim_set_hl(0, 'NeoboltHeat2', { fg = '#87af87', ctermfg = 108, default = true })
+api.nvim_set_hl(0, 'NeoboltHeat3', { fg = '#d7af5f', ctermfg = 179, default = true })
+api.nvim_set_hl(0, 'NeoboltHeat4', { fg = '#d7875f', ctermfg = 173, default = true })
+api.nvim_set_hl(0, 'NeoboltHeat5', { fg = '#ff5f5f', ctermfg = 203, bold = true, default = true })
+api.nvim_set_hl(0, 'NeoboltProfile', { link = 'Comment', default = true })
+
+-- asm buffer -> { path, profile?, work? }
+local profiles = {}
+
+-- on a worker thread, in a fresh lua state without the plugin's cpath
+local function load_work(lib_path, path)
+  local open = package.loadlib(lib_path, 'luaopen_libneobolt')
+  if not open then
+    return nil, 'libneobolt: cannot load ' .. lib_path
+  end
+  return open().profile_load(path)
+end
+
+local function heat(pct, max)
+  local ratio = pct / max
+  for _, entry in ipairs(HEAT) do
+    if ratio < entry[1] then
+      return entry[2]
+    end
+  end
+end
+
+--- Samples of the asm as virtual text, for the profile of the buffer if it has one
+---@param asm_buf integer
+---@param asm table? lib.parse result
+---@param offset integer 0-based row of the first asm line
+function M.render(asm_buf, asm, offset)
+  if not api.nvim_buf_is_valid(asm_buf) then
+    return
+  end
+  api.nvim_buf_clear_namespace(asm_buf, NS, 0, -1)
+  local entry = profiles[asm_buf]
+  if not entry or not entry.profile or not asm or not asm.kinds then
+    return
+  end
+
+  local res, err = entry.profile:match(asm.lines, asm.kinds)
+  if not res then
+    api.nvim_err_writeln('neobolt: ' .. err)
+    return
+  end
+
+  local max = 0
+  for _, pct in pairs(res.lines) do
+    max = math.max(max, pct)
+  end
+  for lnum, pct in pairs(res.lines) do
+    if pct >= 0.01 then
+      api.nvim_buf_set_extmark(asm_buf, NS, lnum + offset - 1, 0, {
+        virt_text = { { ('%5.2f%%'):format(pct), heat(pct, max) } },
+      })
+    end
+  end
+  for _, f in ipairs(res.functions) do
+    local text = ('%.2f%% of %d samples'):format(f[2], math.floor(res.total + 0.5))
+    if f[3] >= 0.01 then
+      text = text .. (', %.2f%% unmatched'):format(f[3])
+    end
+    api.nvim_buf_set_extmark(asm_buf, NS, f[1] + offset - 1, 0, {
+      virt_text = { { text, 'NeoboltProfile' } },
+    })
+  end
+end
+
+--- Read a perf dump for an asm buffer in the background, replacing its profile.
+--- `on_load` gets called once it's ready, to render it.
+---@param asm_buf integer
+---@param path string
+---@param on_load fun()
+function M.load(asm_buf, path, on_load)
+  path = vim.fn.fnamemodify(vim.fn.expand(path), ':p')
+  local lib_path = package.searchpath('libneobolt', package.cpath)
+  if not lib_path then
+    api.nvim_err_writeln('neobolt: libneobolt not found in package.cpath')
+    return
+  end
+
+  local entry = { path = path }
+  profiles[asm_buf] = entry
+  entry.work = uv.new_work(load_work, function(data, err)
+    vim.schedule(function()
+      if profiles[asm_buf] ~= entry then
+        return -- replaced or detached meanwhile
+      end
+      entry.work = nil
+      local profile
+      if data then
+        profile, err = lib.profile(data)
+      end
+      if not profile then
+        profiles[asm_buf] = nil
+        api.nvim_err_writeln(('neobolt: %s'):format(err))
+        return
+      end
+      entry.profile = profile
+      on_load()
+    end)
+  end)
+  entry.work:queue(lib_path, path)
+end
+
+--- Forget the profile of an asm buffer, and its marks
+---@param asm_buf integer
+function M.detach(asm_buf)
+  profiles[asm_buf] = nil
+  if api.nvim_buf_is_valid(asm_buf) then
+    api.nvim_buf_clear_namespace(asm_buf, NS, 0, -1)
+  end
+end
+
+return M
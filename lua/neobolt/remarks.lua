@@ -0,0 +1,193 @@
+-- Optimization remarks as diagnostics. Compiles get `-fsave-optimization-record`
+-- (clang) or `-fopt-info` (gcc) writing to a temporary file, libneobolt reads it on a
+-- worker thread, and remarks of the source show up on its lines and, through the
+-- `.loc` ranges, on the asm generated for those lines. Missed optimizations are
+-- warnings, passed ones info and analysis remarks hints.
+
+local api = vim.api
+local fs = vim.fs
+local uv = vim.loop
+local lib = require('libneobolt')
+local probe = require('neobolt.probe')
+local options = require('neobolt.options')
+
+local M = {}
+
+local NS_ASM = api.nvim_create_namespace('neobolt_remarks')
+
+local SEVERITY = {
+  passed = vim.diagnostic.severity.INFO,
+  missed = vim.diagnostic.severity.WARN,
+  analysis = vim.diagnostic.severity.HINT,
+}
+
+-- asm buffer -> namespace of its diagnostics in the source buffer, several asm
+-- buffers can show the same source
+local src_namespaces = {}
+
+-- on a worker thread, in a fresh lua state without the plugin's cpath
+local function load_work(lib_path, path, kinds)
+  local open = package.loadlib(lib_path, 'luaopen_libneobolt')
+  if not open then
+    return nil, 'libneobolt: cannot load ' .. lib_path
+  end
+  local data, err = open().remarks_load(path, '<stdin>', kinds)
+  os.remove(path)
+  return data, err
+end
+
+--- Compiler family for remark flags, nil when remarks are off or it's unknown
+---@param config { exe: string }
+---@return 'gcc'|'clang'|nil
+function M.family(config)
+  if not options.options.remarks.enabled then
+    return nil
+  end
+  return probe.family(config.exe)
+end
+
+--- Compiler arguments with remarks written to a new temporary file
+---@param config { remarks: string? } Compiler state config, `remarks` from M.family
+---@param args string[]
+---@return string[] args
+---@return string? path Remarks file, nil when not asked for
+function M.args(config, args)
+  if not config.remarks then
+    return args, nil
+  end
+  local path = vim.fn.tempname()
+  local res = vim.list_extend({}, args)
+  if config.remarks == 'clang' then
+    vim.list_extend(res, { '-fsave-optimization-record', '-foptimization-record-file=' .. path })
+  elseif options.options.remarks.analysis then
+    table.insert(res, '-fopt-info-all=' .. path)
+  else
+    table.insert(res, '-fopt-info-optimized-missed=' .. path)
+  end
+  return res, path
+end
+
+--- Read and remove a remarks file in the background. `callback` gets the remarks in
+--- lib.remarks_load form, or nil when there are none.
+---@param path string
+---@param callback fun(data: string?)
+function M.load(path, callback)
+  local lib_path = package.searchpath('libneobolt', package.cpath)
+  if not lib_path then
+    os.remove(path)
+    callback(nil)
+    return
+  end
+  local kinds = options.options.remarks.analysis and 'pma' or 'pm'
+  local work = uv.new_work(load_work, function(data)
+    -- a failed compile may not write the file, that's no remarks
+    vim.schedule(function()
+      callback(data)
+    end)
+  end)
+  work:queue(lib_path, path, kinds)
+end
+
+local function src_namespace(asm_buf)
+  local ns = src_namespaces[asm_buf]
+  if not ns then
+    ns = api.nvim_create_namespace(('neobolt_remarks_%d'):format(asm_buf))
+    src_namespaces[asm_buf] = ns
+  end
+  return ns
+end
+
+--- Show remarks of a compile on the source and its asm, or remove them when `data`
+--- is nil
+---@param asm_buf integer
+---@param src_buf integer
+---@param state table Rendered compiler state
+---@param data string? From M.load
+function M.render(asm_buf, src_buf, state, data)
+  local ns = src_namespace(asm_buf)
+  local list = data and lib.remarks(data) or {}
+  local source = fs.basename(state.config.exe)
+
+  local src_diags, by_line = {}, {}
+  for _, remark in ipairs(list) do
+    local line, col, kind, pass, message = remark[1], remark[2], remark[3], remark[5], remark[7]
+    local diag = {
+      lnum = line - 1,
+      col = math.max(col - 1, 0),
+      severity = SEVERITY[kind],
+      message = message,
+      source = source,
+      code = pass ~= '' and pass or nil,
+    }
+    table.insert(src_diags, diag)
+    by_line[line] = by_line[line] or {}
+    table.insert(by_line[line], diag)
+  end
+  if api.nvim_buf_is_valid(src_buf) then
+    vim.diagnostic.set(ns, src_buf, src_diags)
+  end
+
+  -- on the asm ranges of the remark's line and column, or the first range of its line
+  -- when no column matches
+  local asm_diags = {}
+  local asm = state.asm
+  if asm and asm.location_ranges and next(by_line) then
+    local first_row, matched = {}, {}
+    local function add(row, diag)
+      table.insert(asm_diags, {
+        lnum = row,
+        col = 0,
+        severity = diag.severity,
+        message = diag.message,
+        source = diag.source,
+        code = diag.code,
+      })
+    end
+    for i, range in ipairs(asm.location_ranges) do
+      local loc = asm.locations[i]
+      local diags = loc[1] == '<stdin>' and by_line[loc[2]]
+      if diags then
+        local row = range[1] + state.asm_row - 1
+        first_row[loc[2]] = math.min(first_row[loc[2]] or row, row)
+        for _, diag in ipairs(diags) do
+          if diag.col + 1 == loc[3] then
+            matched[diag] = true
+            add(row, diag)
+          end
+        end
+      end
+    end
+    for line, diags in pairs(by_line) do
+      for _, diag in ipairs(diags) do
+        if not matched[diag] and first_row[line] then
+          add(first_row[line], diag)
+        end
+      end
+    end
+  end
+  if api.nvim_buf_is_valid(asm_buf) then
+    vim.diagnostic.set(NS_ASM, asm_buf, asm_diags)
+  end
+end
+
+--- Remove the asm diagnostics, they're gone with the lines they were on. The source
+--- keeps its own until the new remarks are read.
+---@param asm_buf integer
+function M.clear_asm(asm_buf)
+  if api.nvim_buf_is_valid(asm_buf) then
+    vim.diagnostic.reset(NS_ASM, asm_buf)
+  end
+end
+
+--- Remove the remarks of an asm buffer
+---@param asm_buf integer
+---@param src_buf integer
+function M.detach(asm_buf, src_buf)
+  M.clear_asm(asm_buf)
+  local ns = src_namespaces[asm_buf]
+  if ns and api.nvim_buf_is_valid(src_buf) then
+    vim.diagnostic.reset(ns, src_buf)
+  end
+end
+
+return M
@@ -0,0 +1,127 @@
+-- Compile job scheduler. Limits the number of compilers running at once, so a change
+-- in a source buffer with several asm buffers doesn't start all of them together.
+-- Asm buffers visible in the current tabpage go first, hidden ones wait until they
+-- are shown. A buffer is queued at most once, it compiles the newest source anyway.
+
+local api = vim.api
+local uv = vim.loop
+local options = require('neobolt.options')
+
+local M = {}
+
+-- compiler -> queue sequence number
+local queue = {}
+-- compiler -> true
+local running = {}
+local running_count = 0
+local seq = 0
+
+-- M.run is reentrant through compilers that finish right away (cache hits)
+local in_run = false
+local run_again = false
+
+--- Max concurrent compilers
+---@return integer
+function M.max_jobs()
+  local jobs = options.options.jobs
+  if type(jobs) == 'number' and jobs >= 1 then
+    return math.floor(jobs)
+  end
+  local cores = uv.available_parallelism and uv.available_parallelism() or #(uv.cpu_info() or {})
+  return math.max(cores - 1, 1)
+end
+
+local function is_visible(compiler)
+  for _, win in ipairs(api.nvim_tabpage_list_wins(0)) do
+    if api.nvim_win_get_buf(win) == compiler.asm_buf then
+      return true
+    end
+  end
+  return false
+end
+
+-- oldest request of a visible buffer
+local function pick()
+  local best, best_seq = nil, math.huge
+  for compiler, n in pairs(queue) do
+    if compiler:destroyed() then
+      queue[compiler] = nil
+    elseif n < best_seq and is_visible(compiler) then
+      best, best_seq = compiler, n
+    end
+  end
+  return best
+end
+
+--- Start queued compiles while there are free slots
+function M.run()
+  if in_run then
+    run_again = true
+    return
+  end
+  in_run = true
+  repeat
+    run_again = false
+    local limit = M.max_jobs()
+    while running_count < limit do
+      local compiler = pick()
+      if not compiler then break end
+      queue[compiler] = nil
+      running[compiler] = true
+      running_count = running_count + 1
+      -- calls M.finished when done, possibly right away
+      local ok, err = pcall(compiler.start, compiler)
+      if not ok then
+        M.finished(compiler)
+        vim.schedule(function() error(err) end)
+      end
+    end
+  until not run_again
+  in_run = false
+end
+
+--- Queue a compile. Replaces an already queued request of the same compiler.
+---@param compiler table
+function M.submit(compiler)
+  if not queue[compiler] then
+    seq = seq + 1
+    queue[compiler] = seq
+  end
+  M.run()
+end
+
+--- Compiler is done, or its process was killed
+---@param compiler table
+function M.finished(compiler)
+  if running[compiler] then
+    running[compiler] = nil
+    running_count = running_count - 1
+    M.run()
+  end
+end
+
+--- Remove queued request and release the slot
+---@param compiler table
+function M.cancel(compiler)
+  queue[compiler] = nil
+  M.finished(compiler)
+end
+
+---@param compiler table
+---@return boolean
+function M.is_queued(compiler)
+  return queue[compiler] ~= nil
+end
+
+-- hidden buffers start compiling when shown
+api.nvim_create_autocmd({ 'BufWinEnter', 'TabEnter' }, {
+  group = api.nvim_create_augroup('neobolt_scheduler', { clear = true }),
+  desc = 'neobolt: start deferred compiles',
+  callback = function()
+    if next(queue) ~= nil then
+      M.run()
+    end
+  end,
+})
+
+return M
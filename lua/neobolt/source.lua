@@ -0,0 +1,104 @@
+-- Source buffer text for the compiler. Instead of nvim_buf_get_lines and a concat of
+-- the whole buffer on every compile, a gap buffer in libneobolt follows the edits
+-- from nvim_buf_attach on_bytes. Shared by all compilers of a source buffer.
+
+local api = vim.api
+local lib = require('libneobolt')
+
+local M = {}
+
+---@class neobolt.Source
+---@field gap userdata lib.gapbuf
+---@field refs integer Attached compilers
+---@field attached boolean nvim_buf_attach is active
+---@field str string? Text of the current revision, if materialized
+
+---@type table<integer, neobolt.Source>
+local sources = {}
+
+-- every line ends with a newline, same as on_bytes offsets
+local function full_text(buf)
+  local lines = api.nvim_buf_get_lines(buf, 0, -1, false)
+  if #lines == 0 then
+    return ''
+  end
+  return table.concat(lines, '\n') .. '\n'
+end
+
+local function reload(buf, src)
+  src.gap:set(full_text(buf))
+  src.str = nil
+end
+
+--- Start following a source buffer
+---@param buf integer
+function M.attach(buf)
+  local src = sources[buf]
+  if src then
+    src.refs = src.refs + 1
+    return
+  end
+
+  src = { gap = lib.gapbuf(), refs = 1, attached = false, str = nil }
+  sources[buf] = src
+  reload(buf, src)
+
+  src.attached = api.nvim_buf_attach(buf, false, {
+    on_bytes = function(_, b, _, start_row, start_col, offset,
+                        _, _, old_len, new_end_row, new_end_col, new_len)
+      if sources[b] ~= src then
+        return true -- detach
+      end
+      local text = ''
+      if new_len > 0 then
+        local end_col = new_end_row == 0 and (start_col + new_end_col) or new_end_col
+        text = table.concat(
+          api.nvim_buf_get_text(b, start_row, start_col, start_row + new_end_row, end_col, {}),
+          '\n')
+      end
+      if not pcall(src.gap.replace, src.gap, offset, old_len, text) then
+        -- out of sync somehow, start over
+        reload(b, src)
+      end
+      src.str = nil
+    end,
+    on_reload = function(_, b)
+      if sources[b] == src then
+        reload(b, src)
+      end
+    end,
+    on_detach = function(_, b)
+      if sources[b] == src then
+        src.attached = false
+      end
+    end,
+  })
+end
+
+--- Stop following a source buffer, once per M.attach
+---@param buf integer
+function M.detach(buf)
+  local src = sources[buf]
+  if not src then return end
+  src.refs = src.refs - 1
+  if src.refs <= 0 then
+    -- on_bytes detaches on the next change
+    sources[buf] = nil
+  end
+end
+
+--- Buffer text as one string
+---@param buf integer
+---@return string
+function M.get(buf)
+  local src = sources[buf]
+  if not src or not src.attached then
+    return full_text(buf)
+  end
+  if not src.str then
+    src.str = src.gap:get()
+  end
+  return src.str
+end
+
+return M
@@ -9,12 +9,16 @@ function Process.__index:abort()
   end
 end
 
-return function(exe, args, cwd, input, callback)
+--- Spawn a process, feed it `input` and collect its output
+---@param fds integer[]? Extra file descriptors, passed as fd 3 and up. Closed when
+---                     the process is aborted, otherwise they are the caller's.
+return function(exe, args, cwd, input, callback, fds)
   assert(type(exe) == 'string')
   assert(type(args) == 'table')
   assert(type(cwd) == 'string')
   assert(type(input) == 'string')
   assert(type(callback) == 'function')
+  fds = fds or {}
 
   local self = setmetatable({
     _proc = nil,
@@ -23,11 +27,18 @@ return function(exe, args, cwd, input, callback)
     cwd = cwd,
     exe = exe,
     args = args,
+    fds = fds,
 
     code = nil,
     signal = nil,
     time = nil,
 
+    -- uv.hrtime timestamps, for tracing
+    ts_start = nil,
+    ts_spawned = nil,
+    ts_first_byte = nil,
+    ts_exit = nil,
+
     stdout = nil,
     stderr = nil,
   }, Process)
@@ -40,11 +51,17 @@ return function(exe, args, cwd, input, callback)
   local stderr = assert(uv.new_pipe())
 
   local ts = uv.hrtime()
+  self.ts_start = ts
+
+  local stdio = { stdin, stdout, stderr }
+  for _, fd in ipairs(fds) do
+    table.insert(stdio, fd)
+  end
 
   local spawn_err
   self._proc, spawn_err = uv.spawn(exe, {
     args = args,
-    stdio = { stdin, stdout, stderr },
+    stdio = stdio,
   }, function(code, signal)
     stdin:close()
     stdout:close()
@@ -54,10 +71,14 @@ return function(exe, args, cwd, input, callback)
     self._proc = nil
 
     if self._abort then
+      for _, fd in ipairs(fds) do
+        uv.fs_close(fd)
+      end
       return
     end
 
-    self.time = (uv.hrtime() - ts) / 1e+9
+    self.ts_exit = uv.hrtime()
+    self.time = (self.ts_exit - ts) / 1e+9
     self.code = code
     self.signal = signal
     self.stderr = table.concat(err)
@@ -74,9 +95,13 @@ return function(exe, args, cwd, input, callback)
     stderr:close()
     return nil, spawn_err
   end
+  self.ts_spawned = uv.hrtime()
 
   stdout:read_start(function(_, data)
     if data then
+      if not self.ts_first_byte then
+        self.ts_first_byte = uv.hrtime()
+      end
       table.insert(out, data)
     end
   end)
@@ -0,0 +1,101 @@
+-- Chrome trace event recorder. The output loads in Perfetto or chrome://tracing.
+-- https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+local uv = vim.loop
+
+local M = {}
+
+-- nil when tracing is disabled
+local events = nil ---@type table[]?
+local path = nil ---@type string?
+local pid = uv.os_getpid()
+-- track ids that already got a name
+local named = {}
+
+--- Whether tracing is enabled
+---@return boolean
+function M.enabled()
+  return events ~= nil
+end
+
+--- Start recording. Previous unsaved events are discarded.
+---@param file string Output path
+function M.start(file)
+  assert(type(file) == 'string', 'expected string')
+  events = {}
+  path = file
+  named = {}
+  -- don't lose the trace when quitting without stopping it
+  vim.api.nvim_create_autocmd('VimLeavePre', {
+    group = vim.api.nvim_create_augroup('neobolt_trace', { clear = true }),
+    once = true,
+    callback = function()
+      if events then M.stop() end
+    end,
+  })
+end
+
+--- Stop recording and write the trace
+---@return boolean ok
+---@return string? err
+function M.stop()
+  if not events then
+    return false, 'tracing is not enabled'
+  end
+  local data = vim.json.encode({
+    traceEvents = events,
+    displayTimeUnit = 'ms',
+  })
+  local file, err = io.open(path, 'w')
+  events, path = nil, nil
+  if not file then
+    return false, err
+  end
+  file:write(data)
+  file:close()
+  return true
+end
+
+-- asm buffers get their own tracks, so concurrent compilers don't overlap
+local function track(tid)
+  tid = tid or 0
+  if not named[tid] then
+    named[tid] = true
+    table.insert(events, {
+      name = 'thread_name', ph = 'M', pid = pid, tid = tid,
+      args = { name = tid == 0 and 'neobolt' or ('neobolt://%d'):format(tid) },
+    })
+  end
+  return tid
+end
+
+--- Record a complete span. Timestamps are from uv.hrtime, in nanoseconds.
+---@param tid integer? Track, asm buffer number
+---@param name string
+---@param ts_start number
+---@param ts_end number
+---@param args table?
+function M.span(tid, name, ts_start, ts_end, args)
+  if not events or not ts_start or not ts_end then return end
+  table.insert(events, {
+    name = name, ph = 'X', pid = pid, tid = track(tid),
+    ts = ts_start / 1e3, dur = (ts_end - ts_start) / 1e3,
+    args = args,
+  })
+end
+
+--- Record an instant event. Timestamp is from uv.hrtime, in nanoseconds.
+---@param tid integer? Track, asm buffer number
+---@param name string
+---@param ts number
+---@param args table?
+function M.instant(tid, name, ts, args)
+  if not events or not ts then return end
+  table.insert(events, {
+    name = name, ph = 'i', s = 't', pid = pid, tid = track(tid),
+    ts = ts / 1e3,
+    args = args,
+  })
+end
+
+return M
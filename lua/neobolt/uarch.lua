@@ -0,0 +1,74 @@
+-- Microarchitecture for block cycle estimates. libneobolt has cost tables for a few
+-- cores, each stands in for its neighbours: the compiler flags pick the closest one,
+-- otherwise the compiler target, otherwise the host.
+
+local uv = vim.loop
+local options = require('neobolt.options')
+
+local M = {}
+
+-- lua patterns of -march/-mtune/-mcpu values, first match wins
+local CPUS = {
+  { 'znver', 'zen3' },
+  { 'amdfam', 'zen3' },
+  { 'bdver', 'zen3' },
+  { 'btver', 'zen3' },
+  { 'neoverse', 'neoverse-n1' },
+  { 'cortex', 'neoverse-n1' },
+  { 'apple', 'neoverse-n1' },
+  { 'armv', 'neoverse-n1' },
+  { 'ampere', 'neoverse-n1' },
+  { '^rv', nil }, -- risc-v, no table
+  -- intel cores and generic x86
+  { '.', 'skylake' },
+}
+
+local function from_cpu(cpu)
+  for _, entry in ipairs(CPUS) do
+    if cpu:find(entry[1]) then
+      return entry[2]
+    end
+  end
+end
+
+local function from_target(name)
+  name = name:lower()
+  if name:find('aarch64') or name:find('arm64') or name:find('^arm') then
+    return 'neoverse-n1'
+  elseif name:find('x86') or name:find('amd64') or name:find('i%d86') then
+    return 'skylake'
+  end
+end
+
+--- Cost model for a compile, nil when estimates are disabled
+---@param config { exe: string, base_args: string[], user_args: string[] }
+---@return string?
+function M.get(config)
+  local costs = options.options.costs
+  if not costs.enabled then
+    return nil
+  elseif costs.uarch then
+    return costs.uarch
+  end
+
+  -- -mtune says what the code is tuned for, more so than -march
+  local march, mtune, target = nil, nil, nil
+  for _, args in ipairs({ config.base_args, config.user_args }) do
+    for i, arg in ipairs(args) do
+      march = arg:match('^%-march=(.+)') or arg:match('^%-mcpu=(.+)') or march
+      mtune = arg:match('^%-mtune=(.+)') or mtune
+      target = arg:match('^%-%-target=(.+)') or arg:match('^%-target=(.+)')
+        or (arg == '-target' and args[i + 1]) or target
+    end
+  end
+  local cpu = mtune or march
+  if cpu and cpu ~= 'native' then
+    return from_cpu(cpu:lower())
+  end
+  return (target and from_target(target))
+    or from_target(vim.fs.basename(config.exe))
+    or from_target(uv.os_uname().machine)
+    or 'skylake'
+end
+
+return M
@@ -10,3 +10,8 @@ end, {
     return require('neobolt.command')._complete('Neobolt', arglead, cmdline, pos)
   end
 })
+
+-- detect compilers in the background, for completion and the first :Neobolt
+vim.schedule(function()
+  require('neobolt.compilers').prefetch()
+end)
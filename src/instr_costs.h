@@ -0,0 +1,1243 @@
+/* Generated by neobolt_lut from src/instr_costs.txt, do not edit. */
+/* Run `make lut` to regenerate it. */
+
+#define INSTR_COST_TOTAL_KEYWORDS 589
+#define INSTR_COST_MIN_WORD_LENGTH 1
+#define INSTR_COST_MAX_WORD_LENGTH 12
+#define INSTR_COST_TABLE_SIZE 2048
+
+static unsigned int
+instr_cost_hash (const char *str, size_t len)
+{
+  static const unsigned short displace[] =
+    {
+          0,     0,     0,     0,     1,     0,     0,     0,     0,     0,
+          0,     0,     0,     1,     1,     0,     0,     1,     1,     0,
+          0,     0,     0,     1,     0,     1,     0,     0,     0,     0,
+          0,     0,     0,     1,     0,     0,     0,     1,     0,     0,
+          2,     1,     0,     1,     0,     0,     1,     0,     0,     1,
+          0,     1,     0,     1,     0,     0,     0,     0,     0,     0,
+          0,     3,     0,     0,     0,     0,     0,     0,     0,     1,
+          1,     0,     2,     0,     0,     0,     1,     0,     0,     0,
+          0,     0,     0,     0,     0,     1,     0,     0,     0,     0,
+          0,     0,     0,     0,     0,     2,     0,     3,     0,     0,
+          1,     2,     2,     1,     0,     0,     0,     0,     0,     0,
+          0,     0,     0,     0,     1,     1,     1,     0,     1,     0,
+          2,     0,     0,     0,     0,     1,     0,     0,     0,     0,
+          0,     1,     0,     0,     0,     0,     0,     0,     0,     1,
+          0,     0,     1,     0,     0,     2,     0,     0,     0,     0,
+          0,     1,     1,     0,     0,     0,     0,     1,     0,     0,
+          2,     3,     0,     1,     0,     0,     0,     1,     0,     0,
+          0,     1,     0,     0,     1,     0,     0,     1,     0,     0,
+          1,     0,     0,     0,     0,     0,     0,     0,     2,     0,
+          0,     0,     0,     0,     3,     1,     0,     0,     0,     0,
+          0,     0,     0,     0,     2,     0,     1,     0,     0,     1,
+          0,     1,     4,     0,     0,     0,     0,     1,     2,     0,
+          0,     0,     3,     0,     0,     2,     0,     1,     0,     0,
+          0,     0,     2,     0,     1,     0,     1,     0,     0,     0,
+          0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+          1,     0,     0,     0,     2,     0
+    };
+  unsigned int hash = 0x811C9DC5u;
+  for (size_t i = 0; i < len; ++i)
+    hash = (hash ^ (unsigned char)str[i]) * 0x01000193u;
+
+  unsigned int x = hash ^ displace[hash >> 24];
+  x ^= x >> 15;
+  x *= 0x2C1B3C6Du;
+  x ^= x >> 12;
+  return x & 2047u;
+}
+
+static const struct InstrCost *
+instr_cost_lookup (const char *str, size_t len)
+{
+  static const unsigned char lengthtable[] =
+    {
+       0,  0,  3,  8,  0,  0,  0,  5,  7,  0,  0,  0,  0,  0,
+       7,  0,  0,  0, 10,  3,  0,  0,  0,  6,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  9,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,
+       0,  0,  6,  0,  0,  9,  0,  0,  0,  0,  0,  0,  0,  6,
+       0,  0,  0,  0,  0,  7,  0,  0,  0,  0,  0,  0,  0,  0,
+       9,  7,  8,  0,  0,  6,  7,  0,  0,  0,  0,  0,  0,  6,
+       6,  0,  0,  0,  5,  0,  7,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  6,  0,  0,  0,  0,  0,  0,  0,  5,  0,  4,  0,
+       7,  0,  5,  6,  0,  0,  0, 12,  0,  0,  0,  0,  0, 10,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  3,  6,  0,  6,
+       5,  0,  0,  0,  0,  6,  0,  0,  5,  0,  0,  0,  0,  0,
+       9, 12,  0,  0,  0,  0,  0,  0,  0,  7,  0,  0,  0,  0,
+       0,  7,  0,  0,  5,  0,  0,  4,  4,  0,  5,  6,  0,  0,
+       0,  4,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  4,  0,  4,  0,  0,  0,  0,  0,  3,  0,  5,  0,  0,
+       5,  0,  0,  0,  0,  0,  6,  0,  0,  5,  4,  0,  5,  6,
+       5,  0,  0,  0,  7,  0,  0,  0,  0,  0,  7, 12,  0,  0,
+       0,  5,  0,  0,  0,  0,  0, 10,  0,  0,  0,  0,  0,  0,
+       0, 12,  0,  0,  0,  0,  0,  0,  0,  0,  8,  0,  0,  0,
+       0,  7,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  5,  6,
+       0,  7,  6,  4,  0,  0,  0,  0,  0,  0,  5,  3,  0,  5,
+       4,  0,  4,  0,  0,  0,  0,  0,  0,  0,  5,  5,  0,  6,
+       0,  0,  0,  0,  0,  3,  0,  0,  0,  0,  0,  0,  0,  7,
+       0,  0,  0,  0,  0,  0, 11,  6,  5,  0,  6,  0,  0,  0,
+       5,  5,  0,  0,  0,  7,  0,  0,  0,  5,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  7,  0,  0,  8,  0,  0,  5,
+       5, 11,  0,  0,  0,  6,  0,  6,  0,  0, 11,  0,  0,  3,
+       0,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  8,  6,  0,  0,  8,  0,  0,  0,  7, 11,
+       5,  0,  8,  0,  3,  8, 12,  0,  0,  0,  0,  5, 11,  0,
+       0,  3,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  9,  0,
+       0,  6,  0,  0,  4,  9,  0,  4,  8,  0,  0,  0,  0,  0,
+       0,  7,  0,  0,  0,  0,  3, 12,  5,  4,  0,  0,  7,  0,
+       0,  0,  0,  7,  0,  9,  7,  3,  0,  0,  0,  6,  0,  6,
+       5,  9,  0,  0,  0,  6,  0,  0,  0,  0,  0,  8,  0,  0,
+       0,  4,  6,  4,  0,  0,  0,  0,  6,  0,  0,  0,  6,  3,
+       0,  5,  0,  0,  9,  0,  6,  6,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0, 11,  0,  0,  3,  0,  0,  6,
+       4,  6,  7,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,
+       3,  6,  0,  0,  0,  0,  0,  0,  6, 12,  0, 11, 10,  4,
+       7,  3,  0,  0,  0,  0,  6,  3,  0,  0,  0,  6,  0,  5,
+       0,  0,  0,  3,  0,  0,  9,  0,  6,  0,  0,  6,  0,  0,
+      10,  0,  3,  0,  0,  0,  4,  0,  0,  6,  0,  0,  0,  5,
+       0,  4,  0,  0,  0,  0,  0,  0,  0,  4,  7,  0,  8,  7,
+       0,  0,  0,  0,  0,  8,  6,  0,  0,  0,  0,  0,  7,  0,
+       7,  0,  0,  5,  8,  0,  0,  9,  7,  0,  0,  0,  0,  0,
+       4,  0,  0,  0,  7,  0,  0, 12,  0,  0,  0,  8,  0, 11,
+       0,  0,  0,  0,  0,  0,  0,  0,  6,  0,  0,  5,  0,  0,
+       0,  0,  9,  0,  7,  6,  0,  5,  3,  0,  0,  0,  0,  0,
+       6,  0,  0,  0,  0,  4,  0,  6,  0,  0,  4,  8,  0,  0,
+       0,  6,  0,  4,  0,  0,  0,  0,  0,  0,  6,  0,  0,  0,
+       0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  4,  0,  0,
+       0,  0,  0,  0,  9,  0,  0,  0,  0,  0,  4,  0,  0,  6,
+       4,  0,  5,  0,  0,  0,  0,  0,  8,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  5,  0,  0,  0,  6,  3,  0,  5,  3,  0,
+       7,  0,  0,  6,  0,  0,  0,  0,  8,  0,  0,  0,  9,  4,
+       0,  0,  8,  0,  6,  0,  0,  0,  0,  0,  6,  6,  0,  7,
+       0,  0, 10,  0,  4,  5,  5,  0,  0,  6,  0,  0,  0,  4,
+       0,  0,  0,  0,  0,  0,  0,  0,  6,  7,  7,  0,  0,  0,
+      10,  0,  7,  4,  0,  0,  0,  0,  0,  0,  0,  0,  9,  0,
+       0,  0,  0,  0,  0,  6,  0,  0,  8,  0,  0,  5,  0,  6,
+       4,  0,  4,  0,  5,  3,  0,  0,  6,  5,  0,  0,  7,  0,
+       0,  5,  0,  0,  0,  0,  0,  0,  9,  0,  0,  0,  0,  0,
+       4,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  7, 11,  0,  0,  0,  0,  0,  5,  8,  6,  0,  0,
+       0,  0,  0,  0,  0,  4,  2,  0,  0,  0,  0,  7,  3,  0,
+       0,  6,  0,  0,  0,  6,  8,  0,  0,  0,  0,  0,  0,  0,
+       0,  6,  8,  0,  0,  0,  0,  0,  6,  7,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  5,  3,  0,  0,
+       0,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0, 12,  9,  0,
+       0,  0,  0,  0,  0,  4, 11,  0,  0,  8,  3,  0,  0,  4,
+       0,  6,  0,  0,  0,  0,  5, 12,  0,  0,  0,  8,  4,  0,
+      10,  5, 11,  4,  6,  0,  8,  0,  8,  9, 12,  3,  0,  0,
+       0,  4,  0,  0,  0,  0,  0,  0,  0,  5,  6,  0,  0,  9,
+       0,  7,  3,  0,  0,  7,  7,  0,  0,  0,  0,  0,  0,  8,
+       0,  0,  7,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  4,  0,  0,  0,  3,  0,  0,  3,  0,  0,
+       5,  0,  9,  0,  2,  0,  2,  0,  0,  0,  0,  0,  3,  0,
+       0,  0,  0,  0,  0,  0,  0,  4,  8,  7,  4,  0,  0,  0,
+       0,  0,  0,  0,  0,  5,  0,  0,  9,  0,  0,  0,  0,  0,
+       0,  0,  9,  6,  0,  0,  0,  0,  0,  0,  0,  6,  0,  0,
+       6,  0,  0,  5,  0,  0,  5,  0,  0,  5,  0,  9,  0,  0,
+       5,  0,  4,  0,  0,  0,  0,  0,  0,  0,  8,  0,  4,  9,
+       6,  0,  6,  8,  0,  0,  0,  0,  0,  0,  0,  5,  0,  5,
+       0,  9,  6,  4,  5,  0,  0,  0,  5,  6,  0,  4,  9,  0,
+       0,  4,  4,  0,  0,  0,  0,  6,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  9,  3,  0,  8,  9,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  4,  4,  0,  0,  0,  0,  0,  4,
+       3,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  9,
+       0,  0,  0,  0,  0,  0,  0,  0,  7,  0,  4,  4,  0,  0,
+       0,  0,  5,  0,  0,  6,  0,  0,  0,  0,  8,  0,  0,  0,
+       0,  0,  0,  7,  8,  4,  0,  0,  0,  0,  7,  3,  7,  7,
+       0, 11,  6,  4,  0,  0,  0, 10,  0,  0,  0,  0,  0,  0,
+       7,  4,  0,  0,  0,  5,  0,  0,  0,  9,  0,  0,  0,  0,
+      10,  0,  0,  0,  0,  0,  3,  0,  5,  9,  0,  5, 10,  0,
+       0,  3,  0,  0,  0,  0, 11,  6,  0,  0,  0,  0,  0,  0,
+       5,  0,  3,  0, 10,  0,  0,  0,  0,  0,  0,  5,  7,  0,
+       7,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  6,  5,  0,  5,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       0, 11,  0,  3,  0,  0,  0,  0,  4,  9,  8,  4,  0,  0,
+       0,  0,  0,  0,  0,  0,  5,  0,  9,  4,  0,  3,  0,  0,
+       3,  0,  3,  0,  0,  0, 10,  6,  0,  0,  0,  0,  0,  0,
+       0,  0,  3,  4,  6,  0,  0,  0,  6,  0,  0,  0,  0,  0,
+       0,  3,  0,  6,  7,  0,  0, 12,  9,  0,  0,  8,  0,  7,
+       0,  0,  0,  0,  0,  0,  6,  0,  0,  5,  0,  0,  5,  0,
+       0,  0,  0,  0,  6,  0,  0,  7,  0,  0,  6,  0,  0,  3,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  7,  8, 11,  0,  0,
+       0,  0,  0,  9,  0,  0,  0,  0,  5,  3,  0,  0,  6,  8,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  3,  0,
+       0,  0,  0,  5,  0,  0,  0,  7,  6,  0,  0,  0,  0,  0,
+       6,  0,  0,  7,  0,  0,  0,  0,  0,  0,  8,  0,  0,  0,
+       1,  0,  0,  4,  0, 11,  6,  0,  3,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  4,  0,  8,  5,  0,  0,
+       0,  0,  4,  0,  0,  0,  0,  8,  0,  5,  6,  0,  5,  7,
+       4,  0,  0,  6,  6,  0,  0,  0,  0,  6,  0,  4,  0,  0,
+       0,  0,  6,  9,  0,  0,  3,  0,  0,  0,  0,  4,  6,  0,
+       0,  0,  0,  0,  0,  6,  0,  6,  0,  3,  6,  8,  0,  6,
+       0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  8,
+       0,  5,  0,  3,  4,  3,  9,  0,  0,  3,  0,  0,  0,  0,
+       0,  7,  0,  0,  0,  3,  0,  0,  0,  0,  0,  0,  0,  0,
+       7,  0,  0,  3,  5, 11,  0,  0,  0,  5,  0,  8,  5,  0,
+       0,  0,  3,  0,  8,  0,  7,  0,  0,  0,  0,  0,  7,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,  0,  0,
+       0,  7,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+       5,  0,  0,  7,  0,  0,  0,  8,  6,  0,  0,  4,  0,  0,
+      12,  0,  0,  0,  0,  0,  5,  0,  0,  0,  5,  0,  5,  0,
+       6,  0,  0,  4,  0,  4,  0,  0,  0,  0,  6,  0,  8,  0,
+       0,  0,  7,  5,  0,  4,  0,  0,  0,  6,  0,  0,  0,  0,
+       0,  6,  5,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0,
+       9,  0,  0,  0,  5,  6,  0,  7,  6,  0,  0,  0,  6,  0,
+       0,  0,  5,  0,  0, 11,  0,  5,  0,  0,  0,  0,  0,  0,
+       0,  0,  0,  5,  4,  0,  6,  0, 12,  9,  0,  2,  5,  0,
+       0,  0,  0,  0,  0,  0,  0,  3,  0,  4,  6,  0,  0,  0,
+       0,  0,  0,  0,  3,  6,  6,  0,  7,  0, 12, 10,  0,  0,
+       5,  0,  5,  0,  0,  0,  0,  6,  4, 10,  4,  5,  0,  0,
+       0,  4,  0,  0,  6,  0,  0,  0,  0,  0,  6,  0,  5,  3,
+       0,  8,  9,  0,  0,  0, 12,  0,  0,  0,  0,  0,  7,  0,
+       0,  0,  7,  0,  6,  4,  0,  0,  0,  7,  0,  3,  0,  0,
+       0,  0, 11,  0,  0,  0,  3,  0,  3,  0,  0,  7,  0,  0,
+       0,  0,  7,  0,  0,  0,  0,  6,  3,  8,  0,  0,  0,  0,
+       0,  0,  0,  0,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,
+       0,  0,  0,  0,  4,  0,  4,  0,  8,  6,  0,  0,  4,  0,
+       0,  0,  0,  7,  8,  9,  0,  0,  0,  0, 11,  0,  0, 11,
+       0,  0,  0,  0
+    };
+  static const struct InstrCost wordlist[] =
+    {
+      {""}, {""},
+      {"ror", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {"vpcmpeqq", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"csneg", { NA, NA, COST(1, 33, N1_I) }},
+      {"endbr64", { COST(0, 25, 0), COST(0, 17, 0), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpmaxsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpunpckldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"cnt", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""},
+      {"vsubsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""},
+      {"cvttps2dq", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"fmax", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"pmuldq", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"vmovdqu32", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpaddw", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpminub", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vcvtsd2ss", { COST(5, 100, SKL_P01), COST(3, 100, ZEN_FP), NA }},
+      {"vmovupd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"pmovsxbw", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"vminps", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {"vmovdqu", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpandd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"umaddl", { NA, NA, COST(2, 100, N1_M) }},
+      {""}, {""}, {""},
+      {"paddb", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpmuldq", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"vaddps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"bswap", { COST(2, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"fadd", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"vpminsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"ubfiz", { NA, NA, COST(1, 33, N1_I) }},
+      {"vminsd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"vfnmadd231ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vcvttss2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"jcc", { COST(1, 50, SKL_P06), COST(1, 50, ZEN_BR), NA }},
+      {"comiss", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""},
+      {"vpsrlw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"csinv", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"haddpd", { COST(6, 200, SKL_P5), COST(6, 200, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"csetm", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpmovzxwd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vfnmsub231sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpcmpud", { COST(3, 100, SKL_P5), NA, NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpminsd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"fmadd", { NA, NA, COST(4, 50, N1_V) }},
+      {""}, {""},
+      {"uxth", { NA, NA, COST(1, 33, N1_I) }},
+      {"ldur", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""},
+      {"minss", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {"vpsubd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"pxor", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"pandn", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"shrx", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"addv", { NA, NA, COST(4, 100, N1_V1) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"cdq", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"crc32", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_MUL), NA }},
+      {""}, {""},
+      {"vmovq", { COST(2, 100, SKL_P05), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpsraw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"divss", { COST(11, 300, SKL_P0), COST(10, 350, ZEN_FP1), NA }},
+      {"sxtb", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"vpord", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"pshufd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"andpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpcmpub", { COST(3, 100, SKL_P5), NA, NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpmaxub", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vfnmsub231ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"psrlw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpternlogd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vfnmsub231pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"blendvps", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpmaxuw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"divpd", { COST(14, 400, SKL_P0), COST(13, 450, ZEN_FP1), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"ldurh", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {"vmulpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""},
+      {"vpmulld", { COST(10, 100, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"fcvtzs", { NA, NA, COST(3, 100, N1_V0) }},
+      {"fmin", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"psrld", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"tbl", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"psrad", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"orpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"cset", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"umulh", { NA, NA, COST(4, 200, N1_M) }},
+      {"addps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""},
+      {"vminss", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"orn", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vmovlpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vfmsub231sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"vpaddd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"mulpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""},
+      {"pmulld", { COST(10, 100, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"ptest", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"divps", { COST(11, 300, SKL_P0), COST(10, 350, ZEN_FP1), NA }},
+      {""}, {""}, {""},
+      {"psubusw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"smull", { NA, NA, COST(2, 100, N1_M) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""},
+      {"vsqrtpd", { COST(18, 600, SKL_P0), COST(20, 900, ZEN_FP1), NA }},
+      {""}, {""},
+      {"unpckhpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"subsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"mulss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"vfmsub231ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"vpslld", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"pmaxsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vfmadd231sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"bic", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"ubfx", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""},
+      {"pmovzxbd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"fnmsub", { NA, NA, COST(4, 50, N1_V) }},
+      {""}, {""},
+      {"pmovzxwq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"vpshufd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vfmadd231pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"ldurb", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""},
+      {"unpcklps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"sar", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {"pblendvb", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {"vfnmsub231ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""},
+      {"kmovb", { COST(2, 100, SKL_P0), NA, NA }},
+      {"vfmadd132ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"sub", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""},
+      {"vblendvps", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpaddb", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"ldrb", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {"vmovmskps", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""},
+      {"sxth", { NA, NA, COST(1, 33, N1_I) }},
+      {"pmovzxdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpslldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""},
+      {"bsr", { COST(3, 100, SKL_P1), COST(3, 300, ZEN_ALU), NA }},
+      {"vextracti128", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"paddd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"movz", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"vpsrlvq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpmaxsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpmovsxbq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pmaddwd", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"xor", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""},
+      {"movupd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpsrld", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"tzcnt", { COST(3, 100, SKL_P1), COST(1, 25, ZEN_ALU), NA }},
+      {"vblendvpd", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpermq", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"cvtss2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"udiv", { NA, NA, COST(12, 1200, N1_M) }},
+      {"vdivpd", { COST(14, 400, SKL_P0), COST(13, 450, ZEN_FP1), NA }},
+      {"adrp", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"pminsd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"movlpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"rev", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"psubq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vmovdqa64", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"movsxd", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {"movhpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""},
+      {"vfmadd132ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"mvn", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"vsubpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"movd", { COST(2, 100, SKL_P05), COST(3, 100, ZEN_FP), NA }},
+      {"pslldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vpaddsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"tbnz", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"cmn", { NA, NA, COST(1, 33, N1_I) }},
+      {"pmaxud", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"fmaxnm", { NA, NA, COST(2, 50, N1_V) }},
+      {"vfnmadd231sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""},
+      {"vfmsub231pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"vperm2i128", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {"umov", { NA, NA, COST(2, 50, N1_V) }},
+      {"vhaddpd", { COST(6, 200, SKL_P5), COST(6, 200, ZEN_FSHUF), NA }},
+      {"ld1", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""}, {""}, {""}, {""},
+      {"sqrtsd", { COST(18, 600, SKL_P0), COST(20, 900, ZEN_FP1), NA }},
+      {"cqo", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""},
+      {"vandpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"addsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""},
+      {"ret", { COST(1, 100, SKL_P6), COST(1, 50, ZEN_BR), COST(1, 100, N1_B) }},
+      {""}, {""},
+      {"vpermilpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vmovss", { COST(1, 33, SKL_P015), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"movdqa", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpunpckhdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"orr", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""},
+      {"madd", { NA, NA, COST(2, 100, N1_M) }},
+      {""}, {""},
+      {"vpsrad", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"movzx", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"cwtl", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"ands", { NA, NA, COST(1, 33, N1_I) }},
+      {"vshufps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vpcmpeqw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vpminuw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"movmskps", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"b.cond", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"pcmpgtb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vmovdqa", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"psllw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pmovsxwq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"vunpckhpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vmovups", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"fcmp", { NA, NA, COST(2, 100, N1_V0) }},
+      {""}, {""}, {""},
+      {"ucomisd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""},
+      {"vextractf128", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"vpalignr", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vfmadd132sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpandn", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vorps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpmovzxbw", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vmovapd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vmulsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""},
+      {"setcc", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {"pop", { COST(2, 50, SKL_LOAD), COST(1, 33, ZEN_LOAD), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vmaxps", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""},
+      {"sxtw", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"smaddl", { NA, NA, COST(2, 100, N1_M) }},
+      {""}, {""},
+      {"blsi", { COST(1, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {"vucomisd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"psrldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"sarx", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vsubss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"fcvt", { NA, NA, COST(3, 100, N1_V0) }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"fneg", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vmovmskpd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"cbnz", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""},
+      {"sqrtpd", { COST(18, 600, SKL_P0), COST(20, 900, ZEN_FP1), NA }},
+      {"idiv", { COST(42, 2400, SKL_P0), COST(14, 900, ZEN_DIV), NA }},
+      {""},
+      {"smulh", { NA, NA, COST(4, 200, N1_M) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"cvtsd2ss", { COST(5, 100, SKL_P01), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"kmovw", { COST(2, 100, SKL_P0), NA, NA }},
+      {""}, {""}, {""},
+      {"pminuw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"ext", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"divsd", { COST(14, 400, SKL_P0), COST(13, 450, ZEN_FP1), NA }},
+      {"st1", { NA, NA, COST(2, 100, N1_STORE) }},
+      {""},
+      {"vpshufb", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"vpandq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpcmpgtd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpmovzxwq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"push", { COST(3, 100, SKL_STORE), COST(1, 50, ZEN_STORE), NA }},
+      {""}, {""},
+      {"blendvpd", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {""},
+      {"vmaxss", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"movlps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"cmovcc", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"vmovhpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"vcvttsd2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""},
+      {"movk", { NA, NA, COST(1, 33, N1_I) }},
+      {"maxss", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {"lzcnt", { COST(3, 100, SKL_P1), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"paddsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"ldrh", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpsubq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vcomisd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"blendps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"punpckhqdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vsqrtsd", { COST(18, 600, SKL_P0), COST(20, 900, ZEN_FP1), NA }},
+      {"extr", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpmovzxbd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vdivps", { COST(11, 300, SKL_P0), COST(10, 350, ZEN_FP1), NA }},
+      {""}, {""},
+      {"pmovmskb", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""},
+      {"fsqrt", { NA, NA, COST(12, 900, N1_V0) }},
+      {""},
+      {"vsubps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"shlx", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"fmls", { NA, NA, COST(4, 50, N1_V) }},
+      {""},
+      {"kmovd", { COST(2, 100, SKL_P0), NA, NA }},
+      {"dec", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"fminnm", { NA, NA, COST(2, 50, N1_V) }},
+      {"sbfiz", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"paddusb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"subpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpmovzxdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"strb", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""}, {""}, {""}, {""},
+      {"movsb", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""},
+      {"vpermpd", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {"vpunpcklqdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"csinc", { NA, NA, COST(1, 33, N1_I) }},
+      {"vblendpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vpxord", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"zip1", { NA, NA, COST(2, 50, N1_V) }},
+      {"br", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""}, {""}, {""},
+      {"vpminsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"not", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"movaps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"psubsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"pmovzxbw", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"pmaxsd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vpaddusw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vptest", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"vpaddsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"xorps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"tst", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"pslld", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpbroadcastq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vcvtsd2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"trn1", { NA, NA, COST(2, 50, N1_V) }},
+      {"prefetchnta", { COST(0, 50, SKL_LOAD), COST(0, 33, ZEN_LOAD), NA }},
+      {""}, {""},
+      {"cvtsi2ss", { COST(5, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {"dup", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""},
+      {"fabs", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"vxorpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"addss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"vbroadcastsd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"vpcmpeqd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"msub", { NA, NA, COST(2, 100, N1_M) }},
+      {""},
+      {"vcvttps2dq", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {"mulps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"vpunpckhqdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"orps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"shufpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vpcmpgtb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vucomiss", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"vpmovsxbd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vpbroadcastw", { COST(3, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"blr", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""}, {""},
+      {"bzhi", { COST(1, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"mulsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"vpermd", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"vmovdqa32", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpsrlvd", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"eor", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"vpsubsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vshufpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"cvtss2sd", { COST(5, 100, SKL_P01), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpsubsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"cinc", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""},
+      {"imul", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_MUL), NA }},
+      {""}, {""}, {""},
+      {"neg", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"cmp", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"addpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""},
+      {"punpckhdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"bt", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"or", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"cbz", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"uxtw", { NA, NA, COST(1, 33, N1_I) }},
+      {"vpmaddwd", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"vsqrtss", { COST(12, 300, SKL_P0), COST(14, 500, ZEN_FP1), NA }},
+      {"cltd", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"maxsd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"cvttsd2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpmovsxwd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vmovsd", { COST(1, 33, SKL_P015), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"sqrtps", { COST(12, 300, SKL_P0), COST(14, 500, ZEN_FP1), NA }},
+      {""}, {""},
+      {"andnpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"ldrsb", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""}, {""},
+      {"andps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"psraw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vpmovsxwq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"maxps", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"sbfx", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"cvtps2dq", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {""},
+      {"pdep", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_MUL), NA }},
+      {"vcvtss2sd", { COST(5, 100, SKL_P01), COST(3, 100, ZEN_FP), NA }},
+      {"movapd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"pmullw", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"vmovdqu8", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"vporq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"fnmul", { NA, NA, COST(3, 50, N1_V) }},
+      {""},
+      {"vunpcklpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vaddss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"ld1r", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {"movsd", { COST(1, 33, SKL_P015), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"paddw", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vxorps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"uxtb", { NA, NA, COST(1, 33, N1_I) }},
+      {"cvttss2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""},
+      {"call", { COST(1, 100, SKL_P6), COST(1, 50, ZEN_BR), NA }},
+      {"movn", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"vpcmpw", { COST(3, 100, SKL_P5), NA, NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"vpmovsxdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"cbw", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"vpsubusb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vpmovmskb", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""},
+      {"fsub", { NA, NA, COST(2, 50, N1_V) }},
+      {"cqto", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"fdiv", { NA, NA, COST(10, 700, N1_V0) }},
+      {"rol", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"sdiv", { NA, NA, COST(12, 1200, N1_M) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpmovzxbq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"pcmpeqq", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"mneg", { NA, NA, COST(2, 100, N1_M) }},
+      {"movi", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""},
+      {"vpand", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpsubw", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"pmovzxwd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpsrldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pmovsxdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"strh", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""}, {""}, {""}, {""},
+      {"vpermps", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {"nop", { COST(0, 25, 0), COST(0, 17, 0), COST(0, 25, 0) }},
+      {"pcmpeqb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vmovhps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vinsertf128", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vpcmpb", { COST(3, 100, SKL_P5), NA, NA }},
+      {"subs", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""},
+      {"prefetcht0", { COST(0, 50, SKL_LOAD), COST(0, 33, ZEN_LOAD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vcomiss", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"blsr", { COST(1, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""},
+      {"movzb", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""},
+      {"vpblendvb", { COST(2, 100, SKL_P015), COST(1, 50, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpternlogq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"str", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""},
+      {"fccmp", { NA, NA, COST(2, 100, N1_V0) }},
+      {"vcvtdq2ps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {""},
+      {"umull", { NA, NA, COST(2, 100, N1_M) }},
+      {"prefetcht2", { COST(0, 50, SKL_LOAD), COST(0, 33, ZEN_LOAD), NA }},
+      {""}, {""},
+      {"asr", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"vfmadd213ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"pmaxsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"scvtf", { NA, NA, COST(3, 100, N1_V0) }},
+      {""},
+      {"sal", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"vperm2f128", { COST(3, 100, SKL_P5), COST(3, 100, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"fcsel", { NA, NA, COST(2, 50, N1_V) }},
+      {"paddusw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpmaxud", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"fcmpe", { NA, NA, COST(2, 100, N1_V0) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"movups", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"psllq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"subss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""},
+      {"vfmadd132pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""},
+      {"por", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"test", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {"vunpcklps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vpsubusw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"uzp2", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"movsw", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"vcvtsi2ss", { COST(5, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {"pand", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"tbz", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""},
+      {"sbb", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"stp", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""}, {""}, {""},
+      {"punpcklqdq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pminsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"div", { COST(42, 2400, SKL_P0), COST(14, 900, ZEN_DIV), NA }},
+      {"rorx", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {"movdqu", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpaddq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"lsl", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"comisd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"vandnps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vfnmadd231pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"punpckldq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"cvtsi2sd", { COST(5, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""},
+      {"vsqrtps", { COST(12, 300, SKL_P0), COST(14, 500, ZEN_FP1), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vdivsd", { COST(14, 400, SKL_P0), COST(13, 450, ZEN_FP1), NA }},
+      {""}, {""},
+      {"ldrsh", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""}, {""},
+      {"rev64", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""},
+      {"fcvtzu", { NA, NA, COST(3, 100, N1_V0) }},
+      {""}, {""},
+      {"ucomiss", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpcmpd", { COST(3, 100, SKL_P5), NA, NA }},
+      {""}, {""},
+      {"ins", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"vpminud", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"movmskpd", { COST(2, 100, SKL_P0), COST(3, 100, ZEN_FP), NA }},
+      {"vfmadd231ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vcvtss2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"leave", { COST(3, 50, SKL_P06), COST(3, 50, ZEN_ALU), NA }},
+      {"mov", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"vaddsd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {"pmovsxwd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""},
+      {"eon", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"movss", { COST(1, 33, SKL_P015), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"blendpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vmulss", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"pminsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"vpmullw", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"pmovsxbd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"b", { NA, NA, COST(1, 100, N1_B) }},
+      {""}, {""},
+      {"xchg", { COST(2, 100, SKL_ALU), COST(1, 50, ZEN_ALU), NA }},
+      {""},
+      {"vfmadd213pd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {"vminpd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"jmp", { COST(1, 100, SKL_P6), COST(1, 50, ZEN_BR), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""},
+      {"fmov", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"vpblendd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"psrlq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""},
+      {"stur", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""}, {""}, {""}, {""},
+      {"vblendps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"bfxil", { NA, NA, COST(1, 33, N1_I) }},
+      {"vmaxpd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"paddq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vpsllvq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pext", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_MUL), NA }},
+      {""}, {""},
+      {"vpsllq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"pminud", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"movabs", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"cneg", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""}, {""},
+      {"vpxorq", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"vcvtps2dq", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {""}, {""},
+      {"shl", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""},
+      {"vpor", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"pmaxuw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vpcmpq", { COST(3, 100, SKL_P5), NA, NA }},
+      {""},
+      {"vandps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"ldr", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {"sqrtss", { COST(12, 300, SKL_P0), COST(14, 500, ZEN_FP1), NA }},
+      {"vpcmpeqb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vdivss", { COST(11, 300, SKL_P0), COST(10, 350, ZEN_FP1), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""}, {""},
+      {"unpckhps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"minpd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"add", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {"shrd", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_ALU), NA }},
+      {"adc", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {"vunpckhps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""},
+      {"inc", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vmovaps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"ldp", { NA, NA, COST(4, 100, N1_LOAD) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"psubusb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"lea", { COST(1, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {"maxpd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {"vfmadd213ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"minps", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"vpaddusb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vorpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"adr", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"cvtsd2si", { COST(6, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""},
+      {"vpcmpuq", { COST(3, 100, SKL_P5), NA, NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"pcmpeqd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"fmul", { NA, NA, COST(3, 50, N1_V) }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"palignr", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""},
+      {"kmovq", { COST(2, 100, SKL_P0), NA, NA }},
+      {""}, {""},
+      {"vandnpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"vpmuludq", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {"fnmadd", { NA, NA, COST(4, 50, N1_V) }},
+      {""}, {""},
+      {"ccmn", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""},
+      {"vfnmadd231ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"vpxor", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"subps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""},
+      {"sturb", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""},
+      {"pminub", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""},
+      {"uzp1", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"zip2", { NA, NA, COST(2, 50, N1_V) }},
+      {""}, {""}, {""}, {""},
+      {"haddps", { COST(6, 200, SKL_P5), COST(6, 200, ZEN_FSHUF), NA }},
+      {""},
+      {"unpcklpd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"vpmaxsd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"psubw", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"andn", { COST(1, 50, SKL_P15), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""},
+      {"pmaxub", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"psubsb", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"xorpd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"movzw", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""},
+      {"vmovdqu64", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"movsl", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {"paddsw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"pcmpgtd", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vpsrlq", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"uaddlv", { NA, NA, COST(4, 100, N1_V1) }},
+      {""}, {""}, {""},
+      {"movsx", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"vinserti128", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"ldrsw", { NA, NA, COST(4, 50, N1_LOAD) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"psubd", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"trn2", { NA, NA, COST(2, 50, N1_V) }},
+      {""},
+      {"vpsubb", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpbroadcastb", { COST(3, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vcvtsi2sd", { COST(5, 100, SKL_P01), COST(4, 100, ZEN_FP), NA }},
+      {""},
+      {"bl", { NA, NA, COST(1, 100, N1_B) }},
+      {"psubb", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"and", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), COST(1, 33, N1_I) }},
+      {""},
+      {"shld", { COST(3, 100, SKL_P1), COST(3, 100, ZEN_ALU), NA }},
+      {"popcnt", { COST(3, 100, SKL_P1), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {"mul", { COST(3, 100, SKL_P1), COST(3, 200, ZEN_MUL), COST(2, 100, N1_M) }},
+      {"movhps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vaddpd", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FADD), NA }},
+      {""},
+      {"vpsllvd", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"vbroadcastss", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vzeroupper", { COST(0, 100, 0), COST(0, 17, 0), NA }},
+      {""}, {""},
+      {"minsd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {""},
+      {"ucvtf", { NA, NA, COST(3, 100, N1_V0) }},
+      {""}, {""}, {""}, {""},
+      {"andnps", { COST(1, 33, SKL_P015), COST(1, 25, ZEN_FP), NA }},
+      {"adds", { NA, NA, COST(1, 33, N1_I) }},
+      {"prefetcht1", { COST(0, 50, SKL_LOAD), COST(0, 33, ZEN_LOAD), NA }},
+      {"ccmp", { NA, NA, COST(1, 33, N1_I) }},
+      {"vmovd", { COST(2, 100, SKL_P05), COST(3, 100, ZEN_FP), NA }},
+      {""}, {""}, {""},
+      {"cdqe", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"pshufb", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"shufps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""},
+      {"fmsub", { NA, NA, COST(4, 50, N1_V) }},
+      {"lsr", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"pmovzxbq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {"vpermilps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""},
+      {"vpbroadcastd", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""},
+      {"pmuludq", { COST(5, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"pcmpgtw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""},
+      {"vpsllw", { COST(1, 50, SKL_P01), COST(1, 50, ZEN_FSHUF), NA }},
+      {"csel", { NA, NA, COST(1, 33, N1_I) }},
+      {""}, {""}, {""},
+      {"vhaddps", { COST(6, 200, SKL_P5), COST(6, 200, ZEN_FSHUF), NA }},
+      {""},
+      {"bsf", { COST(3, 100, SKL_P1), COST(3, 300, ZEN_ALU), NA }},
+      {""}, {""}, {""}, {""},
+      {"vfmadd213sd", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""},
+      {"bfi", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"shr", { COST(1, 50, SKL_P06), COST(1, 25, ZEN_ALU), NA }},
+      {""}, {""},
+      {"pcmpeqw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {""}, {""}, {""}, {""},
+      {"vmovlps", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""},
+      {"vmaxsd", { COST(4, 50, SKL_P01), COST(1, 50, ZEN_FMA), NA }},
+      {"clz", { NA, NA, COST(1, 33, N1_I) }},
+      {"pmovsxbq", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""}, {""}, {""}, {""},
+      {"sturh", { NA, NA, COST(1, 100, N1_STORE) }},
+      {""}, {""}, {""}, {""}, {""}, {""}, {""}, {""},
+      {""},
+      {"cltq", { COST(1, 25, SKL_ALU), COST(1, 25, ZEN_ALU), NA }},
+      {""},
+      {"rbit", { NA, NA, COST(1, 33, N1_I) }},
+      {""},
+      {"vpcmpgtw", { COST(1, 50, SKL_P01), COST(1, 25, ZEN_FP), NA }},
+      {"vmulps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"fmla", { NA, NA, COST(4, 50, N1_V) }},
+      {""}, {""}, {""}, {""},
+      {"vpcmpuw", { COST(3, 100, SKL_P5), NA, NA }},
+      {"cvtdq2ps", { COST(4, 50, SKL_P01), COST(3, 50, ZEN_FP), NA }},
+      {"vpmovsxbw", { COST(1, 100, SKL_P5), COST(1, 50, ZEN_FSHUF), NA }},
+      {""}, {""}, {""}, {""},
+      {"vfmadd231ps", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""},
+      {"vfmsub231ss", { COST(4, 50, SKL_P01), COST(4, 50, ZEN_FMA), NA }},
+      {""}, {""}, {""}, {""}
+    };
+
+  if (len <= INSTR_COST_MAX_WORD_LENGTH && len >= INSTR_COST_MIN_WORD_LENGTH)
+    {
+      unsigned int key = instr_cost_hash (str, len);
+
+      if (len == lengthtable[key])
+        {
+          const char *s = wordlist[key].name;
+
+          if (*str == *s && !memcmp (str + 1, s + 1, len - 1))
+            return &wordlist[key];
+        }
+    }
+  return 0;
+}
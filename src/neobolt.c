@@ -9,6 +9,20 @@
 # include <time.h>
 #endif
 
+#if defined(NEOBOLT_PERF)
+# if !defined(__linux__)
+#  error "NEOBOLT_PERF requires perf_event_open, which is Linux only"
+# endif
+# if !defined(NEOBOLT_STATS)
+#  define NEOBOLT_STATS
+# endif
+# include <errno.h>
+# include <linux/perf_event.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
 #if defined(__clang__) || defined(__GNUC__)
 # pragma GCC diagnostic push
 # if defined(__clang__)
@@ -155,6 +169,34 @@ static u32 fnv1a(
   return hash;
 }
 
+/// 64-bit hash of larger buffers, 8 bytes at a time. Not for untrusted keys.
+/// Chain multiple buffers by passing the previous result as seed.
+INTERFACE u64 hash64(
+    const byte* data,
+    usize len,
+    u64 seed)
+{
+  const u64 k = 0x9E3779B97F4A7C15;
+  u64 hash = ((seed + k) ^ len) * k;
+  usize i = 0;
+  for (; i + 8 <= len; i += 8) {
+    u64 w;
+    memcpy(&w, &data[i], 8);
+    hash = (hash ^ w) * k;
+    hash ^= hash >> 29;
+  }
+  u64 tail = 0;
+  memcpy(&tail, &data[i], len - i);
+  hash = (hash ^ tail) * k;
+  // murmur3 finalizer
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCD;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB93FE1A85EC5;
+  hash ^= hash >> 33;
+  return hash;
+}
+
 
 enum LineType {
   kLineUnknown = 0,
@@ -170,6 +212,9 @@ enum LineType {
 
 #define LINE_FLAG_SHOW 0x1
 #define LINE_FLAG_LABEL_VISITED 0x2
+#define LINE_FLAG_STACK_LOAD 0x4 ///< Reads a stack slot, set by neobolt_frames
+#define LINE_FLAG_STACK_STORE 0x8 ///< Writes a stack slot, set by neobolt_frames
+#define LINE_FLAG_MEMORY 0x10 ///< Instruction with a memory operand
 
 // TODO: there is some stuff there that swaps between 0-based and 1-based indexing.
 // would be nice if it could be simplified, either by using -1 for nulls or by putting
@@ -250,14 +295,171 @@ typedef struct {
   u32 col;
 } Location;
 
+/// Instruction classes of the per-location mix. An instruction is in the first class
+/// it fits, in this order: calls, branches, then the widest vector register it uses,
+/// then memory operands
+enum InstrClass {
+  kInstrScalar = 0,
+  kInstrXmm, ///< SSE or AVX, 128-bit
+  kInstrYmm, ///< AVX, 256-bit
+  kInstrZmm, ///< AVX-512
+  kInstrVector, ///< NEON or SVE
+  kInstrMemory, ///< Scalar with a memory operand
+  kInstrBranch,
+  kInstrCall,
+
+  kInstrClassCount,
+};
+
+typedef struct {
+  u16 count[kInstrClassCount]; ///< Saturates at UINT16_MAX
+} InstrMix;
+
 typedef struct {
   Location current; ///< Current location
   u32 current_id; ///< Current file ID
 
   Location* data;
+  InstrMix* mix; ///< Instructions of each location, by class
+  u32 size; ///< `data` and `mix` element count
+  u32 cap; ///< `data` and `mix` allocation size
+} Locations;
+
+#define BLOCK_FLAG_ENTRY 0x1 ///< Starts a section or function, or has no predecessors
+#define BLOCK_FLAG_HEADER 0x2 ///< Natural loop header
+#define BLOCK_FLAG_BACK_FALL 0x4 ///< Fallthrough edge is a loop back-edge
+#define BLOCK_FLAG_BACK_JUMP 0x8 ///< Jump edge is a loop back-edge
+
+/// Basic block. A run of instructions entered only through the first one, and left
+/// only through the last one.
+typedef struct {
+  u32 first; ///< 0-based line index. The first label of the block, if it has one
+  u32 last; ///< 0-based line index of the last instruction
+  u32 succ[2]; ///< 1-based fallthrough and jump target blocks. Zero when absent
+  u32 idom; ///< 1-based immediate dominator. Zero for entries and unreachable blocks
+  u32 loop; ///< 1-based header of the innermost loop containing the block, or zero
+  u32 depth; ///< Loop nesting depth
+  u32 order; ///< 1-based postorder number, zero when the block is unreachable
+  u32 cycles; ///< Estimated cycles per execution, in hundredths. Set by neobolt_costs
+  u32 loop_cycles; ///< Loop headers: estimated cycles per iteration, inner loops excluded
+  u32 unknown; ///< Instructions missing from the cost table
+  u8 flags;
+} Block;
+
+typedef struct {
+  Block* data;
   u32 size; ///< `data` element count
   u32 cap; ///< `data` allocation size
-} Locations;
+  u32* scratch; ///< Temporary arrays of neobolt_cfg
+} Blocks;
+
+/// Stack usage of a function, from its label to the next one
+typedef struct {
+  u32 label; ///< 0-based line of the function label
+  u32 last; ///< 0-based line of the last instruction
+  u32 frame; ///< Stack frame size in bytes, return address and pushes included
+  u32 spills; ///< Instructions storing to the stack
+  u32 reloads; ///< Instructions loading from the stack
+  u32 loop_spills; ///< Spills and reloads in loops, when neobolt_cfg ran before
+} Function;
+
+typedef struct {
+  Function* data;
+  u32 size; ///< `data` element count
+  u32 cap; ///< `data` allocation size
+} Functions;
+
+enum Uarch {
+  kUarchSkylake = 0,
+  kUarchZen3,
+  kUarchNeoverseN1,
+
+  kUarchCount,
+};
+
+// issue ports of each microarchitecture, as bit masks
+#define SKL_P0 0x01
+#define SKL_P1 0x02
+#define SKL_P2 0x04
+#define SKL_P3 0x08
+#define SKL_P4 0x10
+#define SKL_P5 0x20
+#define SKL_P6 0x40
+#define SKL_P01 (SKL_P0 | SKL_P1)
+#define SKL_P05 (SKL_P0 | SKL_P5)
+#define SKL_P06 (SKL_P0 | SKL_P6)
+#define SKL_P15 (SKL_P1 | SKL_P5)
+#define SKL_P015 (SKL_P0 | SKL_P1 | SKL_P5)
+#define SKL_ALU (SKL_P0 | SKL_P1 | SKL_P5 | SKL_P6)
+#define SKL_LOAD (SKL_P2 | SKL_P3)
+#define SKL_STORE SKL_P4
+
+#define ZEN_ALU 0x00F // ALU0-3
+#define ZEN_BR 0x009 // ALU0, ALU3
+#define ZEN_MUL 0x002 // ALU1
+#define ZEN_DIV 0x004 // ALU2
+#define ZEN_LOAD 0x070 // AGU0-2
+#define ZEN_STORE 0x030 // AGU0-1
+#define ZEN_FP 0xF00 // FP0-3
+#define ZEN_FMA 0x300 // FP0, FP1
+#define ZEN_FP1 0x200
+#define ZEN_FSHUF 0x600 // FP1, FP2
+#define ZEN_FADD 0xC00 // FP2, FP3
+
+#define N1_B 0x001
+#define N1_I 0x00E // S0, S1, M
+#define N1_M 0x008
+#define N1_LOAD 0x030 // L0, L1
+#define N1_STORE 0x040 // D
+#define N1_V0 0x080
+#define N1_V1 0x100
+#define N1_V 0x180 // V0, V1
+
+/// Cost of an instruction on one microarchitecture. All zero when unknown
+typedef struct {
+  u8 lat; ///< Latency, in cycles
+  u16 rthr; ///< Reciprocal throughput, in hundredths of a cycle
+  u16 ports; ///< Ports it issues to, zero when it doesn't need one
+} InstrUarchCost;
+
+struct InstrCost {
+  const char* name;
+  InstrUarchCost uarch[kUarchCount];
+};
+
+#define COST(lat, rthr, ports) { (lat), (rthr), (ports) }
+#define NA { 0, 0, 0 }
+#if defined(__clang__) || defined(__GNUC__)
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+# if defined(__clang__)
+#  pragma GCC diagnostic ignored "-Wshorten-64-to-32"
+# elif defined(__GNUC__)
+#  pragma GCC diagnostic ignored "-Wconversion"
+# endif
+#endif
+#include "instr_costs.h"
+#if defined(__clang__) || defined(__GNUC__)
+# pragma GCC diagnostic pop
+#endif
+#undef NA
+#undef COST
+
+typedef struct {
+  const char* name;
+  u16 width; ///< Instructions issued per cycle
+  bool x86; ///< Memory operands add load and store uops
+  u16 load; ///< Load uop ports
+  u16 load_rthr;
+  u16 store; ///< Store uop ports
+  u16 store_rthr;
+} UarchInfo;
+
+static const UarchInfo uarch_info[kUarchCount] = {
+  [kUarchSkylake] = { "skylake", 4, true, SKL_LOAD, 50, SKL_STORE, 100 },
+  [kUarchZen3] = { "zen3", 6, true, ZEN_LOAD, 33, ZEN_STORE, 50 },
+  [kUarchNeoverseN1] = { "neoverse-n1", 4, false, 0, 0, 0, 0 },
+};
 
 // instead of parsing .file and .loc directives eagerly, instructions could point at the
 // associated .loc line (needs a file number to line number mapping), and .loc point at
@@ -271,6 +473,32 @@ typedef struct {
 } Exception;
 
 
+#if defined(NEOBOLT_PERF)
+enum PerfCounter {
+  kPerfCycles = 0,
+  kPerfInstructions,
+  kPerfBranchMisses,
+  kPerfL1dMisses,
+  kPerfLLCMisses,
+
+  kPerfCounterCount,
+};
+
+/// Hardware performance counters, see perf_event_open(2)
+typedef struct {
+  bool open;
+  bool hash; ///< Also attribute counters to label hash operations
+  int error; ///< errno of the first counter that failed to open
+  int fd[kPerfCounterCount]; ///< -1 when the counter is not available
+  struct perf_event_mmap_page* page[kPerfCounterCount]; ///< For rdpmc, can be NULL
+
+  u64 pass[3][kPerfCounterCount]; ///< Counter deltas per pass
+  u64 hash_ops; ///< Number of instrumented label hash operations
+  u64 hash_counts[kPerfCounterCount]; ///< Counter deltas inside label hash operations
+} Perf;
+#endif
+
+
 typedef struct State {
   String input;
   Lines lines;
@@ -279,8 +507,13 @@ typedef struct State {
   Files files;
   Locations loc;
   Arena arena;
+  Blocks blocks; ///< Only filled by neobolt_cfg
+  Functions functions; ///< Only filled by neobolt_frames
   Exception exception;
 
+  bool trace; ///< Record pass timestamps even without NEOBOLT_STATS
+  u64 pass_ts[4]; ///< Timestamps before pass 1 and after every pass, in microseconds
+
 #if defined(NEOBOLT_STATS)
   u64 time_pass1;
   u64 time_pass2;
@@ -288,6 +521,9 @@ typedef struct State {
   u64 hash_lookups;
   u64 hash_misses;
 #endif
+#if defined(NEOBOLT_PERF)
+  Perf perf;
+#endif
 } State;
 
 
@@ -305,9 +541,16 @@ typedef struct State {
 #ifndef NEOBOLT_FILES_INITIAL_CAP
 # define NEOBOLT_FILES_INITIAL_CAP 64
 #endif
+#ifndef NEOBOLT_FUNCTIONS_INITIAL_CAP
+# define NEOBOLT_FUNCTIONS_INITIAL_CAP 64
+#endif
+
 #ifndef NEOBOLT_LOCATIONS_INITIAL_CAP
 # define NEOBOLT_LOCATIONS_INITIAL_CAP 256
 #endif
+#ifndef NEOBOLT_BLOCKS_INITIAL_CAP
+# define NEOBOLT_BLOCKS_INITIAL_CAP 256
+#endif
 
 
 INTERFACE bool neobolt_init(
@@ -316,8 +559,20 @@ INTERFACE bool neobolt_init(
     usize size);
 INTERFACE bool neobolt_parse(
     State* const restrict s);
+INTERFACE bool neobolt_cfg(
+    State* const restrict s);
+INTERFACE void neobolt_costs(
+    State* const restrict s,
+    enum Uarch uarch);
+INTERFACE bool neobolt_frames(
+    State* const restrict s);
 INTERFACE void neobolt_destroy(
     State* const restrict s);
+#if defined(NEOBOLT_PERF)
+INTERFACE bool neobolt_perf_open(
+    State* const restrict s,
+    bool hash);
+#endif
 
 
 INTERFACE bool neobolt_init(
@@ -343,7 +598,23 @@ INTERFACE void neobolt_destroy(
   FREE(s->files.ids);
   FREE(s->files.paths);
   FREE(s->loc.data);
+  FREE(s->loc.mix);
   FREE(s->arena.data);
+  FREE(s->blocks.data);
+  FREE(s->blocks.scratch);
+  FREE(s->functions.data);
+
+#if defined(NEOBOLT_PERF)
+  if (s->perf.open) {
+    for (int i = 0; i < kPerfCounterCount; ++i) {
+      if (s->perf.page[i] != NULL)
+        munmap(s->perf.page[i], cast(usize, sysconf(_SC_PAGESIZE)));
+      if (s->perf.fd[i] >= 0)
+        close(s->perf.fd[i]);
+    }
+    s->perf.open = false;
+  }
+#endif
 }
 
 NORETURN NOINLINE static void fail(
@@ -360,6 +631,147 @@ NORETURN NOINLINE static void fail(
 #define CHECK(cond) (LIKELY(cond) ? cast(void, 0) : FATAL("assertion failed: " #cond))
 
 
+#if defined(NEOBOLT_PERF)
+static int perf_event_open(
+    u32 type,
+    u64 config)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = 1; // works with perf_event_paranoid=2
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return cast(int, syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+/// Open hardware counters for the calling thread. Counters that are not supported by
+/// the CPU or the kernel are skipped. Returns false if none of them could be opened.
+INTERFACE bool neobolt_perf_open(
+    State* const restrict s,
+    bool hash)
+{
+  Perf* const self = &s->perf;
+
+  static const struct { u32 type; u64 config; } events[kPerfCounterCount] = {
+    [kPerfCycles] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [kPerfInstructions] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [kPerfBranchMisses] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [kPerfL1dMisses] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                           | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                           | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    [kPerfLLCMisses] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  };
+
+  bool any = false;
+  self->open = true;
+  self->hash = hash;
+  self->error = 0;
+  usize page_size = cast(usize, sysconf(_SC_PAGESIZE));
+  for (int i = 0; i < kPerfCounterCount; ++i) {
+    self->page[i] = NULL;
+    self->fd[i] = perf_event_open(events[i].type, events[i].config);
+    if (self->fd[i] < 0) {
+      if (self->error == 0)
+        self->error = errno;
+      continue;
+    }
+    any = true;
+    // the first page exposes the counter index for reading it with rdpmc
+    void* page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, self->fd[i], 0);
+    if (page != MAP_FAILED)
+      self->page[i] = page;
+  }
+  return any;
+}
+
+/// Read counter with read(2), scaled when the counter was multiplexed
+static u64 perf_read_one(
+    int fd)
+{
+  u64 buf[3] = {0}; // value, time_enabled, time_running
+  if (fd < 0 || read(fd, buf, sizeof(buf)) != cast(isize, sizeof(buf)))
+    return 0;
+  if (buf[2] != 0 && buf[2] < buf[1])
+    return cast(u64, cast(double, buf[0]) * cast(double, buf[1]) / cast(double, buf[2]));
+  return buf[0];
+}
+
+static void perf_read(
+    State* const restrict s,
+    u64 res[kPerfCounterCount])
+{
+  for (int i = 0; i < kPerfCounterCount; ++i)
+    res[i] = perf_read_one(s->perf.fd[i]);
+}
+
+/// Cheap counter read from userspace with rdpmc. Falls back to read(2), which is
+/// expensive compared to a single hash lookup, so the hash numbers get noisy.
+static u64 perf_read_fast_one(
+    int fd,
+    volatile struct perf_event_mmap_page* pc)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  if (pc != NULL) {
+    for (;;) {
+      u32 seq = pc->lock;
+      __asm__ volatile("" ::: "memory");
+      u32 idx = pc->index;
+      u64 count = cast(u64, pc->offset);
+      if (!pc->cap_user_rdpmc || idx == 0)
+        break; // not scheduled or rdpmc not allowed
+      u32 lo, hi;
+      __asm__ volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx - 1));
+      u64 pmc = cast(u64, lo) | (cast(u64, hi) << 32);
+      u32 width = pc->pmc_width;
+      pmc <<= 64 - width;
+      count += cast(u64, cast(i64, pmc) >> (64 - width));
+      __asm__ volatile("" ::: "memory");
+      if (pc->lock == seq)
+        return count;
+    }
+  }
+#else
+  (void)pc;
+#endif
+  u64 buf[3] = {0};
+  if (fd < 0 || read(fd, buf, sizeof(buf)) != cast(isize, sizeof(buf)))
+    return 0;
+  return buf[0];
+}
+
+static void perf_read_fast(
+    State* const restrict s,
+    u64 res[kPerfCounterCount])
+{
+  for (int i = 0; i < kPerfCounterCount; ++i)
+    res[i] = perf_read_fast_one(s->perf.fd[i], s->perf.page[i]);
+}
+
+static void perf_hash_add(
+    State* const restrict s,
+    const u64 start[kPerfCounterCount])
+{
+  u64 end[kPerfCounterCount];
+  perf_read_fast(s, end);
+  for (int i = 0; i < kPerfCounterCount; ++i)
+    s->perf.hash_counts[i] += end[i] - start[i];
+  s->perf.hash_ops += 1;
+}
+
+# define PERF_HASH_BEGIN() \
+  u64 perf_hash_start_[kPerfCounterCount]; \
+  if (s->perf.hash) perf_read_fast(s, perf_hash_start_)
+# define PERF_HASH_END() \
+  if (s->perf.hash) perf_hash_add(s, perf_hash_start_)
+#else
+# define PERF_HASH_BEGIN() cast(void, 0)
+# define PERF_HASH_END() cast(void, 0)
+#endif
+
+
 static Line* line_push(
     State* const restrict s)
 {
@@ -425,6 +837,8 @@ static void label_hash_set(
 
   CHECK(line != 0); // line numbers are 1-based here
 
+  PERF_HASH_BEGIN();
+
   if UNLIKELY (self->size * 100 >= self->cap * 65) { // % max load factor
     u32 ncap = self->cap << 1;
     CHECK(ncap != 0); // overflow
@@ -452,11 +866,13 @@ static void label_hash_set(
 
   const u32 hash = fnv1a(name);
   LabelHashSlot* slot = label_hash_search(s, name, hash);
-  if (slot->line != 0)
-    return; // already in the set
-  slot->hash = hash;
-  slot->line = line;
-  self->size += 1;
+  if (slot->line == 0) { // not in the set yet
+    slot->hash = hash;
+    slot->line = line;
+    self->size += 1;
+  }
+
+  PERF_HASH_END();
 }
 
 /// Returns 1-based line number, zero if label was not found
@@ -464,8 +880,10 @@ static u32 label_hash_get(
     State* const restrict s,
     String name)
 {
+  PERF_HASH_BEGIN();
   const u32 hash = fnv1a(name);
   LabelHashSlot* slot = label_hash_search(s, name, hash);
+  PERF_HASH_END();
   return slot->line;
 }
 
@@ -615,9 +1033,13 @@ static u32 loc_push(
     void* ndata = realloc(self->data, cast(usize, ncap) * sizeof(*self->data));
     CHECK(ndata != NULL);
     self->data = ndata;
+    void* nmix = realloc(self->mix, cast(usize, ncap) * sizeof(*self->mix));
+    CHECK(nmix != NULL);
+    self->mix = nmix;
     self->cap = ncap;
   }
 
+  memset(&self->mix[self->size], 0, sizeof(*self->mix));
   self->data[self->size++] = *curr;
   return self->size;
 }
@@ -963,19 +1385,52 @@ static void directive_type(
 }
 
 
-static void parse_label_references(
+#define OPERAND_MEMORY 0x01 ///< `(` or `[`
+#define OPERAND_XMM 0x02
+#define OPERAND_YMM 0x04
+#define OPERAND_ZMM 0x08
+#define OPERAND_VECTOR 0x10 ///< aarch64 v0.4s, z1.d or q2
+
+/// Register class of an operand symbol, OPERAND_* flags
+static inline u32 operand_register(
+    String sym)
+{
+  const byte* p = sym.ptr;
+  if (sym.len >= 4 && p[1] == 'm' && p[2] == 'm' && is_digit(p[3])) {
+    // %xmm0, ymm1, zmm31
+    if (p[0] == 'x')
+      return OPERAND_XMM;
+    if (p[0] == 'y')
+      return OPERAND_YMM;
+    if (p[0] == 'z')
+      return OPERAND_ZMM;
+  } else if (sym.len >= 2 && (p[0] == 'v' || p[0] == 'z' || p[0] == 'q') && is_digit(p[1])) {
+    usize i = 2;
+    while (i < sym.len && is_digit(p[i]))
+      ++i;
+    if ((i < sym.len && p[i] == '.') || (i == sym.len && p[0] == 'q'))
+      return OPERAND_VECTOR;
+  }
+  return 0;
+}
+
+/// Checks symbols of operands for labels. Returns OPERAND_* flags of the registers
+/// and memory operands seen on the way.
+static u32 parse_label_references(
     State* const restrict s,
     const byte* p)
 {
+  u32 operands = 0;
   while (*p != EOL) {
     // bail on comments
     if (p[0] == '#')
-      return;
+      return operands;
     if (p[0] == '/' && p[1] == '/')
-      return;
+      return operands;
 
     String symname;
     if (parse_symname(&p, &symname)) {
+      operands |= operand_register(symname);
       check_potential_label(s, symname);
       continue;
     }
@@ -987,10 +1442,141 @@ static void parse_label_references(
     // failure because of EOL, so it has to be checked again.
     // TODO: return a more meaningful status from parse_* functions
     if (*p == EOL)
-      return;
+      return operands;
 
+    if (*p == '(' || *p == '[')
+      operands |= OPERAND_MEMORY;
     ++p;
   }
+  return operands;
+}
+
+enum BranchKind {
+  kBranchNone = 0, ///< Not a branch. Calls return, so they aren't either
+  kBranchCond, ///< Conditional, falls through when not taken
+  kBranchJump, ///< Unconditional
+  kBranchReturn, ///< Return or trap, no successors
+};
+
+/// Branch kind of an instruction. Knows x86, AArch64, ARM, RISC-V, MIPS and PowerPC
+/// mnemonics, in the forms compilers emit.
+static enum BranchKind branch_kind(
+    String name,
+    const byte* args)
+{
+  // condition suffixes of `b<cond>`
+  static const char* const conds[] = {
+    // arm
+    "eq", "ne", "cs", "hs", "cc", "lo", "mi", "pl", "vs", "vc", "hi", "ls",
+    "ge", "lt", "gt", "le",
+    // risc-v, mips
+    "ltu", "geu", "gtu", "leu", "eqz", "nez", "lez", "gez", "ltz", "gtz",
+  };
+
+  if (name.len == 0)
+    return kBranchNone;
+
+  if (name.ptr[0] == 'j') {
+    // x86 jmp and jcc, risc-v and mips j and jr. jal and jalr are calls
+    if (STRTEST(name, "j") || STRTEST(name, "jr")
+        || (name.len >= 3 && memcmp(name.ptr, "jmp", 3) == 0))
+      return kBranchJump;
+    if (STRTEST(name, "jal") || STRTEST(name, "jalr"))
+      return kBranchNone;
+    return kBranchCond;
+  }
+
+  if (name.ptr[0] == 'b') {
+    if (STRTEST(name, "b") || STRTEST(name, "br") || STRTEST(name, "bx")
+        || STRTEST(name, "bctr"))
+      return kBranchJump;
+    if (STRTEST(name, "blr")) {
+      // powerpc return, or aarch64 indirect call
+      parse_spaces(&args);
+      return *args == EOL || *args == '#' ? kBranchReturn : kBranchNone;
+    }
+    // aarch64 b.cond and bc.cond, powerpc decrement and branch
+    if (name.len > 2 && name.ptr[1] == '.')
+      return kBranchCond;
+    if (name.len > 3 && memcmp(name.ptr, "bc.", 3) == 0)
+      return kBranchCond;
+    if (STRTEST(name, "bdnz") || STRTEST(name, "bdz"))
+      return kBranchCond;
+    for (usize i = 0; i < sizeof(conds) / sizeof(conds[0]); ++i)
+      if (name.len - 1 == strlen(conds[i]) && memcmp(name.ptr + 1, conds[i], name.len - 1) == 0)
+        return kBranchCond;
+    return kBranchNone;
+  }
+
+  if (STRTEST(name, "cbz") || STRTEST(name, "cbnz")
+      || STRTEST(name, "tbz") || STRTEST(name, "tbnz")
+      || STRTEST(name, "loop") || STRTEST(name, "loope") || STRTEST(name, "loopne")
+      || STRTEST(name, "loopz") || STRTEST(name, "loopnz"))
+    return kBranchCond;
+
+  if (STRTEST(name, "ret") || STRTEST(name, "retq") || STRTEST(name, "retl")
+      || STRTEST(name, "ud2") || STRTEST(name, "hlt") || STRTEST(name, "udf"))
+    return kBranchReturn;
+
+  return kBranchNone;
+}
+
+/// Instruction name without prefixes like `rep ret` and `notrack jmp *%rax`, and a
+/// pointer to its operands
+static String instruction_name(
+    State* const restrict s,
+    const Line* line,
+    const byte** args)
+{
+  String name = STR(s->input.ptr, line->name);
+  *args = line_args_ptr(s, line);
+  if (STRTEST(name, "rep") || STRTEST(name, "repz")
+      || STRTEST(name, "notrack") || STRTEST(name, "bnd") || STRTEST(name, "lock")) {
+    parse_spaces(args);
+    parse_symname(args, &name);
+  }
+  return name;
+}
+
+/// Class of an instruction for the per-location mix, see enum InstrClass
+static enum InstrClass instr_class(
+    String name,
+    const byte* args,
+    u32 operands)
+{
+  if ((name.len >= 4 && memcmp(name.ptr, "call", 4) == 0)
+      || STRTEST(name, "bl") || STRTEST(name, "blx")
+      || STRTEST(name, "jal") || STRTEST(name, "jalr"))
+    return kInstrCall;
+  enum BranchKind kind = branch_kind(name, args);
+  if (kind == kBranchNone && STRTEST(name, "blr"))
+    return kInstrCall;
+  if (kind != kBranchNone)
+    return kInstrBranch;
+
+  if (operands & OPERAND_ZMM)
+    return kInstrZmm;
+  if (operands & OPERAND_YMM)
+    return kInstrYmm;
+  if (operands & OPERAND_XMM)
+    return kInstrXmm;
+  if (operands & OPERAND_VECTOR)
+    return kInstrVector;
+  if ((operands & OPERAND_MEMORY)
+      && !(name.len >= 3 && memcmp(name.ptr, "lea", 3) == 0)
+      && !(name.len >= 3 && memcmp(name.ptr, "nop", 3) == 0))
+    return kInstrMemory;
+  return kInstrScalar;
+}
+
+/// Directives after which code is unrelated to the code before them
+static inline bool is_section_end(
+    String name)
+{
+  return STRTEST(name, "data")
+      || STRTEST(name, "text")
+      || STRTEST(name, "section")
+      || STRTEST(name, "cfi_endproc");
 }
 
 /// Second pass.
@@ -1003,9 +1589,18 @@ static void pass_2(
 
     if (line->type == kLineInstruction) {
       // search for labels referenced in the instruction
-      parse_label_references(s, line_args_ptr(s, line));
+      u32 operands = parse_label_references(s, line_args_ptr(s, line));
+      if (operands & OPERAND_MEMORY)
+        line->flags |= LINE_FLAG_MEMORY;
       // set source location
       line->loc = loc_push(s);
+      if (line->loc != 0) {
+        const byte* args;
+        String name = instruction_name(s, line, &args);
+        u16* count = &s->loc.mix[line->loc - 1].count[instr_class(name, args, operands)];
+        if (*count != UINT16_MAX)
+          *count += 1;
+      }
     } else if (line->type == kLineDirective) {
       // https://sourceware.org/binutils/docs/as/Pseudo-Ops.html
       String name = STR(s->input.ptr, line->name); // directive name
@@ -1019,10 +1614,7 @@ static void pass_2(
         directive_globl(s, line_args_ptr(s, line));
       } else if (STRTEST(name, "type")) {
         directive_type(s, line_args_ptr(s, line));
-      } else if (STRTEST(name, "data")
-              || STRTEST(name, "text")
-              || STRTEST(name, "section")
-              || STRTEST(name, "cfi_endproc")) {
+      } else if (is_section_end(name)) {
         // reset source location
         s->loc.current_id = cast(u32, -1);
         s->loc.current.file = 0;
@@ -1074,32 +1666,781 @@ INTERFACE bool neobolt_parse(
   s->label_queue.cap = NEOBOLT_LABEL_QUEUE_INITIAL_CAP;
 
 #if !defined(NEOBOLT_STATS)
+  if (s->trace)
+    s->pass_ts[0] = get_time();
   pass_1(s);
+  if (s->trace)
+    s->pass_ts[1] = get_time();
   pass_2(s);
+  if (s->trace)
+    s->pass_ts[2] = get_time();
   pass_3(s);
+  if (s->trace)
+    s->pass_ts[3] = get_time();
 #else
+# if defined(NEOBOLT_PERF)
+  u64 pc1[kPerfCounterCount] = {0};
+  u64 pc2[kPerfCounterCount] = {0};
+#  define PERF_PASS(n) \
+  if (s->perf.open) { \
+    perf_read(s, pc2); \
+    for (int i = 0; i < kPerfCounterCount; ++i) \
+      s->perf.pass[n][i] = pc2[i] - pc1[i]; \
+    memcpy(pc1, pc2, sizeof(pc1)); \
+  }
+  if (s->perf.open)
+    perf_read(s, pc1);
+# else
+#  define PERF_PASS(n) cast(void, 0)
+# endif
+
   u64 ts1, ts2;
   ts1 = get_time();
+  s->pass_ts[0] = ts1;
 
   pass_1(s);
 
+  PERF_PASS(0);
   ts2 = get_time();
   s->time_pass1 = ts2 - ts1;
+  s->pass_ts[1] = ts2;
   ts1 = ts2;
 
   pass_2(s);
 
+  PERF_PASS(1);
   ts2 = get_time();
   s->time_pass2 = ts2 - ts1;
+  s->pass_ts[2] = ts2;
   ts1 = ts2;
 
   pass_3(s);
 
+  PERF_PASS(2);
   ts2 = get_time();
   s->time_pass3 = ts2 - ts1;
+  s->pass_ts[3] = ts2;
+# undef PERF_PASS
 #endif
 
   return true;
 }
 
+
+/// Labels that can start a function. Compiler generated ones start with `.L` on ELF
+/// and `L` on Mach-O, like .L3, .LFB0, LBB0_2 and Ltmp1
+static inline bool is_function_label(
+    String name)
+{
+  if (name.len >= 2 && name.ptr[0] == '.' && name.ptr[1] == 'L')
+    return false;
+  if (name.len >= 2 && name.ptr[0] == 'L' && (is_upper(name.ptr[1]) || name.ptr[1] == '_'))
+    return false;
+  if (name.len >= 4 && memcmp(name.ptr, "Ltmp", 4) == 0)
+    return false;
+  return true;
+}
+
+/// 1-based line of the first label referenced by the operands, zero if there is none
+static u32 branch_target(
+    State* const restrict s,
+    const byte* p)
+{
+  while (*p != EOL) {
+    if (p[0] == '#')
+      return 0;
+    if (p[0] == '/' && p[1] == '/')
+      return 0;
+
+    String symname;
+    if (parse_symname(&p, &symname)) {
+      u32 label = label_hash_get(s, symname);
+      if (label != 0)
+        return label;
+      continue;
+    }
+    ++p;
+  }
+  return 0;
+}
+
+static u32 block_push(
+    State* const restrict s,
+    u32 first)
+{
+  Blocks* const self = &s->blocks;
+
+  if UNLIKELY (self->size == self->cap) {
+    u32 ncap = self->cap == 0 ? NEOBOLT_BLOCKS_INITIAL_CAP : self->cap << 1;
+    CHECK(ncap != 0); // overflow
+    void* ndata = realloc(self->data, cast(usize, ncap) * sizeof(*self->data));
+    CHECK(ndata != NULL);
+    self->data = ndata;
+    self->cap = ncap;
+  }
+
+  self->data[self->size++] = (Block){ .first = first, .last = first };
+  return self->size;
+}
+
+/// Returns 1-based block containing a 0-based line, zero if there is none
+static u32 block_search(
+    State* const restrict s,
+    u32 lnum)
+{
+  const Blocks* const self = &s->blocks;
+
+  u32 lo = 0;
+  u32 hi = self->size;
+  while (lo < hi) {
+    u32 mid = lo + (hi - lo) / 2;
+    if (self->data[mid].first <= lnum)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0 || self->data[lo - 1].last < lnum)
+    return 0;
+  return lo;
+}
+
+/// Whether a label starts a basic block: branch and jump table targets, functions,
+/// and local labels like `1:`, whose `1b`/`1f` references aren't resolved
+static inline bool is_block_label(
+    State* const restrict s,
+    const Line* line)
+{
+  return line->type == kLineLocalLabel
+      || (line->flags & LINE_FLAG_LABEL_VISITED)
+      || is_function_label(STR(s->input.ptr, line->name));
+}
+
+/// Split instructions into basic blocks, with fallthrough and jump edges
+static void cfg_blocks(
+    State* const restrict s)
+{
+  const byte* const text = s->input.ptr;
+  u32 start = UINT32_MAX; // first label of the next block
+  u32 curr = 0; // block being filled
+  u32 fall = 0; // block falling through into the next one
+  bool entry = true;
+
+  for (u32 lnum = 0; lnum < s->lines.size; ++lnum) {
+    const Line* line = &s->lines.data[lnum];
+
+    if (line->type == kLineLabel || line->type == kLineLocalLabel) {
+      // labels nothing references, like the .LVL/.LBB/.LBE ones of -g, don't end
+      // the block, so blocks are the same with and without debug info
+      if (curr != 0 && is_block_label(s, line)) {
+        fall = curr;
+        curr = 0;
+      }
+      if (curr == 0 && start == UINT32_MAX)
+        start = lnum;
+    } else if (line->type == kLineDirective) {
+      if (is_section_end(STR(text, line->name))) {
+        curr = 0;
+        fall = 0;
+        start = UINT32_MAX;
+        entry = true;
+      }
+    } else if (line->type == kLineInstruction) {
+      if (curr == 0) {
+        curr = block_push(s, start != UINT32_MAX ? start : lnum);
+        start = UINT32_MAX;
+        if (entry)
+          s->blocks.data[curr - 1].flags |= BLOCK_FLAG_ENTRY;
+        entry = false;
+        if (fall != 0)
+          s->blocks.data[fall - 1].succ[0] = curr;
+        fall = 0;
+      }
+      Block* block = &s->blocks.data[curr - 1];
+      block->last = lnum;
+
+      const byte* args;
+      String name = instruction_name(s, line, &args);
+      enum BranchKind kind = branch_kind(name, args);
+      if (kind != kBranchNone) {
+        // label line for now, indirect branches have none
+        if (kind != kBranchReturn)
+          block->succ[1] = branch_target(s, args);
+        fall = kind == kBranchCond ? curr : 0;
+        curr = 0;
+      }
+    }
+  }
+
+  // resolve label lines to blocks
+  for (u32 i = 0; i < s->blocks.size; ++i) {
+    Block* block = &s->blocks.data[i];
+    if (block->succ[1] != 0)
+      block->succ[1] = block_search(s, block->succ[1] - 1);
+  }
+}
+
+/// Build the control flow graph of the parsed input, and find natural loops.
+/// Fills `s->blocks`. Must run after neobolt_parse.
+///
+/// Dominators are computed with the iterative algorithm from "A Simple, Fast
+/// Dominance Algorithm" by Cooper, Harvey and Kennedy, over a virtual root that has
+/// an edge to every entry block. Loops that share a header are merged, and irreducible
+/// loops are not detected.
+INTERFACE bool neobolt_cfg(
+    State* const restrict s)
+{
+  // catch exceptions
+  if (setjmp(s->exception.jmpbuf) != 0)
+    return false;
+
+  CHECK(s->blocks.data == NULL);
+  cfg_blocks(s);
+
+  // nodes are 1-based block indices, zero is the virtual root
+  const u32 n = s->blocks.size;
+  Block* const blocks = s->blocks.data;
+#define BLOCK(i) (&blocks[(i) - 1])
+
+  u32* scratch = malloc((cast(usize, n) * 7 + 6) * sizeof(u32));
+  CHECK(scratch != NULL);
+  s->blocks.scratch = scratch;
+  u32* const pred_off = scratch; // n + 2, predecessors of x are preds[pred_off[x]..pred_off[x + 1]]
+  u32* const preds = pred_off + n + 2; // 2n
+  u32* const order = preds + cast(usize, n) * 2; // n + 1, blocks by postorder number
+  u32* const dom = order + n + 1; // n + 1, immediate dominators
+  u32* const stack = dom + n + 1; // n + 1
+  u32* const mark = stack + n + 1; // n + 1
+
+  // predecessors
+  memset(pred_off, 0, (cast(usize, n) + 2) * sizeof(u32));
+  for (u32 x = 1; x <= n; ++x)
+    for (int k = 0; k < 2; ++k)
+      if (BLOCK(x)->succ[k] != 0)
+        pred_off[BLOCK(x)->succ[k] + 1] += 1;
+  for (u32 x = 1; x <= n + 1; ++x)
+    pred_off[x] += pred_off[x - 1];
+  for (u32 x = 1; x <= n; ++x) {
+    for (int k = 0; k < 2; ++k) {
+      u32 t = BLOCK(x)->succ[k];
+      if (t != 0)
+        preds[pred_off[t]++] = x;
+    }
+  }
+  // filling shifted the offsets by one slot
+  for (u32 x = n + 1; x > 0; --x)
+    pred_off[x] = pred_off[x - 1];
+  pred_off[0] = 0;
+
+  for (u32 x = 1; x <= n; ++x)
+    if (pred_off[x] == pred_off[x + 1])
+      BLOCK(x)->flags |= BLOCK_FLAG_ENTRY;
+
+  // postorder from the entries. mark is 1 + next successor slot while visiting
+  memset(mark, 0, (cast(usize, n) + 1) * sizeof(u32));
+  u32 count = 0;
+  for (u32 e = 1; e <= n; ++e) {
+    if (!(BLOCK(e)->flags & BLOCK_FLAG_ENTRY) || mark[e] != 0)
+      continue;
+    u32 top = 0;
+    stack[top++] = e;
+    mark[e] = 1;
+    while (top != 0) {
+      u32 x = stack[top - 1];
+      if (mark[x] <= 2) {
+        u32 t = BLOCK(x)->succ[mark[x] - 1];
+        mark[x] += 1;
+        if (t != 0 && mark[t] == 0) {
+          mark[t] = 1;
+          stack[top++] = t;
+        }
+        continue;
+      }
+      top -= 1;
+      BLOCK(x)->order = ++count;
+      order[count] = x;
+    }
+  }
+  const u32 root_order = count + 1;
+#define ORDER(x) ((x) == 0 ? root_order : BLOCK(x)->order)
+
+  // dominators, in reverse postorder until nothing changes
+  dom[0] = 0;
+  for (u32 x = 1; x <= n; ++x)
+    dom[x] = UINT32_MAX;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (u32 i = count; i > 0; --i) {
+      u32 x = order[i];
+      u32 idom = (BLOCK(x)->flags & BLOCK_FLAG_ENTRY) ? 0 : UINT32_MAX;
+      for (u32 j = pred_off[x]; j < pred_off[x + 1]; ++j) {
+        u32 p = preds[j];
+        if (dom[p] == UINT32_MAX)
+          continue; // not processed yet, or unreachable
+        if (idom == UINT32_MAX) {
+          idom = p;
+          continue;
+        }
+        u32 a = p;
+        u32 b = idom;
+        while (a != b) {
+          while (ORDER(a) < ORDER(b))
+            a = dom[a];
+          while (ORDER(b) < ORDER(a))
+            b = dom[b];
+        }
+        idom = a;
+      }
+      if (idom != dom[x]) {
+        dom[x] = idom;
+        changed = true;
+      }
+    }
+  }
+
+  // back-edges go to a block that dominates the source
+  for (u32 x = 1; x <= n; ++x) {
+    Block* block = BLOCK(x);
+    if (block->order == 0)
+      continue; // unreachable
+    block->idom = dom[x];
+    for (int k = 0; k < 2; ++k) {
+      u32 h = block->succ[k];
+      if (h == 0 || BLOCK(h)->order < block->order)
+        continue; // only edges to DFS ancestors can be back-edges
+      u32 d = x;
+      while (d != 0 && d != h)
+        d = dom[d];
+      if (d == h) {
+        BLOCK(h)->flags |= BLOCK_FLAG_HEADER;
+        block->flags |= k == 0 ? BLOCK_FLAG_BACK_FALL : BLOCK_FLAG_BACK_JUMP;
+      }
+    }
+  }
+
+  // loop bodies, from each header back through predecessors of its back-edges.
+  // outer headers come first in reverse postorder, so inner loops overwrite `loop`
+  memset(mark, 0, (cast(usize, n) + 1) * sizeof(u32));
+  for (u32 i = count; i > 0; --i) {
+    u32 h = order[i];
+    if (!(BLOCK(h)->flags & BLOCK_FLAG_HEADER))
+      continue;
+
+    mark[h] = h;
+    BLOCK(h)->depth += 1;
+    BLOCK(h)->loop = h;
+
+    u32 top = 0;
+    for (u32 j = pred_off[h]; j < pred_off[h + 1]; ++j) {
+      u32 p = preds[j];
+      const Block* pb = BLOCK(p);
+      bool back = (pb->succ[0] == h && (pb->flags & BLOCK_FLAG_BACK_FALL))
+               || (pb->succ[1] == h && (pb->flags & BLOCK_FLAG_BACK_JUMP));
+      if (back && mark[p] != h) {
+        mark[p] = h;
+        BLOCK(p)->depth += 1;
+        BLOCK(p)->loop = h;
+        stack[top++] = p;
+      }
+    }
+    while (top != 0) {
+      u32 x = stack[--top];
+      for (u32 j = pred_off[x]; j < pred_off[x + 1]; ++j) {
+        u32 p = preds[j];
+        if (mark[p] == h || BLOCK(p)->order == 0)
+          continue;
+        mark[p] = h;
+        BLOCK(p)->depth += 1;
+        BLOCK(p)->loop = h;
+        stack[top++] = p;
+      }
+    }
+  }
+
+#undef ORDER
+#undef BLOCK
+  FREE(s->blocks.scratch);
+  return true;
+}
+
+
+/// Cost table entry of an instruction. Tries the name as is, then the families that
+/// share an entry, then without an AT&T size suffix. NULL when unknown.
+static const InstrUarchCost* instr_cost(
+    String name,
+    enum Uarch uarch)
+{
+  const struct InstrCost* cost = NULL;
+  const char* str = cast(const char*, name.ptr);
+  if (name.len == 0)
+    return NULL;
+
+  cost = instr_cost_lookup(str, name.len);
+  if (cost == NULL) {
+    if (name.ptr[0] == 'j' && branch_kind(name, cast(const byte*, "\n")) == kBranchCond)
+      cost = instr_cost_lookup("jcc", 3);
+    else if (name.len > 3 && memcmp(str, "set", 3) == 0)
+      cost = instr_cost_lookup("setcc", 5);
+    else if (name.len > 4 && memcmp(str, "cmov", 4) == 0)
+      cost = instr_cost_lookup("cmovcc", 6);
+    else if ((name.len > 2 && memcmp(str, "b.", 2) == 0)
+          || (name.len > 3 && memcmp(str, "bc.", 3) == 0))
+      cost = instr_cost_lookup("b.cond", 6);
+  }
+  if (cost == NULL && name.len > 1) {
+    byte suffix = name.ptr[name.len - 1];
+    if (suffix == 'b' || suffix == 'w' || suffix == 'l' || suffix == 'q') {
+      cost = instr_cost_lookup(str, name.len - 1);
+      if (cost == NULL && name.ptr[0] == 'j')
+        cost = instr_cost_lookup("jmp", 3); // jmpq
+    }
+  }
+  if (cost == NULL)
+    return NULL;
+
+  const InstrUarchCost* c = &cost->uarch[uarch];
+  if (c->lat == 0 && c->rthr == 0 && c->ports == 0)
+    return NULL;
+  return c;
+}
+
+/// Memory operands of an x86 instruction. Intel syntax writes memory in the first
+/// operand, AT&T in the last one.
+static void x86_memory_operands(
+    const byte* p,
+    bool* load,
+    bool* store)
+{
+  bool att = false;
+  bool first_mem = false;
+  bool last_mem = false;
+  bool first = true;
+  int depth = 0;
+  *load = false;
+  *store = false;
+
+  for (; *p != EOL && *p != '#'; ++p) {
+    if (*p == '%')
+      att = true;
+    if (*p == '(' || *p == '[') {
+      depth += 1;
+      if (first)
+        first_mem = true;
+      last_mem = true;
+    } else if (*p == ')' || *p == ']') {
+      depth -= 1;
+    } else if (*p == ',' && depth == 0) {
+      first = false;
+      last_mem = false;
+    }
+  }
+
+  if (!first_mem && !last_mem)
+    return;
+  *load = true;
+  *store = att ? last_mem : first_mem;
+}
+
+/// Estimate cycles per execution of every block, and per iteration of every loop,
+/// from the instruction cost table. Must run after neobolt_cfg.
+///
+/// Only a throughput bound: the busier of the issue width and the most contended
+/// port. Dependency chains, memory latency and inner loop trip counts are ignored,
+/// so this compares code, it doesn't predict it.
+INTERFACE void neobolt_costs(
+    State* const restrict s,
+    enum Uarch uarch)
+{
+  const UarchInfo* info = &uarch_info[uarch];
+
+  for (u32 i = 0; i < s->blocks.size; ++i) {
+    Block* block = &s->blocks.data[i];
+    u32 pressure[16] = {0};
+    u32 uops = 0;
+    block->unknown = 0;
+
+    for (u32 lnum = block->first; lnum <= block->last; ++lnum) {
+      const Line* line = &s->lines.data[lnum];
+      if (line->type != kLineInstruction)
+        continue;
+
+      const byte* args;
+      String name = instruction_name(s, line, &args);
+      const InstrUarchCost* cost = instr_cost(name, uarch);
+
+      bool load = false;
+      bool store = false;
+      if (info->x86 && branch_kind(name, args) == kBranchNone
+          && !STRTEST(name, "lea") && !STRTEST(name, "leaq") && !STRTEST(name, "leal")
+          && !(name.len >= 3 && memcmp(name.ptr, "nop", 3) == 0)
+          && !(name.len >= 8 && memcmp(name.ptr, "prefetch", 8) == 0)) {
+        x86_memory_operands(args, &load, &store);
+        // compares only read
+        if (store && ((name.len >= 3 && memcmp(name.ptr, "cmp", 3) == 0)
+                   || (name.len >= 4 && memcmp(name.ptr, "test", 4) == 0)
+                   || STRTEST(name, "bt") || STRTEST(name, "btl") || STRTEST(name, "btq")))
+          store = false;
+      }
+      // moves to and from memory are just the load or the store
+      bool move = (name.len >= 3 && memcmp(name.ptr, "mov", 3) == 0)
+               || (name.len >= 4 && memcmp(name.ptr, "vmov", 4) == 0);
+      if (move && store)
+        load = false;
+
+      if (cost == NULL) {
+        block->unknown += 1;
+        uops += 1;
+      } else if (!(move && (load || store))) {
+        uops += 1;
+        for (u32 port = 0; port < 16; ++port)
+          if (cost->ports & (1u << port))
+            pressure[port] += cost->rthr;
+      }
+      if (load) {
+        uops += 1;
+        for (u32 port = 0; port < 16; ++port)
+          if (info->load & (1u << port))
+            pressure[port] += info->load_rthr;
+      }
+      if (store) {
+        uops += 1;
+        for (u32 port = 0; port < 16; ++port)
+          if (info->store & (1u << port))
+            pressure[port] += info->store_rthr;
+      }
+    }
+
+    u32 cycles = (uops * 100 + info->width - 1) / info->width;
+    for (u32 port = 0; port < 16; ++port)
+      cycles = MAX(cycles, pressure[port]);
+    block->cycles = cycles;
+    block->loop_cycles = 0;
+  }
+
+  for (u32 i = 0; i < s->blocks.size; ++i) {
+    const Block* block = &s->blocks.data[i];
+    if (block->loop != 0)
+      s->blocks.data[block->loop - 1].loop_cycles += block->cycles;
+  }
+}
+
+
+#define STACK_LOAD 0x1
+#define STACK_STORE 0x2
+
+/// Stack pointer or frame pointer, of x86 or aarch64
+static inline bool is_stack_register(
+    String name)
+{
+  return STRTEST(name, "rsp") || STRTEST(name, "rbp")
+      || STRTEST(name, "esp") || STRTEST(name, "ebp")
+      || STRTEST(name, "sp") || STRTEST(name, "x29") || STRTEST(name, "fp");
+}
+
+/// STACK_* flags of an instruction with a stack pointer or frame pointer based memory
+/// operand, like `-8(%rbp)`, `[rsp+16]`, `QWORD PTR -8[rbp]` and `[sp, 16]`. Pushes,
+/// pops and address computations are not accesses.
+static u32 stack_access(
+    String name,
+    const byte* p)
+{
+  if ((name.len >= 4 && (memcmp(name.ptr, "push", 4) == 0 || memcmp(name.ptr, "call", 4) == 0))
+      || (name.len >= 3 && (memcmp(name.ptr, "pop", 3) == 0 || memcmp(name.ptr, "lea", 3) == 0))
+      || (name.len >= 3 && memcmp(name.ptr, "nop", 3) == 0)
+      || (name.len >= 8 && memcmp(name.ptr, "prefetch", 8) == 0)
+      || (name.len >= 3 && memcmp(name.ptr, "prf", 3) == 0))
+    return 0;
+
+  bool att = false;
+  u32 operand = 0; // 0-based index of the current operand
+  u32 last_operand = 0;
+  u32 stack_operand = 0; // 1-based
+  bool aarch64 = false;
+  int depth = 0;
+
+  for (; *p != EOL && !(p[0] == '/' && p[1] == '/'); ++p) {
+    // x86 comment, unlike aarch64 immediates like #16, #-16 and #:lo12:sym
+    if (*p == '#' && !(is_digit(p[1]) || p[1] == '-' || p[1] == ':'))
+      break;
+    if (*p == '%')
+      att = true;
+    if (*p == '(' || *p == '[') {
+      depth += 1;
+      if (depth == 1) {
+        // base register
+        const byte* q = p + 1;
+        parse_spaces(&q);
+        parse_byte(&q, '%');
+        String reg;
+        if (parse_symname(&q, &reg) && is_stack_register(reg)) {
+          stack_operand = operand + 1;
+          aarch64 = *p == '[' && !STRTEST(reg, "rsp") && !STRTEST(reg, "rbp")
+                 && !STRTEST(reg, "esp") && !STRTEST(reg, "ebp");
+        }
+      }
+    } else if (*p == ')' || *p == ']') {
+      depth -= 1;
+    } else if (*p == ',' && depth == 0) {
+      operand += 1;
+    }
+  }
+  last_operand = operand;
+  if (stack_operand == 0)
+    return 0;
+
+  if (aarch64) {
+    // ldr, ldp, ldur, ld1 and str, stp, stur, st1
+    if (name.len >= 2 && memcmp(name.ptr, "st", 2) == 0)
+      return STACK_STORE;
+    if (name.len >= 2 && memcmp(name.ptr, "ld", 2) == 0)
+      return STACK_LOAD;
+    return 0;
+  }
+
+  bool dest = att ? stack_operand - 1 == last_operand : stack_operand == 1;
+  if (!dest)
+    return STACK_LOAD;
+  // compares only read
+  if ((name.len >= 3 && memcmp(name.ptr, "cmp", 3) == 0)
+      || (name.len >= 4 && memcmp(name.ptr, "test", 4) == 0)
+      || (name.len >= 2 && memcmp(name.ptr, "bt", 2) == 0 && name.len <= 3))
+    return STACK_LOAD;
+  // moves only write, everything else is read-modify-write
+  if ((name.len >= 3 && memcmp(name.ptr, "mov", 3) == 0)
+      || (name.len >= 4 && memcmp(name.ptr, "vmov", 4) == 0)
+      || (name.len >= 3 && memcmp(name.ptr, "set", 3) == 0)
+      || (name.len >= 4 && memcmp(name.ptr, "fstp", 4) == 0))
+    return STACK_STORE;
+  return STACK_LOAD | STACK_STORE;
+}
+
+/// Bytes subtracted from the stack pointer, by `subq $N, %rsp`, `sub rsp, N` or
+/// `sub sp, sp, #N`. Zero for anything else.
+static u32 stack_alloc(
+    String name,
+    const byte* p)
+{
+  if (!(STRTEST(name, "sub") || STRTEST(name, "subq") || STRTEST(name, "subl")))
+    return 0;
+
+  u32 value = 0;
+  bool imm = false;
+  bool sp = false;
+  while (*p != EOL) {
+    String sym;
+    if (parse_byte(&p, '$') || parse_byte(&p, '#')) {
+      imm = parse_u32(&p, &value) || imm;
+    } else if (parse_symname(&p, &sym)) {
+      // first operand in Intel syntax and aarch64, last one in AT&T
+      if (STRTEST(sym, "rsp") || STRTEST(sym, "esp") || STRTEST(sym, "sp"))
+        sp = true;
+    } else if (is_digit(*p)) {
+      imm = parse_u32(&p, &value) || imm;
+    } else {
+      ++p;
+    }
+  }
+  return imm && sp ? value : 0;
+}
+
+static Function* function_push(
+    State* const restrict s,
+    u32 label)
+{
+  Functions* const self = &s->functions;
+
+  if UNLIKELY (self->size == self->cap) {
+    u32 ncap = self->cap == 0 ? NEOBOLT_FUNCTIONS_INITIAL_CAP : self->cap << 1;
+    CHECK(ncap != 0); // overflow
+    void* ndata = realloc(self->data, cast(usize, ncap) * sizeof(*self->data));
+    CHECK(ndata != NULL);
+    self->data = ndata;
+    self->cap = ncap;
+  }
+
+  Function* f = &self->data[self->size++];
+  *f = (Function){ .label = label, .last = label };
+  return f;
+}
+
+/// Find stack frame sizes, and spills and reloads, of every function. Sets
+/// LINE_FLAG_STACK_LOAD and LINE_FLAG_STACK_STORE on instructions accessing stack
+/// slots. With blocks from neobolt_cfg, also counts the ones in loops.
+///
+/// A function is a label, other than compiler generated ones, followed by
+/// instructions. Its frame size is the largest CFA offset, or the stack pointer
+/// subtractions on top of the CFA offset when the frame pointer holds the CFA.
+INTERFACE bool neobolt_frames(
+    State* const restrict s)
+{
+  // catch exceptions
+  if (setjmp(s->exception.jmpbuf) != 0)
+    return false;
+
+  CHECK(s->functions.data == NULL);
+
+  Function* f = NULL;
+  bool code = false; // current function has instructions
+  u32 cfa = 0;
+  u32 block = 0;
+  for (u32 lnum = 0; lnum < s->lines.size; ++lnum) {
+    Line* line = &s->lines.data[lnum];
+
+    if (line->type == kLineLabel && is_function_label(STR(s->input.ptr, line->name))) {
+      if (f != NULL && !code)
+        s->functions.size -= 1; // data, or a label without code
+      f = function_push(s, lnum);
+      code = false;
+      cfa = 0;
+    } else if (line->type == kLineDirective && f != NULL) {
+      String name = STR(s->input.ptr, line->name);
+      if (STRTEST(name, "cfi_def_cfa_offset")) {
+        const byte* p = line_args_ptr(s, line);
+        parse_spaces(&p);
+        if (parse_u32(&p, &cfa))
+          f->frame = MAX(f->frame, cfa);
+      } else if (STRTEST(name, "cfi_startproc")) {
+        cfa = 0;
+      }
+    } else if (line->type == kLineInstruction && f != NULL) {
+      code = true;
+      f->last = lnum;
+
+      String name = STR(s->input.ptr, line->name);
+      if (name.len >= 3 && name.ptr[0] == 's' && name.ptr[1] == 'u' && name.ptr[2] == 'b') {
+        u32 alloc = stack_alloc(name, line_args_ptr(s, line));
+        if (alloc != 0)
+          f->frame = MAX(f->frame, cfa + alloc);
+      }
+
+      if (!(line->flags & LINE_FLAG_MEMORY))
+        continue;
+      const byte* args;
+      name = instruction_name(s, line, &args);
+      u32 access = stack_access(name, args);
+      if (access == 0)
+        continue;
+      if (access & STACK_LOAD) {
+        line->flags |= LINE_FLAG_STACK_LOAD;
+        f->reloads += 1;
+      }
+      if (access & STACK_STORE) {
+        line->flags |= LINE_FLAG_STACK_STORE;
+        f->spills += 1;
+      }
+
+      if (s->blocks.size != 0) {
+        if (block == 0 || s->blocks.data[block - 1].last < lnum
+                       || s->blocks.data[block - 1].first > lnum)
+          block = block_search(s, lnum);
+        if (block != 0 && s->blocks.data[block - 1].depth > 0)
+          f->loop_spills += 1;
+      }
+    }
+  }
+  if (f != NULL && !code)
+    s->functions.size -= 1;
+
+  return true;
+}
+
 // vim: sw=2 sts=2 et
@@ -0,0 +1,302 @@
+#define NEOBOLT_STATS
+#include "neobolt.c"
+
+#include <stdio.h>
+
+#ifndef BENCH_DEFAULT_WARMUP
+# define BENCH_DEFAULT_WARMUP 3
+#endif
+#ifndef BENCH_DEFAULT_REPS
+# define BENCH_DEFAULT_REPS 20
+#endif
+
+/// Current timestamp, in nanoseconds. get_time is too coarse for small inputs
+static inline u64 get_time_ns(void)
+{
+#if defined(__unix__)
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return cast(u64, ts.tv_nsec) + cast(u64, ts.tv_sec) * 1000000000;
+#else
+  return get_time() * 1000;
+#endif
+}
+
+typedef struct {
+  u64 total; ///< nanoseconds
+  u64 pass1; ///< microseconds
+  u64 pass2; ///< microseconds
+  u64 pass3; ///< microseconds
+} Sample;
+
+typedef struct {
+  const char* path;
+  usize bytes;
+  u32 lines;
+  u64 hash_lookups;
+  u64 hash_misses;
+  double total; ///< median, seconds
+  double pass1; ///< median, seconds
+  double pass2; ///< median, seconds
+  double pass3; ///< median, seconds
+} Result;
+
+static bool read_file(
+    const char* path,
+    byte** rdata,
+    usize* rsize)
+{
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+
+  usize cap = 1 << 16;
+  usize size = 0;
+  byte* data = malloc(cap);
+  for (;;) {
+    if (data == NULL) {
+      perror("malloc");
+      fclose(file);
+      return false;
+    }
+    usize n = fread(data + size, 1, cap - size, file);
+    size += n;
+    if (size < cap)
+      break;
+    cap <<= 1;
+    byte* ndata = realloc(data, cap);
+    if (ndata == NULL)
+      free(data);
+    data = ndata;
+  }
+
+  bool ok = !ferror(file);
+  if (!ok)
+    perror(path);
+  fclose(file);
+  if (!ok || size >= cast(usize, UINT32_MAX)) {
+    free(data);
+    return false;
+  }
+
+  *rdata = data;
+  *rsize = size;
+  return true;
+}
+
+static int cmp_u64(
+    const void* a,
+    const void* b)
+{
+  u64 x = *cast(const u64*, a);
+  u64 y = *cast(const u64*, b);
+  return (x > y) - (x < y);
+}
+
+/// Median of `n` values. Reorders `values`
+static double median(
+    u64* values,
+    u32 n)
+{
+  qsort(values, n, sizeof(*values), cmp_u64);
+  if (n % 2 == 1)
+    return cast(double, values[n / 2]);
+  return (cast(double, values[n / 2 - 1]) + cast(double, values[n / 2])) / 2.0;
+}
+
+static bool bench_file(
+    const char* path,
+    u32 warmup,
+    u32 reps,
+    Result* res)
+{
+  byte* data;
+  usize size;
+  if (!read_file(path, &data, &size))
+    return false;
+
+  Sample* samples = calloc(reps, sizeof(*samples));
+  u64* values = calloc(reps, sizeof(*values));
+  if (samples == NULL || values == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  *res = (Result){ .path = path, .bytes = size };
+
+  bool ok = true;
+  for (u32 i = 0; i < warmup + reps; ++i) {
+    State state;
+    if (!neobolt_init(&state, data, size)) {
+      fprintf(stderr, "%s: invalid input\n", path);
+      ok = false;
+      break;
+    }
+
+    u64 time = get_time_ns();
+    if (!neobolt_parse(&state)) {
+      fprintf(stderr, "%s: %s (%s)\n", path, state.exception.msg, state.exception.loc);
+      neobolt_destroy(&state);
+      ok = false;
+      break;
+    }
+    time = get_time_ns() - time;
+
+    if (i >= warmup) {
+      samples[i - warmup] = (Sample){
+        .total = time,
+        .pass1 = state.time_pass1,
+        .pass2 = state.time_pass2,
+        .pass3 = state.time_pass3,
+      };
+    }
+    res->lines = state.lines.size;
+    res->hash_lookups = state.hash_lookups;
+    res->hash_misses = state.hash_misses;
+    neobolt_destroy(&state);
+  }
+
+  if (ok) {
+    for (u32 i = 0; i < reps; ++i) values[i] = samples[i].total;
+    res->total = median(values, reps) / 1e9;
+    for (u32 i = 0; i < reps; ++i) values[i] = samples[i].pass1;
+    res->pass1 = median(values, reps) / 1e6;
+    for (u32 i = 0; i < reps; ++i) values[i] = samples[i].pass2;
+    res->pass2 = median(values, reps) / 1e6;
+    for (u32 i = 0; i < reps; ++i) values[i] = samples[i].pass3;
+    res->pass3 = median(values, reps) / 1e6;
+  }
+
+  free(values);
+  free(samples);
+  free(data);
+  return ok;
+}
+
+static const char* basename_of(
+    const char* path)
+{
+  const char* name = strrchr(path, '/');
+  return name != NULL ? name + 1 : path;
+}
+
+static void print_result(
+    const Result* r)
+{
+  double mbs = r->total > 0 ? cast(double, r->bytes) / r->total / 1e6 : 0;
+  double lps = r->total > 0 ? cast(double, r->lines) / r->total : 0;
+  fprintf(stdout, "%-32s %10zu %9u %9.2f %12.0f %10.6f %10.6f %10.6f %10.6f\n",
+      basename_of(r->path), r->bytes, r->lines, mbs, lps,
+      r->total, r->pass1, r->pass2, r->pass3);
+}
+
+static void write_result(
+    FILE* out,
+    const char* commit,
+    u32 reps,
+    const Result* r)
+{
+  double mbs = r->total > 0 ? cast(double, r->bytes) / r->total / 1e6 : 0;
+  double lps = r->total > 0 ? cast(double, r->lines) / r->total : 0;
+  fprintf(out, "%s\t%s\t%zu\t%u\t%u\t%.2f\t%.0f\t%.9f\t%.6f\t%.6f\t%.6f\t%llu\t%llu\n",
+      commit, basename_of(r->path), r->bytes, r->lines, reps, mbs, lps,
+      r->total, r->pass1, r->pass2, r->pass3,
+      cast(unsigned long long, r->hash_lookups),
+      cast(unsigned long long, r->hash_misses));
+}
+
+static void print_help(
+    const char* progname)
+{
+  fprintf(stderr, "usage: %s [options] input...\n", progname);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "options:\n");
+  fprintf(stderr, "  -w N    warm-up runs (default %d)\n", BENCH_DEFAULT_WARMUP);
+  fprintf(stderr, "  -n N    measured runs (default %d)\n", BENCH_DEFAULT_REPS);
+  fprintf(stderr, "  -o FILE append tab-separated results to FILE\n");
+  fprintf(stderr, "  -c ID   commit ID recorded in the results\n");
+}
+
+int main(
+    int argc,
+    char** argv)
+{
+  u32 warmup = BENCH_DEFAULT_WARMUP;
+  u32 reps = BENCH_DEFAULT_REPS;
+  const char* out_path = NULL;
+  const char* commit = "-";
+
+  int i = 1;
+  for (; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (arg[0] != '-')
+      break;
+    if (strcmp(arg, "-h") == 0) {
+      print_help(argv[0]);
+      return 0;
+    }
+    if (arg[1] == '\0' || arg[2] != '\0' || i + 1 >= argc)
+      goto invalid_option;
+    const char* val = argv[++i];
+    if (arg[1] == 'w') {
+      warmup = cast(u32, strtoul(val, NULL, 10));
+    } else if (arg[1] == 'n') {
+      reps = cast(u32, strtoul(val, NULL, 10));
+    } else if (arg[1] == 'o') {
+      out_path = val;
+    } else if (arg[1] == 'c') {
+      commit = val[0] != '\0' ? val : "-";
+    } else {
+      goto invalid_option;
+    }
+    continue;
+
+invalid_option:
+    fprintf(stderr, "invalid argument: %s\n", arg);
+    print_help(argv[0]);
+    return 1;
+  }
+
+  if (i >= argc || reps == 0) {
+    print_help(argv[0]);
+    return 1;
+  }
+
+  FILE* out = NULL;
+  if (out_path != NULL) {
+    out = fopen(out_path, "a+");
+    if (out == NULL) {
+      perror(out_path);
+      return 1;
+    }
+    // write the header only into a fresh file, so results accumulate across commits
+    fseek(out, 0, SEEK_END);
+    if (ftell(out) == 0) {
+      fprintf(out, "commit\tinput\tbytes\tlines\treps\tmb_s\tlines_s"
+                   "\ttotal_s\tpass1_s\tpass2_s\tpass3_s\thash_lookups\thash_misses\n");
+    }
+  }
+
+  fprintf(stdout, "%-32s %10s %9s %9s %12s %10s %10s %10s %10s\n",
+      "input", "bytes", "lines", "MB/s", "lines/s", "total", "pass1", "pass2", "pass3");
+
+  int status = 0;
+  for (; i < argc; ++i) {
+    Result r;
+    if (!bench_file(argv[i], warmup, reps, &r)) {
+      status = 1;
+      continue;
+    }
+    print_result(&r);
+    if (out != NULL)
+      write_result(out, commit, reps, &r);
+  }
+
+  if (out != NULL)
+    fclose(out);
+  return status;
+}
+
+// vim: sw=2 sts=2 et
@@ -0,0 +1,743 @@
+// Codegen diff of two asm outputs of the same source, like -O2 against -O3 or gcc
+// against clang. Functions pair up by name, and the lines of each pair are aligned
+// with Myers' diff in linear space, giving up on the shortest script past a cost limit
+// the way git's xdiff does, so very different functions stay fast.
+//
+// Lines compare by their text with registers reduced to their class (%eax and %r9d
+// are both r32, x3 and x7 are both x), so register allocation alone isn't a
+// difference, and with all local labels alike. Instructions of different source lines
+// don't match when both sides know their line.
+//
+// Uses label_line_name from neobolt_profile.c.
+
+enum DiffOp {
+  kDiffSame = 0,
+  kDiffChanged, ///< Different lines in the same place
+  kDiffRemoved, ///< Only in the first asm
+  kDiffAdded, ///< Only in the second asm
+
+  kDiffOpCount,
+};
+
+static const char diff_op_chars[kDiffOpCount] = { '=', '~', '-', '+' };
+
+/// One asm output, like the lib.parse `lines` and `kinds`
+typedef struct {
+  const String* lines;
+  const byte* kinds; ///< 'l' for labels, 'i' for instructions, anything else for the rest
+  const u32* locs; ///< Source location of every line from neobolt_diff_loc, zero when unknown. Can be NULL
+  u32 count;
+} DiffSide;
+
+typedef struct {
+  u32 a; ///< 1-based line of the first asm, zero on a filler row
+  u32 b; ///< 1-based line of the second asm, zero on a filler row
+  u8 op; ///< DiffOp
+} DiffRow;
+
+typedef struct {
+  String name; ///< In the asm lines
+  u32 row; ///< Index of the row of its label
+  u32 a_insns; ///< Instructions in the first asm, zero when it's only in the second
+  u32 b_insns;
+  u32 removed; ///< Instructions only in the first asm, changed rows included
+  u32 added; ///< Instructions only in the second asm, changed rows included
+} DiffFunction;
+
+/// Lines from a function label up to the next one, or the lines before the first
+typedef struct {
+  u32 first;
+  u32 last; ///< Exclusive
+  u32 hash; ///< Of the label name
+  u32 match; ///< 1-based index of the segment of the other asm with the same name
+  bool label; ///< Starts with a function label, not the lines before the first one
+} DiffSegment;
+
+/// Distinct normalized line
+typedef struct {
+  StrRef text; ///< In Diff.text
+  u32 hash;
+} DiffClass;
+
+typedef struct {
+  DiffRow* rows;
+  u32 rows_size;
+  u32 rows_cap;
+  DiffFunction* functions;
+  u32 functions_size;
+  u32 functions_cap;
+  Exception exception;
+
+  // scratch, kept for reuse
+  Arena text;
+  DiffClass* classes;
+  u32* class_hash; ///< 1-based indices into `classes`, zero means the slot is empty
+  u32 class_size;
+  u32 class_cap;
+  u32 class_hash_cap; ///< Always a power of two
+  u32* keys; ///< Class and location of every line, first asm then second
+  u32* locs;
+  u8* changed; ///< Per line, not in the longest common subsequence
+  DiffSegment* segments; ///< First asm then second
+  u32* segment_hash; ///< 1-based indices of segments of the second asm, by name
+  i64* kvd; ///< Forward and backward furthest reaching paths of each diagonal
+  usize kvd_cap;
+} Diff;
+
+#ifndef NEOBOLT_DIFF_MIN_COST
+# define NEOBOLT_DIFF_MIN_COST 256
+#endif
+
+NORETURN NOINLINE static void diff_fail(
+    Diff* const restrict d,
+    const char* msg,
+    const char* loc)
+{
+  d->exception.msg = msg;
+  d->exception.loc = loc;
+  longjmp(d->exception.jmpbuf, 1);
+}
+
+#define DIFF_CHECK(cond) \
+  (LIKELY(cond) ? cast(void, 0) \
+   : diff_fail(d, "assertion failed: " #cond, __FILE__ ":" STRINGIFY(__LINE__)))
+
+INTERFACE void neobolt_diff_init(
+    Diff* const restrict d)
+{
+  *d = (Diff){0};
+}
+
+INTERFACE void neobolt_diff_destroy(
+    Diff* const restrict d)
+{
+  FREE(d->rows);
+  FREE(d->functions);
+  FREE(d->text.data);
+  FREE(d->classes);
+  FREE(d->class_hash);
+  FREE(d->keys);
+  FREE(d->locs);
+  FREE(d->changed);
+  FREE(d->segments);
+  FREE(d->segment_hash);
+  FREE(d->kvd);
+}
+
+/// Key of a source location for DiffSide.locs, never zero
+INTERFACE u32 neobolt_diff_loc(
+    String file,
+    u32 line)
+{
+  u32 key = fnv1a(file) ^ (line * 0x9E3779B1u);
+  return key != 0 ? key : 1;
+}
+
+#define DIFF_CLASS(lit) ((String){ cast(const byte*, lit), sizeof(lit) - 1 })
+
+/// Class of a register, its name without the number, like r32 for eax or r9d, xmm for
+/// xmm3 and x for x12. Stack, frame and instruction pointers are never renamed, they
+/// stay themselves. Empty when `tok` isn't a register, any name with a % is one when
+/// `prefixed`.
+static String diff_register_class(
+    String tok,
+    bool prefixed)
+{
+  static const char* const fixed[] = {
+    "rsp", "rbp", "rip", "esp", "ebp", "eip", "sp", "bp", "ip", "spl", "bpl",
+    "lr", "fp", "xzr", "wzr",
+  };
+  const byte* p = tok.ptr;
+  usize len = tok.len;
+
+  // x86 ax to di in their 64, 32 and 16-bit forms, and their bytes
+  if (len == 2 || (len == 3 && (p[0] == 'r' || p[0] == 'e'))) {
+    const byte* n = p + len - 2;
+    if ((n[1] == 'x' && n[0] >= 'a' && n[0] <= 'd') || ((n[0] == 's' || n[0] == 'd') && n[1] == 'i'))
+      return len == 2 ? DIFF_CLASS("r16") : p[0] == 'r' ? DIFF_CLASS("r64") : DIFF_CLASS("r32");
+  }
+  if ((len == 2 && p[0] >= 'a' && p[0] <= 'd' && (p[1] == 'l' || p[1] == 'h'))
+      || (len == 3 && (p[0] == 's' || p[0] == 'd') && p[1] == 'i' && p[2] == 'l'))
+    return DIFF_CLASS("r8");
+
+  usize letters = 0;
+  while (letters < len && is_lower(p[letters]))
+    ++letters;
+  usize digits = letters;
+  while (digits < len && is_digit(p[digits]))
+    ++digits;
+  if (digits == letters) {
+    for (usize i = 0; letters == len && i < sizeof(fixed) / sizeof(fixed[0]); ++i)
+      if (len == strlen(fixed[i]) && memcmp(p, fixed[i], len) == 0)
+        return tok;
+    return prefixed ? tok : (String){0};
+  }
+  if (letters == 3 && digits == len
+      && (memcmp(p, "xmm", 3) == 0 || memcmp(p, "ymm", 3) == 0 || memcmp(p, "zmm", 3) == 0))
+    return (String){ p, 3 };
+  if (letters == 1 && p[0] == 'r' && digits - letters <= 2) { // r8 to r15
+    if (digits == len)
+      return DIFF_CLASS("r64");
+    if (digits + 1 == len && p[digits] == 'd')
+      return DIFF_CLASS("r32");
+    if (digits + 1 == len && p[digits] == 'w')
+      return DIFF_CLASS("r16");
+    if (digits + 1 == len && (p[digits] == 'b' || p[digits] == 'l'))
+      return DIFF_CLASS("r8");
+  }
+  // x0, w12, v3, d1, k1, a0 and such
+  if (letters >= 1 && letters <= 2 && digits == len && digits - letters <= 2)
+    return (String){ p, letters };
+  return prefixed ? tok : (String){0};
+}
+
+/// Write the text `d` compares a line by, with the kind first: registers reduced to
+/// their class, local labels to L, whitespace collapsed and comments dropped. `out`
+/// has room for 2 * text.len + 2 bytes.
+static u32 diff_normalize(
+    String text,
+    byte kind,
+    byte* out)
+{
+  byte* o = out;
+  *o++ = kind == 'l' || kind == 'i' ? kind : 'd';
+
+  if (kind == 'l') {
+    String name = label_line_name(text);
+    if (is_function_label(name)) {
+      memcpy(o, name.ptr, name.len);
+      o += name.len;
+    } else {
+      *o++ = 'L';
+    }
+    return cast(u32, o - out);
+  }
+
+  // AT&T registers have a %, bare names there are symbols
+  bool prefixed = memchr(text.ptr, '%', text.len) != NULL;
+  const byte* q = text.ptr;
+  const byte* end = text.ptr + text.len;
+  bool space = false;
+  while (q < end) {
+    byte ch = *q;
+    if (is_space(ch)) {
+      space = o > out + 1;
+      ++q;
+      continue;
+    }
+    if ((ch == '#' && (q + 1 == end || is_space(q[1])))
+        || (ch == '/' && q + 1 < end && q[1] == '/') || ch == ';')
+      break; // comment
+    if (space) {
+      *o++ = ' ';
+      space = false;
+    }
+
+    if (ch == '%' || is_alpha(ch) || ch == '_' || ch == '.') {
+      const byte* start = ch == '%' ? q + 1 : q;
+      q = start;
+      if (ch == '.') {
+        while (q < end && is_symbol(*q))
+          ++q;
+      } else {
+        while (q < end && (is_alnum(*q) || *q == '_' || *q == '$'))
+          ++q;
+      }
+      String tok = { start, cast(usize, q - start) };
+      // the mnemonic is never a register
+      String cls = o == out + 1 || ch == '.' || (prefixed && ch != '%') ? (String){0}
+                 : diff_register_class(tok, ch == '%');
+      if (ch == '%')
+        *o++ = '%';
+      if (cls.len > 0) {
+        memcpy(o, cls.ptr, cls.len);
+        o += cls.len;
+      } else if (ch != '%' && tok.len > 1 && !is_function_label(tok)) {
+        *o++ = 'L';
+      } else {
+        memcpy(o, tok.ptr, tok.len);
+        o += tok.len;
+      }
+      continue;
+    }
+    if (is_digit(ch)) {
+      while (q < end && (is_alnum(*q) || *q == '_'))
+        *o++ = *q++;
+      continue;
+    }
+    *o++ = ch;
+    ++q;
+  }
+  return cast(u32, o - out);
+}
+
+static void diff_class_rehash(
+    Diff* const restrict d)
+{
+  u32 cap = d->class_hash_cap == 0 ? 1024 : d->class_hash_cap << 1;
+  DIFF_CHECK(cap != 0); // overflow
+  u32* hash = calloc(cap, sizeof(*hash));
+  DIFF_CHECK(hash != NULL);
+  for (u32 i = 0; i < d->class_size; ++i) {
+    u32 slot = d->classes[i].hash & (cap - 1);
+    while (hash[slot] != 0)
+      slot = (slot + 1) & (cap - 1);
+    hash[slot] = i + 1;
+  }
+  free(d->class_hash);
+  d->class_hash = hash;
+  d->class_hash_cap = cap;
+}
+
+/// Class of a line, 1-based. Lines with the same normalized text share it.
+static u32 diff_class(
+    Diff* const restrict d,
+    String text,
+    byte kind)
+{
+  Arena* const arena = &d->text;
+  DIFF_CHECK(text.len < (UINT32_MAX - arena->top - 2) / 2);
+  u32 need = arena->top + cast(u32, text.len) * 2 + 2;
+  if UNLIKELY (need >= arena->cap) {
+    u32 ncap = nextpow2(MAX(need + 1, 4096u));
+    DIFF_CHECK(ncap != 0); // overflow
+    byte* ndata = realloc(arena->data, ncap);
+    DIFF_CHECK(ndata != NULL);
+    arena->data = ndata;
+    arena->cap = ncap;
+  }
+  if UNLIKELY (d->class_size * 2 >= d->class_hash_cap)
+    diff_class_rehash(d);
+
+  StrRef ref = { .off = arena->top };
+  ref.len = diff_normalize(text, kind, arena->data + ref.off);
+  String str = STR(arena->data, ref);
+  u32 hash = fnv1a(str);
+  u32 slot = hash & (d->class_hash_cap - 1);
+  for (u32 idx; (idx = d->class_hash[slot]) != 0; slot = (slot + 1) & (d->class_hash_cap - 1)) {
+    const DiffClass* cls = &d->classes[idx - 1];
+    if (cls->hash == hash && STREQ(STR(arena->data, cls->text), str))
+      return idx;
+  }
+
+  if UNLIKELY (d->class_size == d->class_cap) {
+    u32 ncap = d->class_cap == 0 ? 1024 : d->class_cap << 1;
+    DIFF_CHECK(ncap != 0); // overflow
+    DiffClass* ndata = realloc(d->classes, cast(usize, ncap) * sizeof(*ndata));
+    DIFF_CHECK(ndata != NULL);
+    d->classes = ndata;
+    d->class_cap = ncap;
+  }
+  arena->top += ref.len;
+  d->classes[d->class_size++] = (DiffClass){ .text = ref, .hash = hash };
+  d->class_hash[slot] = d->class_size;
+  return d->class_size;
+}
+
+static void diff_push_row(
+    Diff* const restrict d,
+    u32 a,
+    u32 b,
+    u8 op)
+{
+  if UNLIKELY (d->rows_size == d->rows_cap) {
+    u32 ncap = d->rows_cap == 0 ? 1024 : d->rows_cap << 1;
+    DIFF_CHECK(ncap != 0); // overflow
+    DiffRow* ndata = realloc(d->rows, cast(usize, ncap) * sizeof(*ndata));
+    DIFF_CHECK(ndata != NULL);
+    d->rows = ndata;
+    d->rows_cap = ncap;
+  }
+  d->rows[d->rows_size++] = (DiffRow){ .a = a, .b = b, .op = op };
+}
+
+static DiffFunction* diff_push_function(
+    Diff* const restrict d)
+{
+  if UNLIKELY (d->functions_size == d->functions_cap) {
+    u32 ncap = d->functions_cap == 0 ? 64 : d->functions_cap << 1;
+    DIFF_CHECK(ncap != 0); // overflow
+    DiffFunction* ndata = realloc(d->functions, cast(usize, ncap) * sizeof(*ndata));
+    DIFF_CHECK(ndata != NULL);
+    d->functions = ndata;
+    d->functions_cap = ncap;
+  }
+  DiffFunction* f = &d->functions[d->functions_size++];
+  *f = (DiffFunction){0};
+  return f;
+}
+
+/// Lines of one segment pair, in indices relative to the start of each
+typedef struct {
+  const u32* key1;
+  const u32* key2;
+  const u32* loc1;
+  const u32* loc2;
+  u8* changed1;
+  u8* changed2;
+  i64* kvdf;
+  i64* kvdb;
+  i64 max_cost;
+} DiffRange;
+
+static inline bool diff_eq(
+    const DiffRange* r,
+    i64 i1,
+    i64 i2)
+{
+  if (r->key1[i1] != r->key2[i2])
+    return false;
+  u32 l1 = r->loc1[i1], l2 = r->loc2[i2];
+  return l1 == 0 || l2 == 0 || l1 == l2;
+}
+
+typedef struct {
+  i64 i1;
+  i64 i2;
+  bool min_lo; ///< The script before the split must be the shortest
+  bool min_hi;
+} DiffSplit;
+
+/// Middle snake of the shortest edit script of [off1, lim1) and [off2, lim2), searching
+/// from both ends until the paths meet. Past the cost limit, when the shortest script
+/// isn't needed, split where one of the paths got furthest instead.
+static void diff_split(
+    const DiffRange* r,
+    i64 off1,
+    i64 lim1,
+    i64 off2,
+    i64 lim2,
+    bool need_min,
+    DiffSplit* split)
+{
+  i64* const kvdf = r->kvdf;
+  i64* const kvdb = r->kvdb;
+  i64 dmin = off1 - lim2, dmax = lim1 - off2;
+  i64 fmid = off1 - off2, bmid = lim1 - lim2;
+  bool odd = ((fmid - bmid) & 1) != 0;
+  i64 fmin = fmid, fmax = fmid;
+  i64 bmin = bmid, bmax = bmid;
+
+  kvdf[fmid] = off1;
+  kvdb[bmid] = lim1;
+
+  for (i64 cost = 1;; ++cost) {
+    // forward paths, one more edit on every diagonal
+    if (fmin > dmin)
+      kvdf[--fmin - 1] = -1;
+    else
+      ++fmin;
+    if (fmax < dmax)
+      kvdf[++fmax + 1] = -1;
+    else
+      --fmax;
+    for (i64 k = fmax; k >= fmin; k -= 2) {
+      i64 i1 = kvdf[k - 1] >= kvdf[k + 1] ? kvdf[k - 1] + 1 : kvdf[k + 1];
+      i64 i2 = i1 - k;
+      while (i1 < lim1 && i2 < lim2 && diff_eq(r, i1, i2))
+        ++i1, ++i2;
+      kvdf[k] = i1;
+      if (odd && bmin <= k && k <= bmax && kvdb[k] <= i1) {
+        *split = (DiffSplit){ i1, i2, true, true };
+        return;
+      }
+    }
+
+    // backward paths
+    if (bmin > dmin)
+      kvdb[--bmin - 1] = INT64_MAX;
+    else
+      ++bmin;
+    if (bmax < dmax)
+      kvdb[++bmax + 1] = INT64_MAX;
+    else
+      --bmax;
+    for (i64 k = bmax; k >= bmin; k -= 2) {
+      i64 i1 = kvdb[k - 1] < kvdb[k + 1] ? kvdb[k - 1] : kvdb[k + 1] - 1;
+      i64 i2 = i1 - k;
+      while (i1 > off1 && i2 > off2 && diff_eq(r, i1 - 1, i2 - 1))
+        --i1, --i2;
+      kvdb[k] = i1;
+      if (!odd && fmin <= k && k <= fmax && i1 <= kvdf[k]) {
+        *split = (DiffSplit){ i1, i2, true, true };
+        return;
+      }
+    }
+
+    if (need_min || cost < r->max_cost)
+      continue;
+
+    // too expensive, take the path that got furthest from its end
+    i64 fbest = -1, fbest1 = -1;
+    for (i64 k = fmax; k >= fmin; k -= 2) {
+      i64 i1 = MIN(kvdf[k], lim1);
+      i64 i2 = i1 - k;
+      if (lim2 < i2)
+        i1 = lim2 + k, i2 = lim2;
+      if (fbest < i1 + i2)
+        fbest = i1 + i2, fbest1 = i1;
+    }
+    i64 bbest = INT64_MAX, bbest1 = INT64_MAX;
+    for (i64 k = bmax; k >= bmin; k -= 2) {
+      i64 i1 = MAX(off1, kvdb[k]);
+      i64 i2 = i1 - k;
+      if (i2 < off2)
+        i1 = off2 + k, i2 = off2;
+      if (i1 + i2 < bbest)
+        bbest = i1 + i2, bbest1 = i1;
+    }
+    if ((lim1 + lim2) - bbest < fbest - (off1 + off2))
+      *split = (DiffSplit){ fbest1, fbest - fbest1, true, false };
+    else
+      *split = (DiffSplit){ bbest1, bbest - bbest1, false, true };
+    return;
+  }
+}
+
+/// Mark the lines of [off1, lim1) and [off2, lim2) that are not in their common
+/// subsequence
+static void diff_compare(
+    const DiffRange* r,
+    i64 off1,
+    i64 lim1,
+    i64 off2,
+    i64 lim2,
+    bool need_min)
+{
+  while (off1 < lim1 && off2 < lim2 && diff_eq(r, off1, off2))
+    ++off1, ++off2;
+  while (off1 < lim1 && off2 < lim2 && diff_eq(r, lim1 - 1, lim2 - 1))
+    --lim1, --lim2;
+
+  if (off1 == lim1) {
+    for (; off2 < lim2; ++off2)
+      r->changed2[off2] = 1;
+  } else if (off2 == lim2) {
+    for (; off1 < lim1; ++off1)
+      r->changed1[off1] = 1;
+  } else {
+    DiffSplit split;
+    diff_split(r, off1, lim1, off2, lim2, need_min, &split);
+    diff_compare(r, off1, split.i1, off2, split.i2, split.min_lo);
+    diff_compare(r, split.i1, lim1, split.i2, lim2, split.min_hi);
+  }
+}
+
+static inline u32 diff_count_insns(
+    const DiffSide* side,
+    u32 first,
+    u32 last)
+{
+  u32 count = 0;
+  for (u32 i = first; i < last; ++i)
+    count += side->kinds[i] == 'i';
+  return count;
+}
+
+/// Rows of a segment of the first asm, the second, or both. Runs of removed and added
+/// lines between two common ones share rows as changed lines.
+static void diff_segments(
+    Diff* const restrict d,
+    const DiffSide* a,
+    const DiffSide* b,
+    const DiffSegment* sa,
+    const DiffSegment* sb)
+{
+  u32 a0 = sa != NULL ? sa->first : 0, a1 = sa != NULL ? sa->last : 0;
+  u32 b0 = sb != NULL ? sb->first : 0, b1 = sb != NULL ? sb->last : 0;
+  u32 n1 = a1 - a0, n2 = b1 - b0;
+  u8* changed1 = d->changed + a0;
+  u8* changed2 = d->changed + a->count + b0;
+  memset(changed1, sa != NULL && sb == NULL, n1);
+  memset(changed2, sa == NULL && sb != NULL, n2);
+
+  if (sa != NULL && sb != NULL) {
+    usize ndiags = cast(usize, n1) + n2 + 3;
+    usize need = 2 * ndiags + 2;
+    if (need > d->kvd_cap) {
+      FREE(d->kvd);
+      d->kvd = malloc(need * sizeof(*d->kvd));
+      DIFF_CHECK(d->kvd != NULL);
+      d->kvd_cap = need;
+    }
+    i64 max_cost = 1;
+    while (cast(usize, max_cost * max_cost) < ndiags)
+      max_cost <<= 1;
+    DiffRange range = {
+      .key1 = d->keys + a0,
+      .key2 = d->keys + a->count + b0,
+      .loc1 = d->locs + a0,
+      .loc2 = d->locs + a->count + b0,
+      .changed1 = changed1,
+      .changed2 = changed2,
+      .kvdf = d->kvd + n2 + 1,
+      .kvdb = d->kvd + n2 + 1 + ndiags,
+      .max_cost = MAX(max_cost, NEOBOLT_DIFF_MIN_COST),
+    };
+    diff_compare(&range, 0, n1, 0, n2, false);
+  }
+
+  DiffFunction* f = NULL;
+  if ((sa != NULL && sa->label) || (sb != NULL && sb->label)) {
+    f = diff_push_function(d);
+    f->name = label_line_name(sa != NULL ? a->lines[a0] : b->lines[b0]);
+    f->row = d->rows_size;
+    f->a_insns = sa != NULL ? diff_count_insns(a, a0, a1) : 0;
+    f->b_insns = sb != NULL ? diff_count_insns(b, b0, b1) : 0;
+  }
+
+  u32 i = 0, j = 0;
+  while (i < n1 || j < n2) {
+    u32 di = i, dj = j;
+    while (di < n1 && changed1[di])
+      ++di;
+    while (dj < n2 && changed2[dj])
+      ++dj;
+    for (u32 k = 0; k < MAX(di - i, dj - j); ++k) {
+      bool in1 = i + k < di, in2 = j + k < dj;
+      diff_push_row(d,
+          in1 ? a0 + i + k + 1 : 0,
+          in2 ? b0 + j + k + 1 : 0,
+          in1 && in2 ? kDiffChanged : in1 ? kDiffRemoved : kDiffAdded);
+      if (f != NULL) {
+        f->removed += in1 && a->kinds[a0 + i + k] == 'i';
+        f->added += in2 && b->kinds[b0 + j + k] == 'i';
+      }
+    }
+    i = di, j = dj;
+    if (i < n1 && j < n2) {
+      diff_push_row(d, a0 + i + 1, b0 + j + 1, kDiffSame);
+      ++i, ++j;
+    } else if (i < n1) {
+      changed1[i] = 1; // left over after the other side ended, can't be common
+    } else if (j < n2) {
+      changed2[j] = 1;
+    }
+  }
+}
+
+/// Split an asm into segments at function labels
+static u32 diff_split_segments(
+    const DiffSide* side,
+    DiffSegment* segments)
+{
+  u32 count = 0;
+  for (u32 i = 0; i < side->count; ++i) {
+    bool label = side->kinds[i] == 'l' && is_function_label(label_line_name(side->lines[i]));
+    if (i == 0 || label) {
+      if (count > 0)
+        segments[count - 1].last = i;
+      segments[count++] = (DiffSegment){
+        .first = i,
+        .hash = label ? fnv1a(label_line_name(side->lines[i])) : 0,
+        .label = label,
+      };
+    }
+  }
+  if (count > 0)
+    segments[count - 1].last = side->count;
+  return count;
+}
+
+/// Diff two asm outputs into `d->rows` and `d->functions`, replacing the previous
+/// ones. Functions are in the order of the first asm, the ones only in the second
+/// where they are there.
+INTERFACE bool neobolt_diff(
+    Diff* const restrict d,
+    const DiffSide* a,
+    const DiffSide* b)
+{
+  if (setjmp(d->exception.jmpbuf) != 0)
+    return false;
+
+  d->rows_size = 0;
+  d->functions_size = 0;
+  d->text.top = 0;
+  d->class_size = 0;
+  if (d->class_hash != NULL)
+    memset(d->class_hash, 0, d->class_hash_cap * sizeof(*d->class_hash));
+
+  DIFF_CHECK(a->count < UINT32_MAX / 2 && b->count < UINT32_MAX / 2 - a->count);
+  usize total = cast(usize, a->count) + b->count;
+  FREE(d->keys);
+  FREE(d->locs);
+  FREE(d->changed);
+  FREE(d->segments);
+  FREE(d->segment_hash);
+  d->keys = malloc((total + 1) * sizeof(*d->keys));
+  d->locs = malloc((total + 1) * sizeof(*d->locs));
+  d->changed = malloc(total + 1);
+  d->segments = malloc((total + 2) * sizeof(*d->segments));
+  DIFF_CHECK(d->keys != NULL && d->locs != NULL && d->changed != NULL && d->segments != NULL);
+
+  const DiffSide* sides[2] = { a, b };
+  u32 base = 0;
+  for (int s = 0; s < 2; ++s) {
+    const DiffSide* side = sides[s];
+    for (u32 i = 0; i < side->count; ++i) {
+      d->keys[base + i] = diff_class(d, side->lines[i], side->kinds[i]);
+      d->locs[base + i] = side->locs != NULL && side->kinds[i] == 'i' ? side->locs[i] : 0;
+    }
+    base += side->count;
+  }
+
+  DiffSegment* sa = d->segments;
+  u32 na = diff_split_segments(a, sa);
+  DiffSegment* sb = d->segments + na;
+  u32 nb = diff_split_segments(b, sb);
+
+  // pair segments by name, and the lines before the first function label
+  u32 cap = nextpow2(MAX(nb * 2, 16u));
+  DIFF_CHECK(cap != 0); // overflow
+  d->segment_hash = calloc(cap, sizeof(*d->segment_hash));
+  DIFF_CHECK(d->segment_hash != NULL);
+  for (u32 j = 0; j < nb; ++j) {
+    if (!sb[j].label)
+      continue;
+    u32 slot = sb[j].hash & (cap - 1);
+    while (d->segment_hash[slot] != 0)
+      slot = (slot + 1) & (cap - 1);
+    d->segment_hash[slot] = j + 1;
+  }
+  for (u32 i = 0; i < na; ++i) {
+    if (!sa[i].label) {
+      if (nb > 0 && !sb[0].label && sb[0].match == 0) {
+        sa[i].match = 1;
+        sb[0].match = i + 1;
+      }
+      continue;
+    }
+    String name = label_line_name(a->lines[sa[i].first]);
+    for (u32 slot = sa[i].hash & (cap - 1), idx; (idx = d->segment_hash[slot]) != 0;
+         slot = (slot + 1) & (cap - 1)) {
+      DiffSegment* other = &sb[idx - 1];
+      if (other->hash == sa[i].hash && other->match == 0
+          && STREQ(label_line_name(b->lines[other->first]), name)) {
+        sa[i].match = idx;
+        other->match = i + 1;
+        break;
+      }
+    }
+  }
+
+  u32 next = 0; // segments of the second asm before this one are done
+  for (u32 i = 0; i < na; ++i) {
+    u32 match = sa[i].match;
+    if (match == 0) {
+      diff_segments(d, a, b, &sa[i], NULL);
+      continue;
+    }
+    for (; next < match - 1; ++next)
+      if (sb[next].match == 0)
+        diff_segments(d, a, b, NULL, &sb[next]);
+    next = MAX(next, match);
+    diff_segments(d, a, b, &sa[i], &sb[match - 1]);
+  }
+  for (; next < nb; ++next)
+    if (sb[next].match == 0)
+      diff_segments(d, a, b, NULL, &sb[next]);
+
+  return true;
+}
+
+// vim: sw=2 sts=2 et
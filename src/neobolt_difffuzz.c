@@ -0,0 +1,189 @@
+// Differential fuzz test. Compares the optimized parser in every configuration against
+// the reference implementation in neobolt_ref.c: shown lines, their source locations,
+// and the file table must be identical.
+//
+// Built with NEOBOLT_FUZZ_STANDALONE it runs over files given on the command line
+// instead, for compilers without libFuzzer.
+
+#include "neobolt.c"
+#include "neobolt_ref.c"
+
+#include <stdio.h>
+
+/// Parser configuration. Options that must not change what gets shown.
+typedef struct {
+  const char* name;
+  bool trace;
+  bool cfg; ///< Also build the control flow graph, and check its consistency
+} DiffConfig;
+
+static const DiffConfig diff_configs[] = {
+  { .name = "default" },
+  { .name = "trace", .trace = true },
+  { .name = "cfg", .cfg = true },
+};
+
+NORETURN static void diff_fail(
+    const DiffConfig* config,
+    const char* what,
+    u32 line)
+{
+  fprintf(stderr, "neobolt_difffuzz: [%s] %s mismatch at line %u\n", config->name, what, line);
+  abort();
+}
+
+static void diff_check(
+    const DiffConfig* config,
+    const State* s,
+    const RefState* r)
+{
+  if (s->files.size != r->nfiles)
+    diff_fail(config, "file count", 0);
+  for (u32 i = 0; i < r->nfiles; ++i) {
+    String path = STR(s->arena.data, s->files.paths[i]);
+    if (path.len != r->files[i].len || memcmp(path.ptr, r->files[i].path, path.len) != 0)
+      diff_fail(config, "file path", 0);
+  }
+
+  // every line terminated with EOL is a line in both
+  if (s->lines.size != r->nlines)
+    diff_fail(config, "line count", 0);
+
+  for (u32 i = 0; i < r->nlines; ++i) {
+    const Line* line = &s->lines.data[i];
+    const RefLine* ref = &r->lines[i];
+
+    if (line->line.off != ref->off || line->line.len != ref->len)
+      diff_fail(config, "line range", i + 1);
+    if (line->type != ref->type)
+      diff_fail(config, "line type", i + 1);
+    if (!!(line->flags & LINE_FLAG_SHOW) != ref->show)
+      diff_fail(config, "shown line", i + 1);
+
+    if (line->loc == 0) {
+      if (ref->file != 0)
+        diff_fail(config, "missing location", i + 1);
+      continue;
+    }
+    if (ref->file == 0 || line->loc > s->loc.size)
+      diff_fail(config, "unexpected location", i + 1);
+    const Location* loc = &s->loc.data[line->loc - 1];
+    if (loc->file != ref->file || loc->line != ref->lnum || loc->col != ref->col)
+      diff_fail(config, "location", i + 1);
+  }
+}
+
+/// Blocks are ordered, cover instructions only, and loops are nested under headers
+static void cfg_check(
+    const DiffConfig* config,
+    const State* s)
+{
+  const Blocks* blocks = &s->blocks;
+  for (u32 i = 0; i < blocks->size; ++i) {
+    const Block* block = &blocks->data[i];
+    if (block->first > block->last || block->last >= s->lines.size
+        || (i > 0 && block->first <= blocks->data[i - 1].last))
+      diff_fail(config, "block range", block->first + 1);
+    if (s->lines.data[block->last].type != kLineInstruction)
+      diff_fail(config, "block end", block->last + 1);
+    if (block->succ[0] > blocks->size || block->succ[1] > blocks->size)
+      diff_fail(config, "block successor", block->last + 1);
+    if ((block->depth == 0) != (block->loop == 0))
+      diff_fail(config, "loop depth", block->first + 1);
+    if (block->loop != 0) {
+      const Block* header = &blocks->data[block->loop - 1];
+      if (!(header->flags & BLOCK_FLAG_HEADER) || header->depth > block->depth)
+        diff_fail(config, "loop header", block->first + 1);
+    }
+  }
+}
+
+static void diff_one(
+    const u8* data,
+    usize size)
+{
+  RefState ref;
+  bool ref_done = false;
+
+  for (usize c = 0; c < sizeof(diff_configs) / sizeof(diff_configs[0]); ++c) {
+    const DiffConfig* config = &diff_configs[c];
+
+    State state;
+    if (!neobolt_init(&state, data, size))
+      break; // rejected input, nothing to compare
+    state.trace = config->trace;
+
+    if (!neobolt_parse(&state)) {
+      // only resource limits fail, and the reference has none
+      neobolt_destroy(&state);
+      continue;
+    }
+
+    if (config->cfg) {
+      if (!neobolt_cfg(&state)) {
+        neobolt_destroy(&state);
+        continue;
+      }
+      cfg_check(config, &state);
+      for (u32 uarch = 0; uarch < kUarchCount; ++uarch)
+        neobolt_costs(&state, cast(enum Uarch, uarch));
+      if (!neobolt_frames(&state)) {
+        neobolt_destroy(&state);
+        continue;
+      }
+    }
+
+    if (!ref_done) {
+      ref_parse(&ref, data, cast(u32, size));
+      ref_done = true;
+    }
+    diff_check(config, &state, &ref);
+    neobolt_destroy(&state);
+  }
+
+  if (ref_done)
+    ref_destroy(&ref);
+}
+
+#if !defined(NEOBOLT_FUZZ_STANDALONE)
+
+int LLVMFuzzerTestOneInput(
+    const u8* data,
+    usize size)
+{
+  diff_one(data, size);
+  return 0;
+}
+
+#else
+
+int main(
+    int argc,
+    char** argv)
+{
+  for (int i = 1; i < argc; ++i) {
+    FILE* file = fopen(argv[i], "rb");
+    if (file == NULL) {
+      perror(argv[i]);
+      return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    byte* data = malloc(len > 0 ? cast(usize, len) : 1);
+    if (data == NULL || (len > 0 && fread(data, 1, cast(usize, len), file) != cast(usize, len))) {
+      perror(argv[i]);
+      return 1;
+    }
+    fclose(file);
+
+    fprintf(stderr, "%s\n", argv[i]);
+    diff_one(data, cast(usize, len));
+    free(data);
+  }
+  return 0;
+}
+
+#endif
+
+// vim: sw=2 sts=2 et
@@ -0,0 +1,231 @@
+// Code symbols of ELF64 relocatable objects: where functions and labels are in their
+// section and how big functions are. The asm doesn't say how many bytes instructions
+// encode to, an object compiled with the same flags does. Only what's needed is read,
+// section headers, .symtab and its string table, all bounds-checked.
+
+/// Symbol in an executable section
+typedef struct {
+  String name; ///< In the object data
+  u64 offset; ///< st_value, the offset in its section in relocatable objects
+  u64 size; ///< st_size, zero for labels
+  u64 align; ///< sh_addralign of its section, offsets are known modulo this until linked
+  u32 section;
+  u32 hash;
+} ElfSymbol;
+
+typedef struct {
+  ElfSymbol* data;
+  u32* hash; ///< 1-based indices into `data`, by name. Zero means the slot is empty
+  u32 size; ///< `data` element count
+  u32 cap; ///< `data` allocation size
+  u32 hash_cap; ///< `hash` allocation size. Always a power of two
+  Exception exception;
+} Elf;
+
+#define ELF_SHT_SYMTAB 2
+#define ELF_SHT_SYMTAB_SHNDX 18
+#define ELF_SHF_EXECINSTR 0x4
+#define ELF_SHN_UNDEF 0
+#define ELF_SHN_LORESERVE 0xFF00
+#define ELF_SHN_XINDEX 0xFFFF
+#define ELF_STT_NOTYPE 0
+#define ELF_STT_FUNC 2
+
+#define ELF_SHDR_SIZE 64
+#define ELF_SYM_SIZE 24
+
+NORETURN NOINLINE static void elf_fail(
+    Elf* const restrict e,
+    const char* msg,
+    const char* loc)
+{
+  e->exception.msg = msg;
+  e->exception.loc = loc;
+  longjmp(e->exception.jmpbuf, 1);
+}
+
+#define ELF_CHECK(cond) \
+  (LIKELY(cond) ? cast(void, 0) \
+   : elf_fail(e, "invalid object: " #cond, __FILE__ ":" STRINGIFY(__LINE__)))
+
+INTERFACE void neobolt_elf_init(
+    Elf* const restrict e)
+{
+  *e = (Elf){0};
+}
+
+INTERFACE void neobolt_elf_destroy(
+    Elf* const restrict e)
+{
+  FREE(e->data);
+  FREE(e->hash);
+}
+
+// little-endian fields, the object can be for another host
+
+static inline u16 elf_u16(const byte* p) { return cast(u16, p[0] | (p[1] << 8)); }
+
+static inline u32 elf_u32(const byte* p)
+{
+  return cast(u32, p[0]) | (cast(u32, p[1]) << 8) | (cast(u32, p[2]) << 16) | (cast(u32, p[3]) << 24);
+}
+
+static inline u64 elf_u64(const byte* p)
+{
+  return cast(u64, elf_u32(p)) | (cast(u64, elf_u32(p + 4)) << 32);
+}
+
+/// Whether `size` bytes at `off` are in the data
+static inline bool elf_in(
+    String data,
+    u64 off,
+    u64 size)
+{
+  return off <= data.len && size <= data.len - off;
+}
+
+static void elf_add(
+    Elf* const restrict e,
+    ElfSymbol sym)
+{
+  if UNLIKELY (e->size == e->cap) {
+    u32 ncap = e->cap == 0 ? 256 : e->cap << 1;
+    ELF_CHECK(ncap != 0); // overflow
+    ElfSymbol* ndata = realloc(e->data, cast(usize, ncap) * sizeof(*ndata));
+    ELF_CHECK(ndata != NULL);
+    e->data = ndata;
+    e->cap = ncap;
+  }
+  e->data[e->size++] = sym;
+}
+
+static void elf_index(
+    Elf* const restrict e)
+{
+  u32 cap = nextpow2(MAX(e->size * 2, 16u));
+  ELF_CHECK(cap != 0); // overflow
+  e->hash = calloc(cap, sizeof(*e->hash));
+  ELF_CHECK(e->hash != NULL);
+  e->hash_cap = cap;
+  for (u32 i = 0; i < e->size; ++i) {
+    u32 slot = e->data[i].hash & (cap - 1);
+    bool dup = false;
+    for (u32 idx; (idx = e->hash[slot]) != 0; slot = (slot + 1) & (cap - 1)) {
+      if (e->data[idx - 1].hash == e->data[i].hash && STREQ(e->data[idx - 1].name, e->data[i].name)) {
+        dup = true; // first one wins
+        break;
+      }
+    }
+    if (!dup)
+      e->hash[slot] = i + 1;
+  }
+}
+
+/// Read the code symbols of an ELF64 little-endian object. `data` must outlive `e`,
+/// symbol names point into it.
+INTERFACE bool neobolt_elf_read(
+    Elf* const restrict e,
+    String data)
+{
+  if (setjmp(e->exception.jmpbuf) != 0)
+    return false;
+
+  const byte* p = data.ptr;
+  ELF_CHECK(data.len >= 64 && memcmp(p, "\x7f" "ELF", 4) == 0);
+  ELF_CHECK(p[4] == 2); // ELFCLASS64
+  ELF_CHECK(p[5] == 1); // ELFDATA2LSB
+  u64 shoff = elf_u64(p + 0x28);
+  u16 shentsize = elf_u16(p + 0x3A);
+  u64 shnum = elf_u16(p + 0x3C);
+  ELF_CHECK(shoff != 0 && shentsize == ELF_SHDR_SIZE);
+  ELF_CHECK(elf_in(data, shoff, ELF_SHDR_SIZE));
+  // more than 0xFF00 sections, the count is in the first section header
+  if (shnum == 0)
+    shnum = elf_u64(p + shoff + 32);
+  ELF_CHECK(shnum <= (data.len - shoff) / ELF_SHDR_SIZE);
+  const byte* sh = p + shoff;
+
+  for (u32 s = 0; s < shnum; ++s) {
+    const byte* symtab = sh + cast(usize, s) * ELF_SHDR_SIZE;
+    if (elf_u32(symtab + 4) != ELF_SHT_SYMTAB)
+      continue;
+    u64 sym_off = elf_u64(symtab + 24);
+    u64 sym_size = elf_u64(symtab + 32);
+    u32 strtab_idx = elf_u32(symtab + 40);
+    ELF_CHECK(elf_u64(symtab + 56) == ELF_SYM_SIZE);
+    ELF_CHECK(elf_in(data, sym_off, sym_size));
+    ELF_CHECK(strtab_idx < shnum);
+    const byte* strtab = sh + cast(usize, strtab_idx) * ELF_SHDR_SIZE;
+    u64 str_off = elf_u64(strtab + 24);
+    u64 str_size = elf_u64(strtab + 32);
+    ELF_CHECK(elf_in(data, str_off, str_size));
+
+    // section indices that don't fit in st_shndx
+    const byte* shndx = NULL;
+    u64 shndx_count = 0;
+    for (u32 x = 0; x < shnum; ++x) {
+      const byte* ext = sh + cast(usize, x) * ELF_SHDR_SIZE;
+      if (elf_u32(ext + 4) == ELF_SHT_SYMTAB_SHNDX && elf_u32(ext + 40) == s) {
+        ELF_CHECK(elf_in(data, elf_u64(ext + 24), elf_u64(ext + 32)));
+        shndx = p + elf_u64(ext + 24);
+        shndx_count = elf_u64(ext + 32) / 4;
+      }
+    }
+
+    u64 count = sym_size / ELF_SYM_SIZE;
+    for (u64 i = 1; i < count; ++i) {
+      const byte* sym = p + sym_off + i * ELF_SYM_SIZE;
+      u8 type = sym[4] & 0xF;
+      if (type != ELF_STT_NOTYPE && type != ELF_STT_FUNC)
+        continue;
+      u32 section = elf_u16(sym + 6);
+      if (section == ELF_SHN_XINDEX) {
+        ELF_CHECK(shndx != NULL && i < shndx_count);
+        section = elf_u32(shndx + i * 4);
+      } else if (section == ELF_SHN_UNDEF || section >= ELF_SHN_LORESERVE) {
+        continue; // undefined, absolute or common
+      }
+      ELF_CHECK(section < shnum);
+      const byte* sec = sh + cast(usize, section) * ELF_SHDR_SIZE;
+      if (!(elf_u64(sec + 8) & ELF_SHF_EXECINSTR))
+        continue;
+
+      u32 name_off = elf_u32(sym);
+      ELF_CHECK(name_off < str_size);
+      const byte* name = p + str_off + name_off;
+      const byte* name_end = memchr(name, '\0', cast(usize, str_size - name_off));
+      ELF_CHECK(name_end != NULL);
+      String str = { name, cast(usize, name_end - name) };
+      if (str.len == 0)
+        continue;
+      elf_add(e, (ElfSymbol){
+        .name = str,
+        .offset = elf_u64(sym + 8),
+        .size = elf_u64(sym + 16),
+        .align = MAX(elf_u64(sec + 48), 1u),
+        .section = section,
+        .hash = fnv1a(str),
+      });
+    }
+  }
+
+  elf_index(e);
+  return true;
+}
+
+/// Code symbol by name, NULL if there is none
+INTERFACE const ElfSymbol* neobolt_elf_find(
+    const Elf* const restrict e,
+    String name)
+{
+  if (e->hash_cap == 0)
+    return NULL;
+  u32 hash = fnv1a(name);
+  for (u32 slot = hash & (e->hash_cap - 1), idx; (idx = e->hash[slot]) != 0;
+       slot = (slot + 1) & (e->hash_cap - 1)) {
+    const ElfSymbol* sym = &e->data[idx - 1];
+    if (sym->hash == hash && STREQ(sym->name, name))
+      return sym;
+  }
+  return NULL;
+}
@@ -1,7 +1,13 @@
 // #define NEOBOLT_STATS
+// #define NEOBOLT_PERF
 #include "neobolt.c"
+#include "neobolt_profile.c"
+#include "neobolt_remarks.c"
+#include "neobolt_elf.c"
+#include "neobolt_diff.c"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 
 static void read_file(
@@ -49,16 +55,86 @@ static void read_file(
   *rsize = size;
 }
 
+/// Block prefix: block number, loop depth, and `loop` on the first shown line of a loop
+/// header or `back` on a branch back to one. With costs, cycles of the block and of
+/// the loop on its first shown line, `?` when some instructions are unknown
+static void print_block(
+    State* const s,
+    u32 lnum,
+    u32* block_idx,
+    u32* block_shown,
+    bool costs)
+{
+  const Blocks* blocks = &s->blocks;
+  while (*block_idx < blocks->size && blocks->data[*block_idx].last < lnum)
+    *block_idx += 1;
+
+  if (*block_idx >= blocks->size || blocks->data[*block_idx].first > lnum) {
+    printf("%14s%s", "", costs ? "                " : "");
+    return;
+  }
+
+  const Block* block = &blocks->data[*block_idx];
+  const char* mark = "";
+  bool first = false;
+  if (*block_shown != *block_idx + 1) {
+    *block_shown = *block_idx + 1;
+    first = true;
+    if (block->flags & BLOCK_FLAG_HEADER)
+      mark = "loop";
+  }
+  if (lnum == block->last && (block->flags & (BLOCK_FLAG_BACK_FALL | BLOCK_FLAG_BACK_JUMP)))
+    mark = "back";
+  printf("%5u %2u %-4s ", *block_idx + 1, block->depth, mark);
+
+  if (costs && first) {
+    printf("%6.2f%c ", block->cycles / 100.0, block->unknown ? '?' : ' ');
+    if (block->flags & BLOCK_FLAG_HEADER)
+      printf("%6.2f ", block->loop_cycles / 100.0);
+    else
+      printf("%7s", "");
+  } else if (costs) {
+    printf("%16s", "");
+  }
+}
+
 static void print_lines(
     State* const s,
-    bool source)
+    bool source,
+    bool blocks,
+    bool costs,
+    bool frames,
+    const ProfileHit* hits,
+    double total)
 {
+  u32 block_idx = 0;
+  u32 block_shown = 0;
+  u32 shown = 0;
   for (u32 i = 0; i < s->lines.size; ++i) {
     Line* line = &s->lines.data[i];
 
     if (!(line->flags & LINE_FLAG_SHOW))
       continue;
 
+    if (blocks)
+      print_block(s, i, &block_idx, &block_shown, costs);
+
+    if (hits != NULL) {
+      const ProfileHit* hit = &hits[shown];
+      if (line->type == kLineInstruction && hit->samples > 0)
+        printf("%6.2f%% ", cast(double, hit->samples) * 100.0 / total);
+      else
+        printf("%8s", "");
+    }
+    ++shown;
+
+    if (frames) {
+      u8 stack = line->flags & (LINE_FLAG_STACK_LOAD | LINE_FLAG_STACK_STORE);
+      printf("%-7s ", stack == (LINE_FLAG_STACK_LOAD | LINE_FLAG_STACK_STORE) ? "rmw"
+                    : stack == LINE_FLAG_STACK_STORE ? "spill"
+                    : stack == LINE_FLAG_STACK_LOAD ? "reload" : "");
+    }
+
     if (source && line->loc != 0) {
       assert(line->loc <= s->loc.size);
       Location* loc = &s->loc.data[line->loc - 1];
@@ -78,6 +154,245 @@ static void print_lines(
   }
 }
 
+/// Stack frame size, spills and reloads of every function
+static void print_functions(
+    State* const s)
+{
+  printf("\n%-40s %8s %8s %8s %8s\n", "function", "frame", "spills", "reloads", "in loops");
+  for (u32 i = 0; i < s->functions.size; ++i) {
+    const Function* f = &s->functions.data[i];
+    String name = STR(s->input.ptr, s->lines.data[f->label].name);
+    printf("%-40.*s %8u %8u %8u %8u\n",
+        cast(int, name.len),
+        name.ptr,
+        f->frame,
+        f->spills,
+        f->reloads,
+        f->loop_spills);
+  }
+}
+
+/// Shown lines and their kinds, like the lib.parse `lines` and `kinds`
+static u32 shown_lines(
+    State* const s,
+    String* lines,
+    byte* kinds)
+{
+  u32 count = 0;
+  for (u32 i = 0; i < s->lines.size; ++i) {
+    const Line* line = &s->lines.data[i];
+    if (!(line->flags & LINE_FLAG_SHOW))
+      continue;
+    lines[count] = STR(s->input.ptr, line->line);
+    kinds[count] = line->type == kLineInstruction ? 'i'
+                 : line->type == kLineLabel || line->type == kLineLocalLabel ? 'l' : 'd';
+    ++count;
+  }
+  return count;
+}
+
+/// Source location keys of the shown lines for neobolt_diff
+static void shown_locs(
+    State* const s,
+    u32* locs)
+{
+  u32 count = 0;
+  for (u32 i = 0; i < s->lines.size; ++i) {
+    const Line* line = &s->lines.data[i];
+    if (!(line->flags & LINE_FLAG_SHOW))
+      continue;
+    u32 key = 0;
+    if (line->loc != 0) {
+      const Location* loc = &s->loc.data[line->loc - 1];
+      if (loc->file != 0)
+        key = neobolt_diff_loc(STR(s->arena.data, s->files.paths[loc->file - 1]), loc->line);
+    }
+    locs[count++] = key;
+  }
+}
+
+/// Samples of every function in the dump, and the ones no instruction matched
+static void print_profile(
+    State* const s,
+    const ProfileHit* hits,
+    double total)
+{
+  printf("\n%-40s %8s %10s\n", "function", "samples", "unmatched");
+  u32 shown = 0;
+  for (u32 i = 0; i < s->lines.size; ++i) {
+    const Line* line = &s->lines.data[i];
+    if (!(line->flags & LINE_FLAG_SHOW))
+      continue;
+    const ProfileHit* hit = &hits[shown++];
+    if (!hit->found)
+      continue;
+    String name = STR(s->input.ptr, line->name);
+    printf("%-40.*s %7.2f%% %9.2f%%\n",
+        cast(int, name.len),
+        name.ptr,
+        cast(double, hit->samples) * 100.0 / total,
+        cast(double, hit->unmatched) * 100.0 / total);
+  }
+}
+
+/// Offset and size of the shown labels in an object of the same asm, and the offset
+/// modulo a 64-byte cache line. `?` when the section alignment is smaller, the linker
+/// decides
+static void print_layout(
+    State* const s,
+    const Elf* const elf)
+{
+  printf("\n%-40s %8s %8s %8s\n", "label", "offset", "size", "mod 64");
+  for (u32 i = 0; i < s->lines.size; ++i) {
+    const Line* line = &s->lines.data[i];
+    if (!(line->flags & LINE_FLAG_SHOW) || (line->type != kLineLabel && line->type != kLineLocalLabel))
+      continue;
+    String name = STR(s->input.ptr, line->name);
+    const ElfSymbol* sym = neobolt_elf_find(elf, name);
+    if (sym == NULL)
+      continue;
+    printf("%-40.*s %8llx %8llu %7llu%s\n",
+        cast(int, name.len),
+        name.ptr,
+        cast(unsigned long long, sym->offset),
+        cast(unsigned long long, sym->size),
+        cast(unsigned long long, sym->offset % 64),
+        sym->align >= 64 ? " " : "?");
+  }
+}
+
+/// Print a line with tabs expanded, up to `width` columns. Returns the columns printed.
+static int print_expanded(
+    String text,
+    int width)
+{
+  int col = 0;
+  for (usize i = 0; i < text.len && col < width; ++i) {
+    if (text.ptr[i] == '\t') {
+      do
+        putchar(' ');
+      while (++col % 8 != 0 && col < width);
+    } else {
+      putchar(text.ptr[i]);
+      ++col;
+    }
+  }
+  return col;
+}
+
+/// Both asm outputs side by side, and instruction counts of every function
+static void print_diff(
+    const Diff* const d,
+    const String* a,
+    const String* b)
+{
+  printf("\n");
+  for (u32 i = 0; i < d->rows_size; ++i) {
+    const DiffRow* row = &d->rows[i];
+    printf("%c ", diff_op_chars[row->op]);
+    int col = row->a != 0 ? print_expanded(a[row->a - 1], 48) : 0;
+    printf("%*s | ", 48 - col, "");
+    if (row->b != 0)
+      print_expanded(b[row->b - 1], 1 << 30);
+    printf("\n");
+  }
+
+  printf("\n%-40s %8s %8s %8s %8s %8s\n", "function", "a", "b", "delta", "removed", "added");
+  for (u32 i = 0; i < d->functions_size; ++i) {
+    const DiffFunction* f = &d->functions[i];
+    printf("%-40.*s %8u %8u %+8d %8u %8u\n",
+        cast(int, f->name.len),
+        f->name.ptr,
+        f->a_insns,
+        f->b_insns,
+        cast(int, f->b_insns) - cast(int, f->a_insns),
+        f->removed,
+        f->added);
+  }
+}
+
+/// Optimization remarks, like compiler diagnostics
+static void print_remarks(
+    const Remarks* const r)
+{
+  printf("\n");
+  for (u32 i = 0; i < r->size; ++i) {
+    const Remark* remark = &r->data[i];
+    String file = STR(r->text.data, remark->file);
+    String pass = STR(r->text.data, remark->pass);
+    String message = STR(r->text.data, remark->message);
+    printf("%.*s:%u:%u: %s: %.*s%s%.*s\n",
+        cast(int, file.len), file.ptr,
+        cast(unsigned, remark->line), cast(unsigned, remark->col),
+        remark_kind_names[remark->kind],
+        cast(int, pass.len), pass.ptr,
+        pass.len > 0 ? ": " : "",
+        cast(int, message.len), message.ptr);
+  }
+}
+
+#if defined(NEOBOLT_PERF)
+static void print_perf_row(
+    const char* name,
+    const u64 c[kPerfCounterCount],
+    double bytes,
+    double units)
+{
+  double ipc = c[kPerfCycles] ? cast(double, c[kPerfInstructions]) / cast(double, c[kPerfCycles]) : 0;
+  fprintf(stderr, "  %-14s %12.3f %8.2f %12.3f %12.3f %12.3f\n",
+      name,
+      bytes > 0 ? cast(double, c[kPerfCycles]) / bytes : 0,
+      ipc,
+      units > 0 ? cast(double, c[kPerfBranchMisses]) * 1000.0 / units : 0,
+      units > 0 ? cast(double, c[kPerfL1dMisses]) * 1000.0 / units : 0,
+      units > 0 ? cast(double, c[kPerfLLCMisses]) * 1000.0 / units : 0);
+}
+
+static void print_perf(
+    State* const s)
+{
+  Perf* p = &s->perf;
+
+  fprintf(stderr, "\n");
+  if (!p->open)
+    return;
+
+  bool any = false;
+  for (int i = 0; i < kPerfCounterCount; ++i)
+    any = any || p->fd[i] >= 0;
+  if (!any) {
+    fprintf(stderr, "  Performance counters unavailable: %s\n", strerror(p->error));
+    return;
+  }
+
+  static const char* const names[kPerfCounterCount] = {
+    [kPerfCycles] = "cycles",
+    [kPerfInstructions] = "instructions",
+    [kPerfBranchMisses] = "branch-misses",
+    [kPerfL1dMisses] = "L1d-misses",
+    [kPerfLLCMisses] = "LLC-misses",
+  };
+  for (int i = 0; i < kPerfCounterCount; ++i)
+    if (p->fd[i] < 0)
+      fprintf(stderr, "  Counter %s unavailable, reported as zero\n", names[i]);
+
+  double bytes = cast(double, s->input.len);
+  double lines = cast(double, s->lines.size);
+  fprintf(stderr, "  %-14s %12s %8s %12s %12s %12s\n",
+      "Counters", "cycles/byte", "IPC", "br-miss/1k", "L1d-miss/1k", "LLC-miss/1k");
+  print_perf_row("Pass 1", p->pass[0], bytes, lines);
+  print_perf_row("Pass 2", p->pass[1], bytes, lines);
+  print_perf_row("Pass 3", p->pass[2], bytes, lines);
+  if (p->hash) {
+    // per operation instead of per byte and line
+    fprintf(stderr, "  %-14s %12s %8s %12s %12s %12s\n",
+        "", "cycles/op", "IPC", "br-miss/1k op", "L1d-miss/1k op", "LLC-miss/1k op");
+    print_perf_row("Label hash", p->hash_counts, cast(double, p->hash_ops), cast(double, p->hash_ops));
+    fprintf(stderr, "  Instrumented hash operations %zu\n", cast(usize, p->hash_ops));
+  }
+}
+#endif
+
 static void print_stats(
     State* const s)
 {
@@ -154,6 +469,10 @@ static void print_stats(
       cast(usize, s->time_pass3 % 1000000));
 #endif
 
+#if defined(NEOBOLT_PERF)
+  print_perf(s);
+#endif
+
   // for (usize i = 0; i < s->label_hash.cap; ++i) {
   //   LabelHashSlot* slot = &s->label_hash.data[i];
   //   if (slot->line == 0)
@@ -170,9 +489,29 @@ static void print_help(
   fprintf(stderr, "usage: %s [options] [input]\n", progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "options:\n");
+  fprintf(stderr, "  -b  print basic blocks and loop depth, mark loop headers and back-edges\n");
+  fprintf(stderr, "  -f  print stack frame size, spills and reloads of functions, mark stack accesses\n");
   fprintf(stderr, "  -l  print source locations\n");
+  fprintf(stderr, "  -P <dump>\n");
+  fprintf(stderr, "      print the share of samples of every instruction and function, from a\n");
+  fprintf(stderr, "      `perf annotate --stdio` or `perf script` dump\n");
+  fprintf(stderr, "  -R <remarks>\n");
+  fprintf(stderr, "      print optimization remarks from a clang -fsave-optimization-record YAML\n");
+  fprintf(stderr, "      file or gcc -fopt-info output, without repeats\n");
+  fprintf(stderr, "  -E <object>\n");
+  fprintf(stderr, "      print the offset, size and offset modulo 64 of labels, from the ELF64\n");
+  fprintf(stderr, "      object of the same compile\n");
+  fprintf(stderr, "  -D <asm>\n");
+  fprintf(stderr, "      print a side-by-side diff against another asm of the same source,\n");
+  fprintf(stderr, "      with registers renamed alike, and instruction counts of functions\n");
+  fprintf(stderr, "  -u <uarch>\n");
+  fprintf(stderr, "      with -b, estimate cycles per block and loop iteration on skylake, zen3\n");
+  fprintf(stderr, "      or neoverse-n1\n");
   fprintf(stderr, "  -q  hide asm output\n");
   fprintf(stderr, "  -s  print statistics\n");
+#if defined(NEOBOLT_PERF)
+  fprintf(stderr, "  -p  with -s, attribute counters to label hash operations (slows passes down)\n");
+#endif
 }
 
 int main(
@@ -181,8 +520,16 @@ int main(
 {
   bool show_stats = false;
   bool show_loc = false;
+  bool show_blocks = false;
+  bool show_frames = false;
   bool quiet_asm = false;
+  bool perf_hash = false;
+  int uarch = -1;
   const char* file_path = NULL;
+  const char* profile_path = NULL;
+  const char* remarks_path = NULL;
+  const char* object_path = NULL;
+  const char* diff_path = NULL;
 
   for (int i = 1; i < argc; ++i) {
     const char* arg = argv[i];
@@ -197,8 +544,43 @@ int main(
           show_stats = true;
         } else if (*p == 'l') {
           show_loc = true;
+        } else if (*p == 'b') {
+          show_blocks = true;
+        } else if (*p == 'f') {
+          show_frames = true;
         } else if (*p == 'q') {
           quiet_asm = true;
+        } else if (*p == 'u') {
+          if (p[1] != '\0' || i + 1 >= argc)
+            goto invalid_option;
+          const char* name = argv[++i];
+          for (int k = 0; k < kUarchCount; ++k)
+            if (strcmp(name, uarch_info[k].name) == 0)
+              uarch = k;
+          if (uarch < 0) {
+            arg = name;
+            goto invalid_option;
+          }
+        } else if (*p == 'P') {
+          if (p[1] != '\0' || i + 1 >= argc)
+            goto invalid_option;
+          profile_path = argv[++i];
+        } else if (*p == 'R') {
+          if (p[1] != '\0' || i + 1 >= argc)
+            goto invalid_option;
+          remarks_path = argv[++i];
+        } else if (*p == 'E') {
+          if (p[1] != '\0' || i + 1 >= argc)
+            goto invalid_option;
+          object_path = argv[++i];
+        } else if (*p == 'D') {
+          if (p[1] != '\0' || i + 1 >= argc)
+            goto invalid_option;
+          diff_path = argv[++i];
+#if defined(NEOBOLT_PERF)
+        } else if (*p == 'p') {
+          perf_hash = true;
+#endif
         } else {
           goto invalid_option;
         }
@@ -239,6 +621,12 @@ invalid_option:
   State state;
   bool ok = neobolt_init(&state, data, size);
   assert(ok);
+#if defined(NEOBOLT_PERF)
+  if (show_stats)
+    neobolt_perf_open(&state, perf_hash);
+#else
+  (void)perf_hash;
+#endif
 
   u64 time = get_time();
   if (!neobolt_parse(&state)) {
@@ -248,8 +636,146 @@ invalid_option:
   }
   time = get_time() - time;
 
+  // loops for the blocks, and for the spills in loops of the functions
+  if ((show_blocks || show_frames) && !neobolt_cfg(&state)) {
+    fprintf(stderr, "Fatal error: %s\n", state.exception.msg);
+    fprintf(stderr, "  in %s\n", state.exception.loc);
+    goto cleanup;
+  }
+
+  if (show_blocks && uarch >= 0)
+    neobolt_costs(&state, cast(enum Uarch, uarch));
+
+  if (show_frames && !neobolt_frames(&state)) {
+    fprintf(stderr, "Fatal error: %s\n", state.exception.msg);
+    fprintf(stderr, "  in %s\n", state.exception.loc);
+    goto cleanup;
+  }
+
+  Profile profile;
+  neobolt_profile_init(&profile);
+  ProfileHit* hits = NULL;
+  double total = 1;
+  if (profile_path != NULL) {
+    FILE* file = fopen(profile_path, "rb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: %s\n", profile_path, strerror(errno));
+      goto cleanup_profile;
+    }
+    bool loaded = neobolt_profile_load(&profile, file);
+    fclose(file);
+
+    String* lines = malloc(state.lines.size * sizeof(*lines) + 1);
+    byte* kinds = malloc(state.lines.size + 1);
+    hits = malloc(state.lines.size * sizeof(*hits) + 1);
+    assert(lines != NULL && kinds != NULL && hits != NULL);
+    u32 count = shown_lines(&state, lines, kinds);
+    bool matched = loaded && neobolt_profile_match(&profile, lines, kinds, count, hits);
+    free(lines);
+    free(kinds);
+    if (!matched) {
+      fprintf(stderr, "Fatal error: %s\n", profile.exception.msg);
+      fprintf(stderr, "  in %s\n", profile.exception.loc);
+      goto cleanup_profile;
+    }
+    total = cast(double, MAX(profile.total, 1u));
+  }
+
   if (!quiet_asm)
-    print_lines(&state, show_loc);
+    print_lines(&state, show_loc, show_blocks, show_blocks && uarch >= 0, show_frames, hits, total);
+  if (show_frames)
+    print_functions(&state);
+  if (hits != NULL)
+    print_profile(&state, hits, total);
+
+  if (object_path != NULL) {
+    FILE* file = fopen(object_path, "rb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: %s\n", object_path, strerror(errno));
+      goto cleanup_profile;
+    }
+    byte* object;
+    usize object_size;
+    read_file(file, &object, &object_size);
+    fclose(file);
+    Elf elf;
+    neobolt_elf_init(&elf);
+    if (neobolt_elf_read(&elf, (String){ object, object_size })) {
+      print_layout(&state, &elf);
+    } else {
+      fprintf(stderr, "Fatal error: %s\n", elf.exception.msg);
+      fprintf(stderr, "  in %s\n", elf.exception.loc);
+    }
+    neobolt_elf_destroy(&elf);
+    free(object);
+  }
+
+  if (diff_path != NULL) {
+    FILE* file = fopen(diff_path, "rb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: %s\n", diff_path, strerror(errno));
+      goto cleanup_profile;
+    }
+    byte* other_data;
+    usize other_size;
+    read_file(file, &other_data, &other_size);
+    fclose(file);
+    State other;
+    bool other_ok = neobolt_init(&other, other_data, other_size);
+    assert(other_ok);
+    if (!neobolt_parse(&other)) {
+      fprintf(stderr, "Fatal error: %s\n", other.exception.msg);
+      fprintf(stderr, "  in %s\n", other.exception.loc);
+    } else {
+      String* a_lines = malloc(state.lines.size * sizeof(*a_lines) + 1);
+      byte* a_kinds = malloc(state.lines.size + 1);
+      u32* a_locs = malloc(state.lines.size * sizeof(*a_locs) + 1);
+      String* b_lines = malloc(other.lines.size * sizeof(*b_lines) + 1);
+      byte* b_kinds = malloc(other.lines.size + 1);
+      u32* b_locs = malloc(other.lines.size * sizeof(*b_locs) + 1);
+      assert(a_lines != NULL && a_kinds != NULL && a_locs != NULL);
+      assert(b_lines != NULL && b_kinds != NULL && b_locs != NULL);
+      DiffSide a = { a_lines, a_kinds, a_locs, shown_lines(&state, a_lines, a_kinds) };
+      DiffSide b = { b_lines, b_kinds, b_locs, shown_lines(&other, b_lines, b_kinds) };
+      shown_locs(&state, a_locs);
+      shown_locs(&other, b_locs);
+      Diff diff;
+      neobolt_diff_init(&diff);
+      if (neobolt_diff(&diff, &a, &b)) {
+        print_diff(&diff, a_lines, b_lines);
+      } else {
+        fprintf(stderr, "Fatal error: %s\n", diff.exception.msg);
+        fprintf(stderr, "  in %s\n", diff.exception.loc);
+      }
+      neobolt_diff_destroy(&diff);
+      free(a_lines);
+      free(a_kinds);
+      free(a_locs);
+      free(b_lines);
+      free(b_kinds);
+      free(b_locs);
+    }
+    neobolt_destroy(&other);
+    free(other_data);
+  }
+
+  if (remarks_path != NULL) {
+    FILE* file = fopen(remarks_path, "rb");
+    if (file == NULL) {
+      fprintf(stderr, "%s: %s\n", remarks_path, strerror(errno));
+      goto cleanup_profile;
+    }
+    Remarks remarks;
+    neobolt_remarks_init(&remarks, (String){ NULL, 0 }, (1u << kRemarkKindCount) - 1);
+    if (neobolt_remarks_load(&remarks, file)) {
+      print_remarks(&remarks);
+    } else {
+      fprintf(stderr, "Fatal error: %s\n", remarks.exception.msg);
+      fprintf(stderr, "  in %s\n", remarks.exception.loc);
+    }
+    fclose(file);
+    neobolt_remarks_destroy(&remarks);
+  }
 
   if (show_stats) {
     print_stats(&state);
@@ -259,6 +785,9 @@ invalid_option:
         cast(usize, time % 1000000));
   }
 
+cleanup_profile:
+  free(hits);
+  neobolt_profile_destroy(&profile);
 cleanup:
   neobolt_destroy(&state);
   free(data);
@@ -6,7 +6,10 @@ int LLVMFuzzerTestOneInput(
 {
   State state;
   if (neobolt_init(&state, data, size)) {
-    neobolt_parse(&state);
+    if (neobolt_parse(&state) && neobolt_cfg(&state)) {
+      neobolt_costs(&state, cast(enum Uarch, size % kUarchCount));
+      neobolt_frames(&state);
+    }
     neobolt_destroy(&state);
   }
   return 0;
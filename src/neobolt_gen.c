@@ -0,0 +1,506 @@
+// Synthetic GNU as generator, for scaling tests and fuzzer seeds.
+// Output is deterministic for the given options and seed.
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+#define cast(T, ...) ((T)(__VA_ARGS__))
+
+typedef struct {
+  u64 seed; ///< PRNG seed
+  u64 size; ///< Target output size in bytes. Zero means use `funcs`
+  u32 funcs; ///< Function count. Zero means use `size`
+  u32 labels; ///< Average basic block labels per function
+  u32 loc_pct; ///< Percentage of instructions preceded by .loc
+  u32 files; ///< Number of .file entries
+  u32 table_pct; ///< Percentage of functions with a jump table
+  u32 chain; ///< Max depth of cross-referenced data labels behind a jump table
+  u32 local_pct; ///< Percentage of basic blocks using numeric local labels
+  bool debug; ///< Emit .debug_* sections
+  bool att; ///< AT&T syntax instead of Intel
+} Options;
+
+typedef struct {
+  FILE* out;
+  u64 written;
+  u64 rng;
+  const Options* opts;
+  u32 label; ///< Next .L label number
+  u32 lc; ///< Next .LC label number
+  u32 src_line; ///< Current source line
+} Gen;
+
+/// xorshift64*
+static u64 rnd(
+    Gen* g)
+{
+  g->rng ^= g->rng >> 12;
+  g->rng ^= g->rng << 25;
+  g->rng ^= g->rng >> 27;
+  return g->rng * 0x2545F4914F6CDD1DULL;
+}
+
+/// Random integer in [0, n)
+static u32 rnd_n(
+    Gen* g,
+    u32 n)
+{
+  return n == 0 ? 0 : cast(u32, rnd(g) % n);
+}
+
+static bool rnd_pct(
+    Gen* g,
+    u32 pct)
+{
+  return rnd_n(g, 100) < pct;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static void emit(
+    Gen* g,
+    const char* fmt,
+    ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vfprintf(g->out, fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    perror("write");
+    exit(1);
+  }
+  g->written += cast(u64, n);
+}
+
+static const char* const regs64[] = { "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r12", "r13" };
+static const char* const regs32[] = { "eax", "ebx", "ecx", "edx", "esi", "edi", "r8d", "r9d", "r12d", "r13d" };
+static const char* const xmms[] = { "xmm0", "xmm1", "xmm2", "xmm3" };
+static const char* const vregs[] = { "xmm0", "xmm1", "xmm2", "xmm3", "ymm0", "ymm1", "ymm2", "ymm3" };
+static const char* const alu[] = { "add", "sub", "and", "or", "xor", "imul", "cmp", "test" };
+static const char* const jcc[] = { "je", "jne", "jl", "jle", "jg", "jge", "jb", "ja" };
+static const char* const vex[] = { "vaddps", "vmulps", "vpaddd", "vxorps", "vfmadd231ps" };
+static const char* const sse[] = { "addss", "mulsd", "paddd", "pxor", "movaps" };
+
+#define PICK(arr) ((arr)[rnd_n(g, cast(u32, sizeof(arr) / sizeof((arr)[0])))])
+
+static void emit_loc(
+    Gen* g)
+{
+  const Options* o = g->opts;
+  if (!rnd_pct(g, o->loc_pct))
+    return;
+  // most locations come from the main file, the rest from "headers"
+  u32 file = rnd_pct(g, 80) ? 1 : 1 + rnd_n(g, o->files);
+  g->src_line += rnd_n(g, 3);
+  emit(g, "\t.loc %u %u %u\n", file, g->src_line, 1 + rnd_n(g, 40));
+}
+
+static void emit_instruction(
+    Gen* g,
+    u32 nfuncs)
+{
+  bool att = g->opts->att;
+  u32 kind = rnd_n(g, 16);
+  const char* a = PICK(regs32);
+  const char* b = PICK(regs32);
+  if (kind < 6) {
+    if (att)
+      emit(g, "\t%sl\t%%%s, %%%s\n", PICK(alu), a, b);
+    else
+      emit(g, "\t%s\t%s, %s\n", PICK(alu), b, a);
+  } else if (kind < 9) {
+    int off = -4 * cast(int, 1 + rnd_n(g, 32));
+    if (att)
+      emit(g, "\tmovl\t%d(%%rbp), %%%s\n", off, a);
+    else
+      emit(g, "\tmov\t%s, DWORD PTR [rbp%d]\n", a, off);
+  } else if (kind < 11) {
+    int off = 8 * cast(int, rnd_n(g, 16));
+    if (att)
+      emit(g, "\tmovq\t%%%s, %d(%%rsp)\n", PICK(regs64), off);
+    else
+      emit(g, "\tmov\tQWORD PTR [rsp+%d], %s\n", off, PICK(regs64));
+  } else if (kind < 12) {
+    const char* x = PICK(vregs);
+    const char* y = x[0] == 'x' ? PICK(xmms) : "ymm4";
+    if (att)
+      emit(g, "\t%s\t%%%s, %%%s, %%%s\n", PICK(vex), y, x, x);
+    else
+      emit(g, "\t%s\t%s, %s, %s\n", PICK(vex), x, x, y);
+  } else if (kind < 13) {
+    if (att)
+      emit(g, "\t%s\t%%%s, %%%s\n", PICK(sse), PICK(xmms), PICK(xmms));
+    else
+      emit(g, "\t%s\t%s, %s\n", PICK(sse), PICK(xmms), PICK(xmms));
+  } else if (kind < 14 && g->lc > 0) {
+    if (att)
+      emit(g, "\tleaq\t.LC%u(%%rip), %%rdi\n", rnd_n(g, g->lc));
+    else
+      emit(g, "\tlea\trdi, .LC%u[rip]\n", rnd_n(g, g->lc));
+  } else if (kind < 15 && nfuncs > 0) {
+    emit(g, "\tcall\tf%u\n", rnd_n(g, nfuncs));
+  } else {
+    if (att)
+      emit(g, "\tmovl\t$%u, %%%s\n", rnd_n(g, 1000), a);
+    else
+      emit(g, "\tmov\t%s, %u\n", a, rnd_n(g, 1000));
+  }
+}
+
+/// Emits a jump table in .rodata, followed by a chain of data labels that reference each
+/// other. Returns the label number of the table.
+static u32 emit_table(
+    Gen* g,
+    u32 first_block,
+    u32 nblocks)
+{
+  u32 table = g->label++;
+  u32 depth = rnd_n(g, g->opts->chain + 1);
+
+  emit(g, "\t.section\t.rodata\n");
+  emit(g, "\t.align 8\n");
+  emit(g, ".L%u:\n", table);
+  for (u32 i = 0; i < nblocks; ++i)
+    emit(g, "\t.quad\t.L%u\n", first_block + i);
+  if (depth > 0)
+    emit(g, "\t.quad\t.L%u\n", g->label);
+
+  // cross-referenced data labels, each one pointing at the next.
+  // pass_3 has to walk these through the label queue.
+  for (u32 d = 0; d < depth; ++d) {
+    u32 lbl = g->label++;
+    emit(g, ".L%u:\n", lbl);
+    emit(g, "\t.long\t%u\n", rnd_n(g, 1u << 16));
+    emit(g, "\t.value\t%u\n", rnd_n(g, 1u << 16));
+    if (d + 1 < depth)
+      emit(g, "\t.quad\t.L%u\n", g->label);
+    else
+      emit(g, "\t.quad\t.L%u\n", table);
+  }
+
+  emit(g, "\t.text\n");
+  return table;
+}
+
+static void emit_string_constant(
+    Gen* g)
+{
+  emit(g, "\t.section\t.rodata.str1.1,\"aMS\",@progbits,1\n");
+  emit(g, ".LC%u:\n", g->lc++);
+  emit(g, "\t.string\t\"generated string %08" PRIx64 "\"\n", rnd(g));
+  emit(g, "\t.text\n");
+}
+
+static void emit_function(
+    Gen* g,
+    u32 fn,
+    u32 nfuncs)
+{
+  const Options* o = g->opts;
+  bool att = o->att;
+
+  if (rnd_pct(g, 30))
+    emit_string_constant(g);
+
+  u32 nblocks = 1 + rnd_n(g, 2 * o->labels + 1);
+  u32 first_block = g->label;
+  g->label += nblocks;
+
+  bool is_static = rnd_pct(g, 20);
+  emit(g, "\t.p2align 4\n");
+  if (!is_static)
+    emit(g, "\t.globl\tf%u\n", fn);
+  emit(g, "\t.type\tf%u, @function\n", fn);
+  emit(g, "f%u:\n", fn);
+  emit(g, ".LFB%u:\n", fn);
+  g->src_line += 2 + rnd_n(g, 8);
+  emit(g, "\t.loc 1 %u 1\n", g->src_line);
+  emit(g, "\t.cfi_startproc\n");
+  if (att) {
+    emit(g, "\tpushq\t%%rbp\n");
+    emit(g, "\t.cfi_def_cfa_offset 16\n");
+    emit(g, "\tmovq\t%%rsp, %%rbp\n");
+    emit(g, "\tsubq\t$%u, %%rsp\n", 16 * (1 + rnd_n(g, 8)));
+  } else {
+    emit(g, "\tpush\trbp\n");
+    emit(g, "\t.cfi_def_cfa_offset 16\n");
+    emit(g, "\tmov\trbp, rsp\n");
+    emit(g, "\tsub\trsp, %u\n", 16 * (1 + rnd_n(g, 8)));
+  }
+
+  u32 table = 0;
+  if (nblocks > 2 && rnd_pct(g, o->table_pct))
+    table = emit_table(g, first_block, nblocks);
+  if (table != 0) {
+    if (att)
+      emit(g, "\tjmp\t*.L%u(,%%rax,8)\n", table);
+    else
+      emit(g, "\tjmp\t[QWORD PTR .L%u[0+rax*8]]\n", table);
+  }
+
+  for (u32 b = 0; b < nblocks; ++b) {
+    bool local = rnd_pct(g, o->local_pct);
+    if (local)
+      emit(g, "1:\n");
+    emit(g, ".L%u:\n", first_block + b);
+
+    u32 ninsns = 2 + rnd_n(g, 10);
+    for (u32 i = 0; i < ninsns; ++i) {
+      emit_loc(g);
+      emit_instruction(g, nfuncs);
+    }
+
+    if (local && rnd_pct(g, 50)) {
+      emit(g, "\tjne\t1b\n"); // loop back to the numeric local label
+    } else if (b + 1 < nblocks) {
+      // forward or backward branch to another block of the same function
+      emit(g, "\t%s\t.L%u\n", PICK(jcc), first_block + rnd_n(g, nblocks));
+    }
+  }
+
+  emit(g, "\tleave\n");
+  emit(g, "\t.cfi_def_cfa 7, 8\n");
+  emit(g, "\tret\n");
+  emit(g, "\t.cfi_endproc\n");
+  emit(g, ".LFE%u:\n", fn);
+  emit(g, "\t.size\tf%u, .-f%u\n", fn, fn);
+}
+
+/// Debug sections for functions [first, last). Only referenced from other debug data, so
+/// the parser has to classify and skip all of it.
+static void emit_debug(
+    Gen* g,
+    u32 first,
+    u32 last)
+{
+  emit(g, "\t.section\t.debug_info,\"\",@progbits\n");
+  emit(g, ".Ldebug_info%u:\n", first);
+  emit(g, "\t.long\t0x%x\n", 0x40 + (last - first) * 0x30);
+  emit(g, "\t.value\t0x5\n");
+  emit(g, "\t.byte\t0x1\n");
+  emit(g, "\t.byte\t0x8\n");
+  emit(g, "\t.long\t.Ldebug_abbrev0\n");
+  for (u32 fn = first; fn < last; ++fn) {
+    emit(g, "\t.uleb128 0x%x\n", 2 + rnd_n(g, 8));
+    emit(g, "\t.long\t.LASF%u\n", fn);
+    emit(g, "\t.byte\t0x1\n");
+    emit(g, "\t.byte\t0x%x\n", rnd_n(g, 256));
+    emit(g, "\t.quad\t.LFB%u\n", fn);
+    emit(g, "\t.quad\t.LFE%u-.LFB%u\n", fn, fn);
+    emit(g, "\t.uleb128 0x1\n");
+    emit(g, "\t.byte\t0x9c\n");
+    emit(g, "\t.byte\t0\n");
+  }
+  emit(g, "\t.section\t.debug_aranges,\"\",@progbits\n");
+  emit(g, "\t.long\t0x2c\n");
+  emit(g, "\t.value\t0x2\n");
+  emit(g, "\t.long\t.Ldebug_info%u\n", first);
+  for (u32 fn = first; fn < last; ++fn) {
+    emit(g, "\t.quad\t.LFB%u\n", fn);
+    emit(g, "\t.quad\t.LFE%u-.LFB%u\n", fn, fn);
+  }
+  emit(g, "\t.section\t.debug_str,\"MS\",@progbits,1\n");
+  for (u32 fn = first; fn < last; ++fn) {
+    emit(g, ".LASF%u:\n", fn);
+    emit(g, "\t.string\t\"f%u\"\n", fn);
+  }
+  emit(g, "\t.text\n");
+}
+
+#define DEBUG_CHUNK 64
+
+static void generate(
+    Gen* g)
+{
+  const Options* o = g->opts;
+  // function count used for call targets. with a size target the total is not known
+  // up front, so calls only go backwards to already emitted functions.
+  u32 call_funcs = o->funcs;
+
+  emit(g, "\t.file\t\"gen.c\"\n");
+  if (!o->att)
+    emit(g, "\t.intel_syntax noprefix\n");
+  emit(g, "\t.text\n");
+  emit(g, ".Ltext0:\n");
+  emit(g, "\t.file 0 \"/tmp/neobolt\" \"gen.c\"\n");
+  emit(g, "\t.file 1 \"gen.c\"\n");
+  for (u32 i = 2; i <= o->files; ++i)
+    emit(g, "\t.file %u \"/usr/include/gen/header%u.h\"\n", i, i);
+
+  u32 fn = 0;
+  u32 debug_first = 0;
+  for (;;) {
+    if (o->funcs != 0 ? fn >= o->funcs : g->written >= o->size)
+      break;
+    emit_function(g, fn, call_funcs != 0 ? call_funcs : fn);
+    ++fn;
+    if (o->debug && fn - debug_first == DEBUG_CHUNK) {
+      emit_debug(g, debug_first, fn);
+      debug_first = fn;
+    }
+  }
+  if (o->debug && fn > debug_first)
+    emit_debug(g, debug_first, fn);
+
+  if (o->debug) {
+    emit(g, "\t.section\t.debug_abbrev,\"\",@progbits\n");
+    emit(g, ".Ldebug_abbrev0:\n");
+    emit(g, "\t.uleb128 0x1\n");
+    emit(g, "\t.uleb128 0x11\n");
+    emit(g, "\t.byte\t0x1\n");
+    emit(g, "\t.byte\t0\n");
+  }
+  emit(g, "\t.ident\t\"neobolt_gen\"\n");
+  emit(g, "\t.section\t.note.GNU-stack,\"\",@progbits\n");
+}
+
+static bool parse_size(
+    const char* str,
+    u64* res)
+{
+  char* end;
+  unsigned long long v = strtoull(str, &end, 10);
+  if (end == str)
+    return false;
+  switch (*end) {
+    case 'k': case 'K': v <<= 10; ++end; break;
+    case 'm': case 'M': v <<= 20; ++end; break;
+    case 'g': case 'G': v <<= 30; ++end; break;
+    default: break;
+  }
+  if (*end != '\0')
+    return false;
+  *res = cast(u64, v);
+  return true;
+}
+
+static bool parse_num(
+    const char* str,
+    u32* res)
+{
+  char* end;
+  unsigned long v = strtoul(str, &end, 10);
+  if (end == str || *end != '\0' || v > UINT32_MAX)
+    return false;
+  *res = cast(u32, v);
+  return true;
+}
+
+static void print_help(
+    const char* progname)
+{
+  fprintf(stderr, "usage: %s [options]\n", progname);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "options:\n");
+  fprintf(stderr, "  -s N    PRNG seed (default 1)\n");
+  fprintf(stderr, "  -b SIZE approximate output size, with optional K/M/G suffix (default 1M)\n");
+  fprintf(stderr, "  -f N    exact function count, overrides -b\n");
+  fprintf(stderr, "  -l N    average labels per function (default 8)\n");
+  fprintf(stderr, "  -L PCT  .loc density, percent of instructions (default 60)\n");
+  fprintf(stderr, "  -F N    .file count (default 8)\n");
+  fprintf(stderr, "  -t PCT  functions with a jump table (default 10)\n");
+  fprintf(stderr, "  -c N    max depth of cross-referenced data labels (default 4)\n");
+  fprintf(stderr, "  -n PCT  blocks with numeric local labels (default 5)\n");
+  fprintf(stderr, "  -g      emit debug sections\n");
+  fprintf(stderr, "  -a      AT&T syntax\n");
+  fprintf(stderr, "  -o FILE output file (default stdout)\n");
+}
+
+int main(
+    int argc,
+    char** argv)
+{
+  Options o = {
+    .seed = 1,
+    .size = 1 << 20,
+    .labels = 8,
+    .loc_pct = 60,
+    .files = 8,
+    .table_pct = 10,
+    .chain = 4,
+    .local_pct = 5,
+  };
+  const char* out_path = NULL;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0')
+      goto invalid_option;
+
+    char opt = arg[1];
+    if (opt == 'h') {
+      print_help(argv[0]);
+      return 0;
+    } else if (opt == 'g') {
+      o.debug = true;
+      continue;
+    } else if (opt == 'a') {
+      o.att = true;
+      continue;
+    }
+
+    if (i + 1 >= argc)
+      goto invalid_option;
+    const char* val = argv[++i];
+    bool ok;
+    switch (opt) {
+      case 's': { u64 v; ok = parse_size(val, &v); o.seed = v; break; }
+      case 'b': ok = parse_size(val, &o.size); break;
+      case 'f': ok = parse_num(val, &o.funcs); break;
+      case 'l': ok = parse_num(val, &o.labels); break;
+      case 'L': ok = parse_num(val, &o.loc_pct); break;
+      case 'F': ok = parse_num(val, &o.files) && o.files > 0; break;
+      case 't': ok = parse_num(val, &o.table_pct); break;
+      case 'c': ok = parse_num(val, &o.chain); break;
+      case 'n': ok = parse_num(val, &o.local_pct); break;
+      case 'o': ok = true; out_path = val; break;
+      default: ok = false; break;
+    }
+    if (ok)
+      continue;
+
+invalid_option:
+    fprintf(stderr, "invalid argument: %s\n", arg);
+    print_help(argv[0]);
+    return 1;
+  }
+
+  FILE* out = stdout;
+  if (out_path != NULL) {
+    out = fopen(out_path, "wb");
+    if (out == NULL) {
+      perror(out_path);
+      return 1;
+    }
+  }
+  static char buf[1 << 20];
+  setvbuf(out, buf, _IOFBF, sizeof(buf));
+
+  Gen g = {
+    .out = out,
+    .opts = &o,
+    // xorshift state must not be zero
+    .rng = o.seed * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL,
+  };
+  if (g.rng == 0)
+    g.rng = 1;
+  generate(&g);
+
+  if (fclose(out) != 0) {
+    perror("fclose");
+    return 1;
+  }
+  return 0;
+}
+
+// vim: sw=2 sts=2 et
@@ -1,14 +1,73 @@
 #include "neobolt.c"
+#include "neobolt_profile.c"
+#include "neobolt_remarks.c"
+#include "neobolt_elf.c"
+#include "neobolt_diff.c"
+
+#include <errno.h>
 
 #include <lua.h>
 #include <lauxlib.h>
 
-static int lneobolt_parse(
-    lua_State* L)
+#if defined(__linux__)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+/// lib.parse options
+typedef struct {
+  bool trace; ///< Also return pass timestamps
+  bool cfg; ///< Also return basic blocks and loops
+  int uarch; ///< Also estimate block cycles on this microarchitecture, -1 for none
+  bool mix; ///< Also return instruction classes of every location
+  bool frames; ///< Also return stack frames, spills and reloads
+} ParseOptions;
+
+static ParseOptions check_parse_options(
+    lua_State* L,
+    int idx)
 {
-  usize size;
-  // TODO: accept array of strings too
-  const byte* data = cast(const byte*, luaL_checklstring(L, 1, &size));
+  ParseOptions opts = { .uarch = -1 };
+  if (!lua_isnoneornil(L, idx)) {
+    luaL_checktype(L, idx, LUA_TTABLE);
+    lua_getfield(L, idx, "trace");
+    opts.trace = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, idx, "cfg");
+    opts.cfg = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, idx, "frames");
+    opts.frames = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, idx, "mix");
+    opts.mix = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    lua_getfield(L, idx, "uarch");
+    if (!lua_isnil(L, -1)) {
+      const char* name = luaL_checkstring(L, -1);
+      for (int i = 0; i < kUarchCount; ++i)
+        if (strcmp(name, uarch_info[i].name) == 0)
+          opts.uarch = i;
+      if (opts.uarch < 0)
+        luaL_error(L, "unknown uarch: %s", name);
+      opts.cfg = true;
+    }
+    lua_pop(L, 1);
+  }
+  return opts;
+}
+
+/// Parse and push the result table, or nil and error message
+static int parse_push(
+    lua_State* L,
+    const byte* data,
+    usize size,
+    ParseOptions opts)
+{
+  const bool trace = opts.trace;
 
   State state;
 
@@ -17,6 +76,7 @@ static int lneobolt_parse(
     lua_pushstring(L, "libneobolt: invalid input");
     return 2;
   }
+  state.trace = trace;
 
   if (!neobolt_parse(&state)) {
     lua_pushnil(L);
@@ -24,7 +84,23 @@ static int lneobolt_parse(
     return 2;
   }
 
-  lua_createtable(L, 0, 5);
+  if (opts.cfg && !neobolt_cfg(&state)) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", state.exception.msg, state.exception.loc);
+    neobolt_destroy(&state);
+    return 2;
+  }
+  if (opts.uarch >= 0)
+    neobolt_costs(&state, cast(enum Uarch, opts.uarch));
+  if (opts.frames && !neobolt_frames(&state)) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", state.exception.msg, state.exception.loc);
+    neobolt_destroy(&state);
+    return 2;
+  }
+
+  lua_createtable(L, 0, 6 + (trace ? 1 : 0) + (opts.cfg ? 2 : 0) + (opts.mix ? 1 : 0)
+                        + (opts.frames ? 2 : 0));
 
   int line_count = 0;
 
@@ -52,6 +128,83 @@ static int lneobolt_parse(
     lua_setfield(L, -2, "lines");
   }
 
+  {
+    // one byte per line: label, instruction, directive, comment or unknown
+    static const char kinds[kLineTypeCount] = {
+      [kLineUnknown] = '?',
+      [kLineLabel] = 'l',
+      [kLineLocalLabel] = 'l',
+      [kLineData] = 'd',
+      [kLineDirective] = 'd',
+      [kLineInstruction] = 'i',
+      [kLineComment] = 'c',
+    };
+    luaL_Buffer buf;
+    luaL_buffinit(L, &buf);
+    for (u32 i = 0; i < state.lines.size; ++i) {
+      const Line* line = &state.lines.data[i];
+      if (line->flags & LINE_FLAG_SHOW)
+        luaL_addchar(&buf, kinds[line->type]);
+    }
+    luaL_pushresult(&buf);
+    lua_setfield(L, -2, "kinds");
+  }
+
+  if (opts.frames) {
+    // one byte per line: stack slot load, store, both, or space
+    static const char stack[4] = { ' ', 'l', 's', 'b' };
+    luaL_Buffer buf;
+    luaL_buffinit(L, &buf);
+    for (u32 i = 0; i < state.lines.size; ++i) {
+      const Line* line = &state.lines.data[i];
+      if (line->flags & LINE_FLAG_SHOW) {
+        u32 k = ((line->flags & LINE_FLAG_STACK_LOAD) ? 1u : 0u)
+              | ((line->flags & LINE_FLAG_STACK_STORE) ? 2u : 0u);
+        luaL_addchar(&buf, stack[k]);
+      }
+    }
+    luaL_pushresult(&buf);
+    lua_setfield(L, -2, "stack");
+
+    // array of { line, name, frame, spills, reloads, loop_spills }, line of the label
+    // or the first shown line after it
+    lua_createtable(L, cast(int, state.functions.size), 0);
+    int idx = 1;
+    for (u32 i = 0; i < state.functions.size; ++i) {
+      const Function* f = &state.functions.data[i];
+      u32 first = f->label;
+      while (first < f->last && !(state.lines.data[first].flags & LINE_FLAG_SHOW))
+        ++first;
+      if (!(state.lines.data[first].flags & LINE_FLAG_SHOW))
+        continue;
+
+      // name.off is a line number already, take the name from the label text
+      String text = STR(data, state.lines.data[f->label].line);
+      usize len = 0;
+      while (len < text.len && text.ptr[len] != ':')
+        ++len;
+      usize start = 0;
+      while (start < len && is_space(text.ptr[start]))
+        ++start;
+
+      lua_createtable(L, 6, 0);
+      lua_pushinteger(L, cast(lua_Integer, state.lines.data[first].name.off));
+      lua_rawseti(L, -2, 1);
+      lua_pushlstring(L, cast(const char*, text.ptr + start), len - start);
+      lua_rawseti(L, -2, 2);
+      lua_pushinteger(L, cast(lua_Integer, f->frame));
+      lua_rawseti(L, -2, 3);
+      lua_pushinteger(L, cast(lua_Integer, f->spills));
+      lua_rawseti(L, -2, 4);
+      lua_pushinteger(L, cast(lua_Integer, f->reloads));
+      lua_rawseti(L, -2, 5);
+      lua_pushinteger(L, cast(lua_Integer, f->loop_spills));
+      lua_rawseti(L, -2, 6);
+      lua_rawseti(L, -2, idx++);
+    }
+    lua_setfield(L, -2, "functions");
+  }
+
   {
     lua_createtable(L, line_count, 0);
     for (u32 i = 0; i < state.lines.size; ++i) {
@@ -128,6 +281,20 @@ static int lneobolt_parse(
     lua_setfield(L, -2, "locations");
   }
 
+  if (opts.mix) {
+    // flat array of instruction counts, kInstrClassCount per location, in the order
+    // of enum InstrClass: scalar, xmm, ymm, zmm, vector, memory, branch, call
+    lua_createtable(L, cast(int, state.loc.size * kInstrClassCount), 0);
+    int idx = 1;
+    for (u32 i = 0; i < state.loc.size; ++i) {
+      for (int k = 0; k < kInstrClassCount; ++k) {
+        lua_pushinteger(L, cast(lua_Integer, state.loc.mix[i].count[k]));
+        lua_rawseti(L, -2, idx++);
+      }
+    }
+    lua_setfield(L, -2, "mix");
+  }
+
   {
     lua_createtable(L, cast(int, state.files.size), 0);
     const byte* arena = state.arena.data;
@@ -141,18 +308,879 @@ static int lneobolt_parse(
     lua_setfield(L, -2, "files");
   }
 
+  if (opts.cfg) {
+    // quick hack, repurpose block line indices to store new line numbers.
+    // the first line can be a hidden label, the last one is always an instruction
+    for (u32 i = 0; i < state.blocks.size; ++i) {
+      Block* block = &state.blocks.data[i];
+      u32 first = block->first;
+      while (!(state.lines.data[first].flags & LINE_FLAG_SHOW))
+        ++first;
+      block->first = state.lines.data[first].name.off;
+      block->last = state.lines.data[block->last].name.off;
+    }
+
+    // array of { first, last, depth, loop }, loop is the innermost loop header block.
+    // with a uarch also { ..., cycles, unknown, loop_cycles }, see neobolt_costs
+    int backedges = 0;
+    lua_createtable(L, cast(int, state.blocks.size), 0);
+    for (u32 i = 0; i < state.blocks.size; ++i) {
+      const Block* block = &state.blocks.data[i];
+      if (block->flags & BLOCK_FLAG_BACK_FALL)
+        ++backedges;
+      if (block->flags & BLOCK_FLAG_BACK_JUMP)
+        ++backedges;
+
+      lua_createtable(L, opts.uarch >= 0 ? 7 : 4, 0);
+      lua_pushinteger(L, cast(lua_Integer, block->first));
+      lua_rawseti(L, -2, 1);
+      lua_pushinteger(L, cast(lua_Integer, block->last));
+      lua_rawseti(L, -2, 2);
+      lua_pushinteger(L, cast(lua_Integer, block->depth));
+      lua_rawseti(L, -2, 3);
+      lua_pushinteger(L, cast(lua_Integer, block->loop));
+      lua_rawseti(L, -2, 4);
+      if (opts.uarch >= 0) {
+        lua_pushnumber(L, block->cycles / 100.0);
+        lua_rawseti(L, -2, 5);
+        lua_pushinteger(L, cast(lua_Integer, block->unknown));
+        lua_rawseti(L, -2, 6);
+        lua_pushnumber(L, block->loop_cycles / 100.0);
+        lua_rawseti(L, -2, 7);
+      }
+      lua_rawseti(L, -2, cast(int, i + 1));
+    }
+    lua_setfield(L, -2, "blocks");
+
+    // array of { from, to } line numbers, from the branch to the loop header
+    lua_createtable(L, backedges, 0);
+    int idx = 1;
+    for (u32 i = 0; i < state.blocks.size; ++i) {
+      const Block* block = &state.blocks.data[i];
+      for (int k = 0; k < 2; ++k) {
+        if (!(block->flags & (k == 0 ? BLOCK_FLAG_BACK_FALL : BLOCK_FLAG_BACK_JUMP)))
+          continue;
+        const Block* header = &state.blocks.data[block->succ[k] - 1];
+        lua_createtable(L, 2, 0);
+        lua_pushinteger(L, cast(lua_Integer, block->last));
+        lua_rawseti(L, -2, 1);
+        lua_pushinteger(L, cast(lua_Integer, header->first));
+        lua_rawseti(L, -2, 2);
+        lua_rawseti(L, -2, idx++);
+      }
+    }
+    lua_setfield(L, -2, "backedges");
+  }
+
+  if (trace) {
+    // array of { name, start, duration }, in microseconds of CLOCK_MONOTONIC.
+    // same clock as uv.hrtime, so it can be merged with timestamps from lua.
+    static const char* const names[] = { "pass_1", "pass_2", "pass_3", "convert" };
+    u64 ts[5];
+    memcpy(ts, state.pass_ts, sizeof(state.pass_ts));
+    ts[4] = get_time();
+
+    lua_createtable(L, 4, 0);
+    for (int i = 0; i < 4; ++i) {
+      lua_createtable(L, 3, 0);
+      lua_pushstring(L, names[i]);
+      lua_rawseti(L, -2, 1);
+      lua_pushnumber(L, cast(lua_Number, ts[i]));
+      lua_rawseti(L, -2, 2);
+      lua_pushnumber(L, cast(lua_Number, ts[i + 1] - ts[i]));
+      lua_rawseti(L, -2, 3);
+      lua_rawseti(L, -2, i + 1);
+    }
+    lua_setfield(L, -2, "trace");
+  }
+
   neobolt_destroy(&state);
   return 1;
 }
 
+/// lib.parse(asm, opts?) -> result | nil, err
+static int lneobolt_parse(
+    lua_State* L)
+{
+  usize size;
+  // TODO: accept array of strings too
+  const byte* data = cast(const byte*, luaL_checklstring(L, 1, &size));
+  return parse_push(L, data, size, check_parse_options(L, 2));
+}
+
+#if defined(__linux__)
+
+/// lib.parse_fd(fd, opts?) -> result | nil, err. Parses the whole file, mapped into
+/// memory, so the input never becomes a Lua string. `result.bytes` is the input size.
+static int lneobolt_parse_fd(
+    lua_State* L)
+{
+  int fd = cast(int, luaL_checkinteger(L, 1));
+  ParseOptions opts = check_parse_options(L, 2);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: fstat: %s", strerror(errno));
+    return 2;
+  }
+  usize size = cast(usize, st.st_size);
+  if (size == 0)
+    return parse_push(L, NULL, 0, opts);
+
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: mmap: %s", strerror(errno));
+    return 2;
+  }
+  int ret = parse_push(L, data, size, opts);
+  munmap(data, size);
+
+  if (ret == 1) {
+    lua_pushinteger(L, cast(lua_Integer, size));
+    lua_setfield(L, -2, "bytes");
+  }
+  return ret;
+}
+
+/// lib.memfd() -> fd | nil, err. Anonymous in-memory file for compiler output,
+/// close-on-exec. Falls back to an unlinked file in /dev/shm.
+static int lneobolt_memfd(
+    lua_State* L)
+{
+#if defined(SYS_memfd_create)
+  int fd = cast(int, syscall(SYS_memfd_create, "neobolt", 1u /* MFD_CLOEXEC */));
+  if (fd >= 0) {
+    lua_pushinteger(L, fd);
+    return 1;
+  }
+#endif
+  char path[] = "/dev/shm/neobolt-XXXXXX";
+  int tmp = mkstemp(path);
+  if (tmp < 0) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: memfd: %s", strerror(errno));
+    return 2;
+  }
+  unlink(path);
+  fcntl(tmp, F_SETFD, FD_CLOEXEC);
+  lua_pushinteger(L, tmp);
+  return 1;
+}
+
+/// lib.close(fd)
+static int lneobolt_close(
+    lua_State* L)
+{
+  close(cast(int, luaL_checkinteger(L, 1)));
+  return 0;
+}
+
+#endif
+
+/// lib.hash(...) -> hex string. 64-bit hash of all string arguments, for cache keys.
+static int lneobolt_hash(
+    lua_State* L)
+{
+  int n = lua_gettop(L);
+  u64 hash = 0;
+  for (int i = 1; i <= n; ++i) {
+    usize len;
+    const byte* data = cast(const byte*, luaL_checklstring(L, i, &len));
+    hash = hash64(data, len, hash);
+  }
+
+  char hex[16];
+  for (int i = 0; i < 16; ++i)
+    hex[i] = "0123456789abcdef"[(hash >> (60 - 4 * i)) & 0xF];
+  lua_pushlstring(L, hex, sizeof(hex));
+  return 1;
+}
+
+#define GAPBUF_MT "neobolt.GapBuf"
+
+/// Gap buffer, for text edited in place. Edits near each other only move the bytes
+/// between them.
+typedef struct {
+  byte* data;
+  usize cap; ///< `data` allocation size
+  usize gap_start; ///< Byte offset of the gap
+  usize gap_end; ///< Byte offset past the gap
+} GapBuf;
+
+static usize gapbuf_len(
+    const GapBuf* self)
+{
+  return self->cap - (self->gap_end - self->gap_start);
+}
+
+/// Move the gap to logical offset `pos`
+static void gapbuf_move(
+    GapBuf* self,
+    usize pos)
+{
+  if (pos < self->gap_start) {
+    usize n = self->gap_start - pos;
+    memmove(&self->data[self->gap_end - n], &self->data[pos], n);
+    self->gap_start -= n;
+    self->gap_end -= n;
+  } else if (pos > self->gap_start) {
+    usize n = pos - self->gap_start;
+    memmove(&self->data[self->gap_start], &self->data[self->gap_end], n);
+    self->gap_start += n;
+    self->gap_end += n;
+  }
+}
+
+/// Make the gap at least `size` bytes
+static bool gapbuf_reserve(
+    GapBuf* self,
+    usize size)
+{
+  usize gap = self->gap_end - self->gap_start;
+  if (gap >= size)
+    return true;
+
+  usize len = gapbuf_len(self);
+  usize cap = MAX(self->cap * 2, len + size + 4096);
+  byte* data = malloc(cap);
+  if (data == NULL)
+    return false;
+
+  usize tail = self->cap - self->gap_end;
+  if (self->data != NULL) {
+    memcpy(data, self->data, self->gap_start);
+    memcpy(&data[cap - tail], &self->data[self->gap_end], tail);
+  }
+  free(self->data);
+  self->data = data;
+  self->gap_end = cap - tail;
+  self->cap = cap;
+  return true;
+}
+
+static GapBuf* check_gapbuf(
+    lua_State* L)
+{
+  return luaL_checkudata(L, 1, GAPBUF_MT);
+}
+
+/// gapbuf:replace(offset, old_len, text). Replace `old_len` bytes at 0-based `offset`.
+static int lgapbuf_replace(
+    lua_State* L)
+{
+  GapBuf* self = check_gapbuf(L);
+  lua_Integer off = luaL_checkinteger(L, 2);
+  lua_Integer old_len = luaL_checkinteger(L, 3);
+  usize text_len;
+  const char* text = luaL_checklstring(L, 4, &text_len);
+
+  usize len = gapbuf_len(self);
+  if (off < 0 || old_len < 0 || cast(usize, off) > len || cast(usize, old_len) > len - cast(usize, off))
+    return luaL_error(L, "gapbuf: range out of bounds");
+
+  gapbuf_move(self, cast(usize, off));
+  self->gap_end += cast(usize, old_len);
+  if (!gapbuf_reserve(self, text_len))
+    return luaL_error(L, "gapbuf: out of memory");
+  memcpy(&self->data[self->gap_start], text, text_len);
+  self->gap_start += text_len;
+  return 0;
+}
+
+/// gapbuf:set(text). Replace everything.
+static int lgapbuf_set(
+    lua_State* L)
+{
+  GapBuf* self = check_gapbuf(L);
+  usize text_len;
+  const char* text = luaL_checklstring(L, 2, &text_len);
+
+  self->gap_start = 0;
+  self->gap_end = self->cap;
+  if (!gapbuf_reserve(self, text_len))
+    return luaL_error(L, "gapbuf: out of memory");
+  memcpy(self->data, text, text_len);
+  self->gap_start = text_len;
+  return 0;
+}
+
+/// gapbuf:get() -> string. Whole text as one string.
+static int lgapbuf_get(
+    lua_State* L)
+{
+  GapBuf* self = check_gapbuf(L);
+  usize len = gapbuf_len(self);
+  // gap to the end, the text is contiguous then
+  gapbuf_move(self, len);
+  lua_pushlstring(L, self->data != NULL ? cast(const char*, self->data) : "", len);
+  return 1;
+}
+
+static int lgapbuf_len(
+    lua_State* L)
+{
+  GapBuf* self = check_gapbuf(L);
+  lua_pushinteger(L, cast(lua_Integer, gapbuf_len(self)));
+  return 1;
+}
+
+static int lgapbuf_gc(
+    lua_State* L)
+{
+  GapBuf* self = check_gapbuf(L);
+  FREE(self->data);
+  self->cap = self->gap_start = self->gap_end = 0;
+  return 0;
+}
+
+/// lib.gapbuf(text?) -> gapbuf
+static int lneobolt_gapbuf(
+    lua_State* L)
+{
+  GapBuf* self = lua_newuserdata(L, sizeof(GapBuf));
+  *self = (GapBuf){0};
+  if (luaL_newmetatable(L, GAPBUF_MT)) {
+    static const luaL_Reg methods[] = {
+      { "replace", lgapbuf_replace },
+      { "set", lgapbuf_set },
+      { "get", lgapbuf_get },
+      { "len", lgapbuf_len },
+      { NULL, NULL },
+    };
+    lua_createtable(L, 0, 4);
+    for (const luaL_Reg* m = methods; m->name != NULL; ++m) {
+      lua_pushcfunction(L, m->func);
+      lua_setfield(L, -2, m->name);
+    }
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, lgapbuf_gc);
+    lua_setfield(L, -2, "__gc");
+  }
+  lua_setmetatable(L, -2);
+
+  if (!lua_isnoneornil(L, 1)) {
+    usize text_len;
+    const char* text = luaL_checklstring(L, 1, &text_len);
+    if (!gapbuf_reserve(self, text_len))
+      return luaL_error(L, "gapbuf: out of memory");
+    memcpy(self->data, text, text_len);
+    self->gap_start = text_len;
+  }
+  return 1;
+}
+
+/// lib.profile_load(path) -> string | nil, err. Reads a `perf annotate --stdio` or
+/// `perf script` dump, and returns the samples in compact form for lib.profile. Blocks
+/// for as long as reading the dump takes, meant for a worker thread.
+static int lneobolt_profile_load(
+    lua_State* L)
+{
+  const char* path = luaL_checkstring(L, 1);
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "%s: %s", path, strerror(errno));
+    return 2;
+  }
+
+  Profile profile;
+  neobolt_profile_init(&profile);
+  byte* data = NULL;
+  usize len = 0;
+  bool ok = neobolt_profile_load(&profile, file) && neobolt_profile_save(&profile, &data, &len);
+  fclose(file);
+  if (!ok) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", profile.exception.msg, profile.exception.loc);
+  } else {
+    lua_pushlstring(L, cast(const char*, data), len);
+  }
+  free(data);
+  neobolt_profile_destroy(&profile);
+  return ok ? 1 : 2;
+}
+
+#define PROFILE_MT "neobolt.Profile"
+
+static Profile* check_profile(
+    lua_State* L)
+{
+  return luaL_checkudata(L, 1, PROFILE_MT);
+}
+
+/// profile:match(lines, kinds) -> result | nil, err. Samples of asm lines, `lines` and
+/// `kinds` like in a lib.parse result. Percentages are of all samples in the dump:
+/// { total = samples, lines = { [lnum] = percent }, functions = { { lnum, percent,
+/// unmatched percent } } }, functions only have their label line.
+static int lprofile_match(
+    lua_State* L)
+{
+  Profile* self = check_profile(L);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  usize kinds_len;
+  const byte* kinds = cast(const byte*, luaL_checklstring(L, 3, &kinds_len));
+  u32 count = cast(u32, MIN(kinds_len, lua_objlen(L, 2)));
+
+  String* lines = malloc(MAX(count, 1u) * sizeof(*lines));
+  ProfileHit* hits = malloc(MAX(count, 1u) * sizeof(*hits));
+  if (lines == NULL || hits == NULL) {
+    free(lines);
+    free(hits);
+    return luaL_error(L, "profile: out of memory");
+  }
+  // strings stay referenced by the table while this runs
+  for (u32 i = 0; i < count; ++i) {
+    lua_rawgeti(L, 2, cast(int, i + 1));
+    usize len = 0;
+    const char* text = lua_tolstring(L, -1, &len);
+    lines[i] = (String){ cast(const byte*, text != NULL ? text : ""), text != NULL ? len : 0 };
+    lua_pop(L, 1);
+  }
+
+  if (!neobolt_profile_match(self, lines, kinds, count, hits)) {
+    free(lines);
+    free(hits);
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", self->exception.msg, self->exception.loc);
+    return 2;
+  }
+
+  double total = cast(double, MAX(self->total, 1u));
+  lua_createtable(L, 0, 3);
+  lua_pushnumber(L, cast(double, self->total) / 1000.0);
+  lua_setfield(L, -2, "total");
+
+  lua_createtable(L, 0, 0);
+  for (u32 i = 0; i < count; ++i) {
+    if (kinds[i] == 'i' && hits[i].samples > 0) {
+      lua_pushnumber(L, cast(double, hits[i].samples) * 100.0 / total);
+      lua_rawseti(L, -2, cast(int, i + 1));
+    }
+  }
+  lua_setfield(L, -2, "lines");
+
+  lua_createtable(L, 0, 0);
+  int idx = 1;
+  for (u32 i = 0; i < count; ++i) {
+    if (!hits[i].found)
+      continue;
+    lua_createtable(L, 3, 0);
+    lua_pushinteger(L, cast(lua_Integer, i + 1));
+    lua_rawseti(L, -2, 1);
+    lua_pushnumber(L, cast(double, hits[i].samples) * 100.0 / total);
+    lua_rawseti(L, -2, 2);
+    lua_pushnumber(L, cast(double, hits[i].unmatched) * 100.0 / total);
+    lua_rawseti(L, -2, 3);
+    lua_rawseti(L, -2, idx++);
+  }
+  lua_setfield(L, -2, "functions");
+
+  free(lines);
+  free(hits);
+  return 1;
+}
+
+static int lprofile_gc(
+    lua_State* L)
+{
+  Profile* self = check_profile(L);
+  neobolt_profile_destroy(self);
+  neobolt_profile_init(self);
+  return 0;
+}
+
+/// lib.profile(data) -> profile | nil, err. Profile from lib.profile_load, ready for
+/// matching against asm
+static int lneobolt_profile(
+    lua_State* L)
+{
+  usize len;
+  const byte* data = cast(const byte*, luaL_checklstring(L, 1, &len));
+
+  Profile* self = lua_newuserdata(L, sizeof(Profile));
+  neobolt_profile_init(self);
+  if (luaL_newmetatable(L, PROFILE_MT)) {
+    lua_createtable(L, 0, 1);
+    lua_pushcfunction(L, lprofile_match);
+    lua_setfield(L, -2, "match");
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, lprofile_gc);
+    lua_setfield(L, -2, "__gc");
+  }
+  lua_setmetatable(L, -2);
+
+  if (!neobolt_profile_read(self, (String){ data, len })) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: invalid profile (%s)", self->exception.loc);
+    return 2;
+  }
+  return 1;
+}
+
+/// lib.remarks_load(path, file?, kinds?) -> string | nil, err. Reads a clang YAML
+/// optimization record or gcc -fopt-info output, keeping remarks of `file` only when
+/// given, and of `kinds`, a string with `p` for passed, `m` for missed and `a` for
+/// analysis remarks, all by default. Returns them in compact form for lib.remarks.
+/// Blocks for as long as reading takes, meant for a worker thread.
+static int lneobolt_remarks_load(
+    lua_State* L)
+{
+  const char* path = luaL_checkstring(L, 1);
+  usize file_len = 0;
+  const char* file_name = luaL_optlstring(L, 2, "", &file_len);
+  const char* kind_names = luaL_optstring(L, 3, "pma");
+  u8 kinds = 0;
+  for (const char* k = kind_names; *k != '\0'; ++k) {
+    if (*k == 'p')
+      kinds |= 1u << kRemarkPassed;
+    else if (*k == 'm')
+      kinds |= 1u << kRemarkMissed;
+    else if (*k == 'a')
+      kinds |= 1u << kRemarkAnalysis;
+  }
+
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "%s: %s", path, strerror(errno));
+    return 2;
+  }
+
+  Remarks remarks;
+  neobolt_remarks_init(&remarks, (String){ cast(const byte*, file_name), file_len }, kinds);
+  byte* data = NULL;
+  usize len = 0;
+  bool ok = neobolt_remarks_load(&remarks, file) && neobolt_remarks_save(&remarks, &data, &len);
+  fclose(file);
+  if (!ok) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", remarks.exception.msg, remarks.exception.loc);
+  } else {
+    lua_pushlstring(L, cast(const char*, data), len);
+  }
+  free(data);
+  neobolt_remarks_destroy(&remarks);
+  return ok ? 1 : 2;
+}
+
+static void push_remark_string(
+    lua_State* L,
+    const Remarks* remarks,
+    StrRef str,
+    int idx)
+{
+  lua_pushlstring(L, cast(const char*, remarks->text.data + str.off), str.len);
+  lua_rawseti(L, -2, idx);
+}
+
+/// lib.remarks(data) -> remarks | nil, err. Remarks from lib.remarks_load, sorted by
+/// file, line and column: { { line, col, kind, file, pass, function, message } }, kind
+/// is 'passed', 'missed' or 'analysis'. col is 0 when unknown, pass and function are
+/// empty for gcc.
+static int lneobolt_remarks(
+    lua_State* L)
+{
+  usize len;
+  const byte* data = cast(const byte*, luaL_checklstring(L, 1, &len));
+
+  Remarks remarks;
+  neobolt_remarks_init(&remarks, (String){ NULL, 0 }, (1u << kRemarkKindCount) - 1);
+  if (!neobolt_remarks_read(&remarks, (String){ data, len })) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: invalid remarks (%s)", remarks.exception.loc);
+    neobolt_remarks_destroy(&remarks);
+    return 2;
+  }
+
+  lua_createtable(L, cast(int, remarks.size), 0);
+  for (u32 i = 0; i < remarks.size; ++i) {
+    const Remark* remark = &remarks.data[i];
+    lua_createtable(L, 7, 0);
+    lua_pushinteger(L, cast(lua_Integer, remark->line));
+    lua_rawseti(L, -2, 1);
+    lua_pushinteger(L, cast(lua_Integer, remark->col));
+    lua_rawseti(L, -2, 2);
+    lua_pushstring(L, remark_kind_names[remark->kind]);
+    lua_rawseti(L, -2, 3);
+    push_remark_string(L, &remarks, remark->file, 4);
+    push_remark_string(L, &remarks, remark->pass, 5);
+    push_remark_string(L, &remarks, remark->function, 6);
+    push_remark_string(L, &remarks, remark->message, 7);
+    lua_rawseti(L, -2, cast(int, i + 1));
+  }
+  neobolt_remarks_destroy(&remarks);
+  return 1;
+}
+
+static int elf_push(
+    lua_State* L,
+    String data)
+{
+  Elf elf;
+  neobolt_elf_init(&elf);
+  if (!neobolt_elf_read(&elf, data)) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", elf.exception.msg, elf.exception.loc);
+    neobolt_elf_destroy(&elf);
+    return 2;
+  }
+
+  int count = cast(int, lua_objlen(L, 2));
+  lua_createtable(L, count, 0);
+  for (int i = 1; i <= count; ++i) {
+    lua_rawgeti(L, 2, i);
+    usize len = 0;
+    const char* name = lua_tolstring(L, -1, &len);
+    const ElfSymbol* sym = name != NULL ? neobolt_elf_find(&elf, (String){ cast(const byte*, name), len }) : NULL;
+    lua_pop(L, 1);
+    if (sym == NULL) {
+      lua_pushboolean(L, 0);
+    } else {
+      lua_createtable(L, 3, 0);
+      lua_pushnumber(L, cast(double, sym->offset));
+      lua_rawseti(L, -2, 1);
+      lua_pushnumber(L, cast(double, sym->size));
+      lua_rawseti(L, -2, 2);
+      lua_pushnumber(L, cast(double, sym->align));
+      lua_rawseti(L, -2, 3);
+    }
+    lua_rawseti(L, -2, i);
+  }
+  neobolt_elf_destroy(&elf);
+  return 1;
+}
+
+/// lib.elf(object, names) -> symbols | nil, err. Code symbols of an ELF64 object, a
+/// string or (Linux) a file descriptor, by name: { { offset, size, section alignment }
+/// or false } in the order of `names`. Offsets are in the symbol's section.
+static int lneobolt_elf(
+    lua_State* L)
+{
+  luaL_checktype(L, 2, LUA_TTABLE);
+#if defined(__linux__)
+  if (lua_type(L, 1) == LUA_TNUMBER) {
+    int fd = cast(int, lua_tointeger(L, 1));
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "libneobolt: fstat: %s", strerror(errno));
+      return 2;
+    }
+    usize size = cast(usize, st.st_size);
+    if (size == 0)
+      return elf_push(L, (String){ cast(const byte*, ""), 0 });
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      lua_pushnil(L);
+      lua_pushfstring(L, "libneobolt: mmap: %s", strerror(errno));
+      return 2;
+    }
+    int ret = elf_push(L, (String){ data, size });
+    munmap(data, size);
+    return ret;
+  }
+#endif
+  usize len;
+  const byte* data = cast(const byte*, luaL_checklstring(L, 1, &len));
+  return elf_push(L, (String){ data, len });
+}
+
+/// Lines, kinds and source locations of the lib.parse result at `idx`. Line strings
+/// stay referenced by its table. `lines` and `locs` are allocated, free them after.
+static bool check_diff_side(
+    lua_State* L,
+    int idx,
+    DiffSide* side,
+    String** lines,
+    u32** locs)
+{
+  *lines = NULL;
+  *locs = NULL;
+  if (lua_type(L, idx) != LUA_TTABLE)
+    return false;
+  lua_getfield(L, idx, "lines");
+  lua_getfield(L, idx, "kinds");
+  if (lua_type(L, -2) != LUA_TTABLE || lua_type(L, -1) != LUA_TSTRING) {
+    lua_pop(L, 2);
+    return false;
+  }
+  usize kinds_len;
+  side->kinds = cast(const byte*, lua_tolstring(L, -1, &kinds_len));
+  side->count = cast(u32, MIN(kinds_len, lua_objlen(L, -2)));
+  *lines = malloc(MAX(side->count, 1u) * sizeof(**lines));
+  *locs = calloc(MAX(side->count, 1u), sizeof(**locs));
+  if (*lines == NULL || *locs == NULL) {
+    lua_pop(L, 2);
+    return false;
+  }
+  for (u32 i = 0; i < side->count; ++i) {
+    lua_rawgeti(L, -2, cast(int, i + 1));
+    usize len = 0;
+    const char* text = lua_tolstring(L, -1, &len);
+    (*lines)[i] = (String){ cast(const byte*, text != NULL ? text : ""), text != NULL ? len : 0 };
+    lua_pop(L, 1);
+  }
+  lua_pop(L, 2);
+  side->lines = *lines;
+  side->locs = *locs;
+
+  // ranges of lines and their locations, files are paths or indices into `files`
+  lua_getfield(L, idx, "location_ranges");
+  lua_getfield(L, idx, "locations");
+  lua_getfield(L, idx, "files");
+  if (lua_type(L, -3) == LUA_TTABLE && lua_type(L, -2) == LUA_TTABLE) {
+    int count = cast(int, lua_objlen(L, -3));
+    for (int r = 1; r <= count; ++r) {
+      lua_rawgeti(L, -3, r);
+      lua_rawgeti(L, -3, r);
+      if (lua_type(L, -2) != LUA_TTABLE || lua_type(L, -1) != LUA_TTABLE) {
+        lua_pop(L, 2);
+        continue;
+      }
+      lua_rawgeti(L, -2, 1);
+      lua_rawgeti(L, -3, 2);
+      lua_Integer first = lua_tointeger(L, -2), last = lua_tointeger(L, -1);
+      lua_pop(L, 2);
+      lua_rawgeti(L, -1, 1);
+      if (lua_type(L, -1) == LUA_TNUMBER && lua_type(L, -4) == LUA_TTABLE) {
+        lua_Integer file = lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        lua_rawgeti(L, -3, cast(int, file));
+      }
+      lua_rawgeti(L, -2, 2);
+      usize file_len = 0;
+      const char* file = lua_type(L, -2) == LUA_TSTRING ? lua_tolstring(L, -2, &file_len) : NULL;
+      u32 line = cast(u32, lua_tointeger(L, -1));
+      lua_pop(L, 4);
+      if (file == NULL)
+        continue;
+      u32 key = neobolt_diff_loc((String){ cast(const byte*, file), file_len }, line);
+      for (lua_Integer l = MAX(first, 1); l <= last && l <= cast(lua_Integer, side->count); ++l)
+        (*locs)[l - 1] = key;
+    }
+  }
+  lua_pop(L, 3);
+  return true;
+}
+
+/// lib.diff(a, b) -> diff | nil, err. Codegen diff of two lib.parse results of the same
+/// source: { ops = string, a = { lnum }, b = { lnum }, functions = { { name, row,
+/// a instructions, b instructions, removed, added } } } with one row per op, `=` for
+/// the same line, `~` changed, `-` only in `a` and `+` only in `b`. Line numbers are
+/// 1-based, zero on filler rows, function rows are 1-based rows of their label.
+static int lneobolt_diff(
+    lua_State* L)
+{
+  DiffSide a, b;
+  String *a_lines, *b_lines;
+  u32 *a_locs, *b_locs;
+  bool ok_a = check_diff_side(L, 1, &a, &a_lines, &a_locs);
+  bool ok_b = ok_a && check_diff_side(L, 2, &b, &b_lines, &b_locs);
+  if (!ok_b) {
+    free(a_lines);
+    free(a_locs);
+    if (ok_a) {
+      free(b_lines);
+      free(b_locs);
+    }
+    lua_pushnil(L);
+    lua_pushstring(L, "libneobolt: diff: expected two lib.parse results");
+    return 2;
+  }
+
+  Diff diff;
+  neobolt_diff_init(&diff);
+  bool ok = neobolt_diff(&diff, &a, &b);
+  free(a_lines);
+  free(a_locs);
+  free(b_lines);
+  free(b_locs);
+  if (!ok) {
+    lua_pushnil(L);
+    lua_pushfstring(L, "libneobolt: %s (%s)", diff.exception.msg, diff.exception.loc);
+    neobolt_diff_destroy(&diff);
+    return 2;
+  }
+
+  lua_createtable(L, 0, 4);
+  luaL_Buffer buf;
+  luaL_buffinit(L, &buf);
+  for (u32 i = 0; i < diff.rows_size; ++i)
+    luaL_addchar(&buf, diff_op_chars[diff.rows[i].op]);
+  luaL_pushresult(&buf);
+  lua_setfield(L, -2, "ops");
+
+  lua_createtable(L, cast(int, diff.rows_size), 0);
+  for (u32 i = 0; i < diff.rows_size; ++i) {
+    lua_pushinteger(L, cast(lua_Integer, diff.rows[i].a));
+    lua_rawseti(L, -2, cast(int, i + 1));
+  }
+  lua_setfield(L, -2, "a");
+  lua_createtable(L, cast(int, diff.rows_size), 0);
+  for (u32 i = 0; i < diff.rows_size; ++i) {
+    lua_pushinteger(L, cast(lua_Integer, diff.rows[i].b));
+    lua_rawseti(L, -2, cast(int, i + 1));
+  }
+  lua_setfield(L, -2, "b");
+
+  lua_createtable(L, cast(int, diff.functions_size), 0);
+  for (u32 i = 0; i < diff.functions_size; ++i) {
+    const DiffFunction* f = &diff.functions[i];
+    lua_createtable(L, 6, 0);
+    lua_pushlstring(L, cast(const char*, f->name.ptr), f->name.len);
+    lua_rawseti(L, -2, 1);
+    lua_pushinteger(L, cast(lua_Integer, f->row + 1));
+    lua_rawseti(L, -2, 2);
+    lua_pushinteger(L, cast(lua_Integer, f->a_insns));
+    lua_rawseti(L, -2, 3);
+    lua_pushinteger(L, cast(lua_Integer, f->b_insns));
+    lua_rawseti(L, -2, 4);
+    lua_pushinteger(L, cast(lua_Integer, f->removed));
+    lua_rawseti(L, -2, 5);
+    lua_pushinteger(L, cast(lua_Integer, f->added));
+    lua_rawseti(L, -2, 6);
+    lua_rawseti(L, -2, cast(int, i + 1));
+  }
+  lua_setfield(L, -2, "functions");
+
+  neobolt_diff_destroy(&diff);
+  return 1;
+}
+
 EXPORT int luaopen_libneobolt(
     lua_State* L)
 {
-  lua_createtable(L, 0, 2);
+  lua_createtable(L, 0, 13);
 
   lua_pushcfunction(L, lneobolt_parse);
   lua_setfield(L, -2, "parse");
-  lua_pushinteger(L, 0);
+#if defined(__linux__)
+  lua_pushcfunction(L, lneobolt_parse_fd);
+  lua_setfield(L, -2, "parse_fd");
+  lua_pushcfunction(L, lneobolt_memfd);
+  lua_setfield(L, -2, "memfd");
+  lua_pushcfunction(L, lneobolt_close);
+  lua_setfield(L, -2, "close");
+#endif
+  lua_pushcfunction(L, lneobolt_hash);
+  lua_setfield(L, -2, "hash");
+  lua_pushcfunction(L, lneobolt_gapbuf);
+  lua_setfield(L, -2, "gapbuf");
+  lua_pushcfunction(L, lneobolt_profile_load);
+  lua_setfield(L, -2, "profile_load");
+  lua_pushcfunction(L, lneobolt_profile);
+  lua_setfield(L, -2, "profile");
+  lua_pushcfunction(L, lneobolt_remarks_load);
+  lua_setfield(L, -2, "remarks_load");
+  lua_pushcfunction(L, lneobolt_remarks);
+  lua_setfield(L, -2, "remarks");
+  lua_pushcfunction(L, lneobolt_elf);
+  lua_setfield(L, -2, "elf");
+  lua_pushcfunction(L, lneobolt_diff);
+  lua_setfield(L, -2, "diff");
+  lua_pushinteger(L, 1);
   lua_setfield(L, -2, "VERSION");
 
   return 1;
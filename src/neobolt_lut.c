@@ -0,0 +1,397 @@
+// Perfect hash generator for keyword tables that are too big for gperf's character
+// sums, like instruction mnemonics that only differ late in the name. Input lines are
+// `name, initializer`, and `#` starts a comment line. Output is a C header with a
+// hash-and-displace table, and a lookup function that returns a pointer to the
+// matching `struct <type>` or NULL. The struct's first field is `const char* name`.
+//
+//   neobolt_lut -t InstrCost -f instr_cost -o src/instr_costs.h src/instr_costs.txt
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint32_t u32;
+
+#define cast(T, ...) ((T)(__VA_ARGS__))
+
+#define MAX_KEYS 4096
+#define MAX_LINE 1024
+
+typedef struct {
+  char* name;
+  char* init; ///< Initializer of the fields after the name
+  u32 len;
+  u32 hash;
+} Key;
+
+typedef struct {
+  Key keys[MAX_KEYS];
+  u32 count;
+  u32 max_len;
+  u32 min_len;
+} Table;
+
+static u32 key_hash(
+    const char* str,
+    u32 len,
+    u32 seed)
+{
+  u32 hash = 0x811C9DC5 ^ seed;
+  for (u32 i = 0; i < len; ++i)
+    hash = (hash ^ cast(u32, cast(unsigned char, str[i]))) * 0x01000193;
+  return hash;
+}
+
+static u32 slot_of(
+    u32 hash,
+    u32 displace,
+    u32 mask)
+{
+  u32 x = hash ^ displace;
+  x ^= x >> 15;
+  x *= 0x2C1B3C6D;
+  x ^= x >> 12;
+  return x & mask;
+}
+
+static u32 nextpow2(
+    u32 n)
+{
+  u32 r = 1;
+  while (r < n)
+    r <<= 1;
+  return r;
+}
+
+static u32 log2u(
+    u32 n)
+{
+  u32 r = 0;
+  while ((1u << r) < n)
+    ++r;
+  return r;
+}
+
+static void trim(
+    char** s)
+{
+  while (**s == ' ' || **s == '\t')
+    ++*s;
+  char* end = *s + strlen(*s);
+  while (end > *s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r'))
+    *--end = '\0';
+}
+
+static void read_table(
+    FILE* in,
+    Table* t)
+{
+  char line[MAX_LINE];
+  t->min_len = UINT32_MAX;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    char* p = line;
+    trim(&p);
+    if (*p == '\0' || *p == '#')
+      continue;
+    char* comma = strchr(p, ',');
+    if (comma == NULL) {
+      fprintf(stderr, "neobolt_lut: missing initializer: %s\n", p);
+      exit(1);
+    }
+    *comma = '\0';
+    char* init = comma + 1;
+    trim(&p);
+    trim(&init);
+
+    if (t->count == MAX_KEYS) {
+      fprintf(stderr, "neobolt_lut: too many keys\n");
+      exit(1);
+    }
+    Key* key = &t->keys[t->count++];
+    key->name = strdup(p);
+    key->init = strdup(init);
+    key->len = cast(u32, strlen(p));
+    if (key->len > t->max_len)
+      t->max_len = key->len;
+    if (key->len < t->min_len)
+      t->min_len = key->len;
+    for (u32 i = 0; i + 1 < t->count; ++i) {
+      if (strcmp(t->keys[i].name, p) == 0) {
+        fprintf(stderr, "neobolt_lut: duplicate key: %s\n", p);
+        exit(1);
+      }
+    }
+  }
+}
+
+/// Find a displacement per bucket, so every key gets its own slot. Larger buckets
+/// are placed first, while most slots are still free.
+static bool build(
+    Table* t,
+    u32 seed,
+    u32 bucket_bits,
+    u32 slot_count,
+    u32* displace,
+    int* slots)
+{
+  const u32 bucket_count = 1u << bucket_bits;
+  for (u32 i = 0; i < t->count; ++i)
+    t->keys[i].hash = key_hash(t->keys[i].name, t->keys[i].len, seed);
+  for (u32 i = 0; i < t->count; ++i)
+    for (u32 j = i + 1; j < t->count; ++j)
+      if (t->keys[i].hash == t->keys[j].hash)
+        return false;
+
+  u32* sizes = calloc(bucket_count, sizeof(u32));
+  u32* order = malloc(bucket_count * sizeof(u32));
+  for (u32 i = 0; i < t->count; ++i)
+    sizes[t->keys[i].hash >> (32 - bucket_bits)] += 1;
+  for (u32 b = 0; b < bucket_count; ++b)
+    order[b] = b;
+  for (u32 i = 1; i < bucket_count; ++i) { // insertion sort, by size descending
+    u32 b = order[i];
+    u32 j = i;
+    while (j > 0 && sizes[order[j - 1]] < sizes[b]) {
+      order[j] = order[j - 1];
+      --j;
+    }
+    order[j] = b;
+  }
+
+  for (u32 s = 0; s < slot_count; ++s)
+    slots[s] = -1;
+
+  bool ok = true;
+  u32 members[64];
+  u32 taken[64];
+  for (u32 o = 0; o < bucket_count && ok; ++o) {
+    u32 b = order[o];
+    displace[b] = 0;
+    if (sizes[b] == 0)
+      continue;
+    if (sizes[b] > 64) {
+      ok = false;
+      break;
+    }
+    u32 n = 0;
+    for (u32 i = 0; i < t->count; ++i)
+      if (t->keys[i].hash >> (32 - bucket_bits) == b)
+        members[n++] = i;
+
+    bool placed = false;
+    for (u32 d = 0; d < 0x10000 && !placed; ++d) {
+      placed = true;
+      for (u32 k = 0; k < n && placed; ++k) {
+        u32 slot = slot_of(t->keys[members[k]].hash, d, slot_count - 1);
+        if (slots[slot] != -1)
+          placed = false;
+        for (u32 m = 0; m < k && placed; ++m)
+          if (taken[m] == slot)
+            placed = false;
+        taken[k] = slot;
+      }
+      if (placed) {
+        displace[b] = d;
+        for (u32 k = 0; k < n; ++k)
+          slots[taken[k]] = cast(int, members[k]);
+      }
+    }
+    ok = placed;
+  }
+
+  free(sizes);
+  free(order);
+  return ok;
+}
+
+static void write_header(
+    FILE* out,
+    const Table* t,
+    const char* type,
+    const char* prefix,
+    const char* macro,
+    const char* input,
+    u32 seed,
+    u32 bucket_bits,
+    u32 slot_count,
+    const u32* displace,
+    const int* slots)
+{
+  const u32 bucket_count = 1u << bucket_bits;
+
+  fprintf(out, "/* Generated by neobolt_lut from %s, do not edit. */\n", input);
+  fprintf(out, "/* Run `make lut` to regenerate it. */\n");
+  fprintf(out, "\n");
+  fprintf(out, "#define %s_TOTAL_KEYWORDS %u\n", macro, t->count);
+  fprintf(out, "#define %s_MIN_WORD_LENGTH %u\n", macro, t->min_len);
+  fprintf(out, "#define %s_MAX_WORD_LENGTH %u\n", macro, t->max_len);
+  fprintf(out, "#define %s_TABLE_SIZE %u\n", macro, slot_count);
+  fprintf(out, "\n");
+
+  fprintf(out, "static unsigned int\n");
+  fprintf(out, "%s_hash (const char *str, size_t len)\n", prefix);
+  fprintf(out, "{\n");
+  fprintf(out, "  static const unsigned short displace[] =\n");
+  fprintf(out, "    {");
+  for (u32 b = 0; b < bucket_count; ++b) {
+    if (b % 10 == 0)
+      fprintf(out, "\n     ");
+    fprintf(out, " %5u%s", displace[b], b + 1 < bucket_count ? "," : "");
+  }
+  fprintf(out, "\n    };\n");
+  fprintf(out, "  unsigned int hash = 0x%08Xu;\n", 0x811C9DC5 ^ seed);
+  fprintf(out, "  for (size_t i = 0; i < len; ++i)\n");
+  fprintf(out, "    hash = (hash ^ (unsigned char)str[i]) * 0x01000193u;\n");
+  fprintf(out, "\n");
+  fprintf(out, "  unsigned int x = hash ^ displace[hash >> %u];\n", 32 - bucket_bits);
+  fprintf(out, "  x ^= x >> 15;\n");
+  fprintf(out, "  x *= 0x2C1B3C6Du;\n");
+  fprintf(out, "  x ^= x >> 12;\n");
+  fprintf(out, "  return x & %uu;\n", slot_count - 1);
+  fprintf(out, "}\n");
+  fprintf(out, "\n");
+
+  fprintf(out, "static const struct %s *\n", type);
+  fprintf(out, "%s_lookup (const char *str, size_t len)\n", prefix);
+  fprintf(out, "{\n");
+  fprintf(out, "  static const unsigned char lengthtable[] =\n");
+  fprintf(out, "    {");
+  for (u32 s = 0; s < slot_count; ++s) {
+    if (s % 14 == 0)
+      fprintf(out, "\n     ");
+    fprintf(out, " %2u%s", slots[s] < 0 ? 0 : t->keys[slots[s]].len, s + 1 < slot_count ? "," : "");
+  }
+  fprintf(out, "\n    };\n");
+  fprintf(out, "  static const struct %s wordlist[] =\n", type);
+  fprintf(out, "    {\n");
+  u32 empty = 0;
+  for (u32 s = 0; s < slot_count; ++s) {
+    if (slots[s] < 0) {
+      ++empty;
+      if (empty == 8 || s + 1 == slot_count || slots[s + 1] >= 0) {
+        fprintf(out, "     ");
+        for (u32 e = 0; e < empty; ++e)
+          fprintf(out, " {\"\"}%s", s + 1 < slot_count || e + 1 < empty ? "," : "");
+        fprintf(out, "\n");
+        empty = 0;
+      }
+      continue;
+    }
+    const Key* key = &t->keys[slots[s]];
+    fprintf(out, "      {\"%s\", %s}%s\n", key->name, key->init, s + 1 < slot_count ? "," : "");
+  }
+  fprintf(out, "    };\n");
+  fprintf(out, "\n");
+  fprintf(out, "  if (len <= %s_MAX_WORD_LENGTH && len >= %s_MIN_WORD_LENGTH)\n", macro, macro);
+  fprintf(out, "    {\n");
+  fprintf(out, "      unsigned int key = %s_hash (str, len);\n", prefix);
+  fprintf(out, "\n");
+  fprintf(out, "      if (len == lengthtable[key])\n");
+  fprintf(out, "        {\n");
+  fprintf(out, "          const char *s = wordlist[key].name;\n");
+  fprintf(out, "\n");
+  fprintf(out, "          if (*str == *s && !memcmp (str + 1, s + 1, len - 1))\n");
+  fprintf(out, "            return &wordlist[key];\n");
+  fprintf(out, "        }\n");
+  fprintf(out, "    }\n");
+  fprintf(out, "  return 0;\n");
+  fprintf(out, "}\n");
+}
+
+static void print_help(
+    const char* progname)
+{
+  fprintf(stderr, "usage: %s -t type -f prefix [-o output] input\n", progname);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "options:\n");
+  fprintf(stderr, "  -t  struct name of the table entries\n");
+  fprintf(stderr, "  -f  prefix of the generated functions, <prefix>_lookup and <prefix>_hash\n");
+  fprintf(stderr, "  -o  output file, default is stdout\n");
+}
+
+int main(
+    int argc,
+    char** argv)
+{
+  const char* type = NULL;
+  const char* prefix = NULL;
+  const char* output = NULL;
+  const char* input = NULL;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "-h") == 0) {
+      print_help(argv[0]);
+      return 0;
+    } else if (strcmp(arg, "-t") == 0 && i + 1 < argc) {
+      type = argv[++i];
+    } else if (strcmp(arg, "-f") == 0 && i + 1 < argc) {
+      prefix = argv[++i];
+    } else if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    } else if (arg[0] != '-' && input == NULL) {
+      input = arg;
+    } else {
+      fprintf(stderr, "invalid argument: %s\n", arg);
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (type == NULL || prefix == NULL || input == NULL) {
+    print_help(argv[0]);
+    return 1;
+  }
+
+  FILE* in = fopen(input, "r");
+  if (in == NULL) {
+    perror(input);
+    return 1;
+  }
+  static Table table;
+  read_table(in, &table);
+  fclose(in);
+  if (table.count == 0) {
+    fprintf(stderr, "neobolt_lut: no keys\n");
+    return 1;
+  }
+
+  // about 4 keys per bucket, and a table at most half full
+  u32 bucket_bits = log2u(nextpow2(table.count / 4 + 1));
+  u32 slot_count = nextpow2(table.count * 2);
+  u32* displace = malloc((1u << bucket_bits) * sizeof(u32));
+  int* slots = malloc(slot_count * sizeof(int));
+
+  u32 seed = 0;
+  while (!build(&table, seed, bucket_bits, slot_count, displace, slots)) {
+    if (++seed == 1000) {
+      fprintf(stderr, "neobolt_lut: no perfect hash found\n");
+      return 1;
+    }
+  }
+
+  // upper case prefix for the macros
+  char macro[256];
+  size_t n = strlen(prefix);
+  if (n >= sizeof(macro))
+    n = sizeof(macro) - 1;
+  for (size_t i = 0; i < n; ++i)
+    macro[i] = (prefix[i] >= 'a' && prefix[i] <= 'z') ? cast(char, prefix[i] - 'a' + 'A') : prefix[i];
+  macro[n] = '\0';
+
+  FILE* out = output != NULL ? fopen(output, "w") : stdout;
+  if (out == NULL) {
+    perror(output);
+    return 1;
+  }
+  write_header(out, &table, type, prefix, macro, input, seed, bucket_bits, slot_count, displace, slots);
+  if (out != stdout)
+    fclose(out);
+
+  free(displace);
+  free(slots);
+  return 0;
+}
+
+// vim: sw=2 sts=2 et
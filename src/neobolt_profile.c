@@ -0,0 +1,997 @@
+// Sample counts from `perf annotate --stdio` and `perf script` dumps, matched to the
+// instructions of parsed asm. Dumps can be gigabytes, so they are streamed and only
+// per-instruction sums are kept. The profiled binary and the asm come from different
+// builds, so addresses mean nothing here: instructions of a function are matched by
+// their normalized text, in order.
+
+#include <stdio.h>
+
+/// Sampled instruction of a profiled symbol
+typedef struct {
+  u64 addr; ///< Address, or offset in the symbol. Instructions are in this order
+  StrRef text; ///< Disassembly in Profile.text, whitespace collapsed
+  u32 symbol; ///< Index into Profile.symbols
+  u64 samples; ///< In thousandths, perf annotate only has percentages
+} ProfileInsn;
+
+typedef struct {
+  StrRef name; ///< In Profile.text
+  u32 hash;
+  bool dense; ///< Has every instruction, from perf annotate. perf script only has sampled ones
+  u64 samples; ///< In thousandths, samples anywhere in the symbol
+  u32 first; ///< First instruction in Profile.insns, after profile_finish
+  u32 count; ///< Instruction count, after profile_finish
+} ProfileSymbol;
+
+typedef struct {
+  ProfileSymbol* data;
+  u32* hash; ///< 1-based indices into `data`, zero means the slot is empty
+  u32 size; ///< `data` element count
+  u32 cap; ///< `data` allocation size
+  u32 hash_cap; ///< `hash` allocation size. Always a power of two
+} ProfileSymbols;
+
+typedef struct {
+  ProfileInsn* data;
+  u32* hash; ///< 1-based indices into `data`, by symbol and address. Freed by profile_finish
+  u32 size; ///< `data` element count
+  u32 cap; ///< `data` allocation size
+  u32 hash_cap; ///< `hash` allocation size. Always a power of two
+} ProfileInsns;
+
+typedef struct {
+  ProfileSymbols symbols;
+  ProfileInsns insns;
+  Arena text;
+  u64 total; ///< In thousandths, samples in the whole dump, in any symbol
+  Exception exception;
+
+  u64 section; ///< perf annotate: samples of the current section, from its header
+  u32 current; ///< perf annotate: 1-based symbol of the current section
+  bool leaf; ///< perf script: the next callchain frame is where the sample hit
+} Profile;
+
+/// Samples of a shown asm line, see neobolt_profile_match
+typedef struct {
+  u64 samples; ///< In thousandths. Instruction: its samples. Function label: samples of the function
+  u64 unmatched; ///< Function label: samples on instructions that matched no asm line
+  bool found; ///< Function label: the dump has samples of the function
+} ProfileHit;
+
+#ifndef NEOBOLT_PROFILE_SYMBOLS_INITIAL_CAP
+# define NEOBOLT_PROFILE_SYMBOLS_INITIAL_CAP 256
+#endif
+#ifndef NEOBOLT_PROFILE_INSNS_INITIAL_CAP
+# define NEOBOLT_PROFILE_INSNS_INITIAL_CAP 4096
+#endif
+#ifndef NEOBOLT_PROFILE_READ_SIZE
+# define NEOBOLT_PROFILE_READ_SIZE (1 << 20)
+#endif
+/// Asm and profile instructions a mismatch can skip, to find where the two agree again
+#define PROFILE_WINDOW 8
+
+NORETURN NOINLINE static void profile_fail(
+    Profile* const restrict p,
+    const char* msg,
+    const char* loc)
+{
+  p->exception.msg = msg;
+  p->exception.loc = loc;
+  longjmp(p->exception.jmpbuf, 1);
+}
+
+#define PROFILE_CHECK(cond) \
+  (LIKELY(cond) ? cast(void, 0) \
+   : profile_fail(p, "assertion failed: " #cond, __FILE__ ":" STRINGIFY(__LINE__)))
+
+INTERFACE void neobolt_profile_init(
+    Profile* const restrict p)
+{
+  *p = (Profile){ .section = 100 * 1000 };
+}
+
+INTERFACE void neobolt_profile_destroy(
+    Profile* const restrict p)
+{
+  FREE(p->symbols.data);
+  FREE(p->symbols.hash);
+  FREE(p->insns.data);
+  FREE(p->insns.hash);
+  FREE(p->text.data);
+}
+
+/// Copy a string to the text arena, with whitespace runs collapsed to one space
+static StrRef profile_text(
+    Profile* const restrict p,
+    String str)
+{
+  Arena* const self = &p->text;
+  PROFILE_CHECK(str.len < UINT32_MAX - self->top);
+  u32 need = self->top + cast(u32, str.len);
+  if UNLIKELY (need > self->cap) {
+    u32 ncap = nextpow2(MAX(need, 4096u));
+    PROFILE_CHECK(ncap != 0); // overflow
+    byte* ndata = realloc(self->data, ncap);
+    PROFILE_CHECK(ndata != NULL);
+    self->data = ndata;
+    self->cap = ncap;
+  }
+
+  StrRef ref = { .off = self->top, .len = 0 };
+  bool space = false;
+  for (usize i = 0; i < str.len; ++i) {
+    byte ch = str.ptr[i];
+    if (is_space(ch)) {
+      space = ref.len > 0;
+      continue;
+    }
+    if (space)
+      self->data[ref.off + ref.len++] = ' ';
+    self->data[ref.off + ref.len++] = ch;
+    space = false;
+  }
+  self->top += ref.len;
+  return ref;
+}
+
+static void profile_symbols_rehash(
+    Profile* const restrict p,
+    u32 ncap)
+{
+  ProfileSymbols* const self = &p->symbols;
+  u32* nhash = calloc(ncap, sizeof(*nhash));
+  PROFILE_CHECK(nhash != NULL);
+  for (u32 i = 0; i < self->size; ++i) {
+    u32 slot = self->data[i].hash & (ncap - 1);
+    while (nhash[slot] != 0)
+      slot = (slot + 1) & (ncap - 1);
+    nhash[slot] = i + 1;
+  }
+  free(self->hash);
+  self->hash = nhash;
+  self->hash_cap = ncap;
+}
+
+/// Symbol by name, NULL when the dump has no samples in it
+static ProfileSymbol* profile_symbol_get(
+    Profile* const restrict p,
+    String name)
+{
+  ProfileSymbols* const self = &p->symbols;
+  if (self->hash_cap == 0)
+    return NULL;
+  u32 hash = fnv1a(name);
+  for (u32 slot = hash & (self->hash_cap - 1);; slot = (slot + 1) & (self->hash_cap - 1)) {
+    u32 idx = self->hash[slot];
+    if (idx == 0)
+      return NULL;
+    ProfileSymbol* sym = &self->data[idx - 1];
+    if (sym->hash == hash && STREQ(STR(p->text.data, sym->name), name))
+      return sym;
+  }
+}
+
+/// Index of a symbol, added when it's new
+static u32 profile_symbol(
+    Profile* const restrict p,
+    String name,
+    bool dense)
+{
+  // perf names PLT stubs like puts@plt, the asm calls them puts
+  if (name.len > 4 && memcmp(name.ptr + name.len - 4, "@plt", 4) == 0)
+    name.len -= 4;
+
+  ProfileSymbol* sym = profile_symbol_get(p, name);
+  if (sym != NULL) {
+    sym->dense = sym->dense || dense;
+    return cast(u32, sym - p->symbols.data);
+  }
+
+  ProfileSymbols* const self = &p->symbols;
+  if UNLIKELY (self->size == self->cap) {
+    u32 ncap = self->cap == 0 ? NEOBOLT_PROFILE_SYMBOLS_INITIAL_CAP : self->cap << 1;
+    PROFILE_CHECK(ncap != 0); // overflow
+    ProfileSymbol* ndata = realloc(self->data, cast(usize, ncap) * sizeof(*ndata));
+    PROFILE_CHECK(ndata != NULL);
+    self->data = ndata;
+    self->cap = ncap;
+  }
+  if UNLIKELY ((self->size + 1) * 2 > self->hash_cap)
+    profile_symbols_rehash(p, self->hash_cap == 0 ? 2 * NEOBOLT_PROFILE_SYMBOLS_INITIAL_CAP : self->hash_cap << 1);
+
+  u32 idx = self->size++;
+  StrRef ref = profile_text(p, name);
+  self->data[idx] = (ProfileSymbol){
+    .name = ref,
+    .hash = fnv1a(STR(p->text.data, ref)),
+    .dense = dense,
+  };
+  u32 slot = self->data[idx].hash & (self->hash_cap - 1);
+  while (self->hash[slot] != 0)
+    slot = (slot + 1) & (self->hash_cap - 1);
+  self->hash[slot] = idx + 1;
+  return idx;
+}
+
+static inline u32 profile_insn_hash(
+    u32 symbol,
+    u64 addr)
+{
+  u64 hash = (addr ^ (cast(u64, symbol) << 40)) * 0x9E3779B97F4A7C15;
+  return cast(u32, hash >> 32);
+}
+
+static void profile_insns_rehash(
+    Profile* const restrict p,
+    u32 ncap)
+{
+  ProfileInsns* const self = &p->insns;
+  u32* nhash = calloc(ncap, sizeof(*nhash));
+  PROFILE_CHECK(nhash != NULL);
+  for (u32 i = 0; i < self->size; ++i) {
+    u32 slot = profile_insn_hash(self->data[i].symbol, self->data[i].addr) & (ncap - 1);
+    while (nhash[slot] != 0)
+      slot = (slot + 1) & (ncap - 1);
+    nhash[slot] = i + 1;
+  }
+  free(self->hash);
+  self->hash = nhash;
+  self->hash_cap = ncap;
+}
+
+/// Add samples to an instruction of a symbol. The first text seen for an address sticks
+static void profile_insn(
+    Profile* const restrict p,
+    u32 symbol,
+    u64 addr,
+    String text,
+    u64 samples)
+{
+  ProfileInsns* const self = &p->insns;
+  if UNLIKELY ((self->size + 1) * 2 > self->hash_cap)
+    profile_insns_rehash(p, self->hash_cap == 0 ? 2 * NEOBOLT_PROFILE_INSNS_INITIAL_CAP : self->hash_cap << 1);
+
+  u32 slot = profile_insn_hash(symbol, addr) & (self->hash_cap - 1);
+  for (;; slot = (slot + 1) & (self->hash_cap - 1)) {
+    u32 idx = self->hash[slot];
+    if (idx == 0)
+      break;
+    ProfileInsn* insn = &self->data[idx - 1];
+    if (insn->symbol == symbol && insn->addr == addr) {
+      insn->samples += samples;
+      if (insn->text.len == 0 && text.len != 0)
+        insn->text = profile_text(p, text);
+      return;
+    }
+  }
+
+  if UNLIKELY (self->size == self->cap) {
+    u32 ncap = self->cap == 0 ? NEOBOLT_PROFILE_INSNS_INITIAL_CAP : self->cap << 1;
+    PROFILE_CHECK(ncap != 0); // overflow
+    ProfileInsn* ndata = realloc(self->data, cast(usize, ncap) * sizeof(*ndata));
+    PROFILE_CHECK(ndata != NULL);
+    self->data = ndata;
+    self->cap = ncap;
+  }
+  u32 idx = self->size++;
+  self->data[idx] = (ProfileInsn){
+    .addr = addr,
+    .text = profile_text(p, text),
+    .symbol = symbol,
+    .samples = samples,
+  };
+  self->hash[slot] = idx + 1;
+}
+
+
+static inline bool is_hex(byte ch) { return is_digit(ch) || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F'); }
+
+static inline u32 hex_value(byte ch)
+{
+  return is_digit(ch) ? cast(u32, ch - '0') : cast(u32, (ch | 0x20) - 'a' + 10);
+}
+
+/// Hex number without 0x, at least one digit
+static bool parse_hex(
+    const byte** p,
+    const byte* end,
+    u64* res)
+{
+  const byte* q = *p;
+  u64 value = 0;
+  while (q < end && is_hex(*q))
+    value = (value << 4) | hex_value(*q++);
+  if (q == *p)
+    return false;
+  *p = q;
+  *res = value;
+  return true;
+}
+
+static bool parse_dec(
+    const byte** p,
+    const byte* end,
+    u64* res)
+{
+  const byte* q = *p;
+  u64 value = 0;
+  while (q < end && is_digit(*q))
+    value = value * 10 + cast(u64, *q++ - '0');
+  if (q == *p)
+    return false;
+  *p = q;
+  *res = value;
+  return true;
+}
+
+/// Decimal like 12.34, in thousandths
+static bool parse_milli(
+    const byte** p,
+    const byte* end,
+    u64* res)
+{
+  const byte* q = *p;
+  u64 value = 0;
+  while (q < end && is_digit(*q))
+    value = value * 10 + cast(u64, *q++ - '0');
+  if (q == *p)
+    return false;
+  u64 scale = 1000;
+  if (q < end && *q == '.') {
+    ++q;
+    while (q < end && is_digit(*q)) {
+      if (scale > 1) {
+        scale /= 10;
+        value = value * 10 + cast(u64, *q - '0');
+      }
+      ++q;
+    }
+  }
+  *p = q;
+  *res = value * scale;
+  return true;
+}
+
+static inline void skip_spaces(
+    const byte** p,
+    const byte* end)
+{
+  while (*p < end && is_space(**p))
+    ++*p;
+}
+
+static inline const byte* find_byte(
+    const byte* p,
+    const byte* end,
+    byte ch)
+{
+  const byte* q = memchr(p, ch, cast(usize, end - p));
+  return q != NULL ? q : end;
+}
+
+/// perf annotate section header, `Percent | Source code & Disassembly of a.out for
+/// cycles:u (1234 samples, percent: local period)`. Older perf has no sample count,
+/// percentages then stand for samples.
+static bool profile_annotate_header(
+    Profile* const restrict p,
+    const byte* ptr,
+    const byte* end)
+{
+  const byte* bar = find_byte(ptr, end, '|');
+  String head = { ptr, cast(usize, bar - ptr) };
+  while (head.len > 0 && is_space(head.ptr[head.len - 1]))
+    --head.len;
+  while (head.len > 0 && is_space(head.ptr[0]))
+    ++head.ptr, --head.len;
+  if (bar == end || !STRTEST(head, "Percent"))
+    return false;
+
+  p->current = 0;
+  p->section = 100 * 1000;
+  for (const byte* q = find_byte(bar, end, '('); q < end; q = find_byte(q + 1, end, '(')) {
+    const byte* num = q + 1;
+    u64 samples;
+    if (parse_milli(&num, end, &samples) && end - num >= 8 && memcmp(num, " samples", 8) == 0) {
+      p->section = samples;
+      break;
+    }
+  }
+  return true;
+}
+
+/// perf annotate lines, `0000000000401126 <main>:` starts a symbol and `12.50 :
+/// 40112e: addl $0x1,-0x4(%rbp)` is one of its instructions. Both can come after a
+/// `:` column, source lines in between have no address.
+static bool profile_annotate_line(
+    Profile* const restrict p,
+    const byte* ptr,
+    const byte* end)
+{
+  const byte* q = ptr;
+  skip_spaces(&q, end);
+  u64 percent = 0;
+  bool has_percent = parse_milli(&q, end, &percent);
+  // more events, more percent columns
+  for (;;) {
+    skip_spaces(&q, end);
+    u64 ignored;
+    if (!parse_milli(&q, end, &ignored))
+      break;
+  }
+  if (q == end || *q != ':')
+    return false;
+  ++q;
+  skip_spaces(&q, end);
+
+  u64 addr;
+  if (!parse_hex(&q, end, &addr))
+    return false; // source line, or not perf annotate at all
+  if (q < end && *q == ':') {
+    if (p->current == 0)
+      return true;
+    ++q;
+    // raw instruction bytes with --asm-raw, pairs on x86 and words on arm
+    for (;;) {
+      skip_spaces(&q, end);
+      const byte* r = q;
+      while (r < end && is_hex(*r))
+        ++r;
+      if (!((r - q == 2 || r - q == 8) && (r == end || is_space(*r))))
+        break;
+      q = r;
+    }
+    String text = { q, cast(usize, end - q) };
+    u64 samples = has_percent ? percent * (p->section / 1000) / 100 : 0;
+    profile_insn(p, p->current - 1, addr, text, samples);
+    return true;
+  }
+
+  skip_spaces(&q, end);
+  if (q < end && *q == '<' && end - q > 3 && end[-1] == ':' && end[-2] == '>') {
+    String name = { q + 1, cast(usize, end - q - 3) };
+    p->current = profile_symbol(p, name, true) + 1;
+    p->symbols.data[p->current - 1].samples += p->section;
+    p->total += p->section;
+    return true;
+  }
+  return false;
+}
+
+/// perf script frame, `7f1234 main+0x10 (/path/to/a.out)`, anywhere in a line.
+/// With `-F +insn --xed` or `-F +disasm` the instruction text comes after the dso.
+static bool profile_script_frame(
+    Profile* const restrict p,
+    const byte* ptr,
+    const byte* end)
+{
+  const byte* q = ptr;
+  while (q < end) {
+    skip_spaces(&q, end);
+    u64 addr;
+    if (!parse_hex(&q, end, &addr) || q == end || !is_space(*q)) {
+      while (q < end && !is_space(*q))
+        ++q;
+      continue;
+    }
+
+    const byte* sym = q;
+    skip_spaces(&sym, end);
+    const byte* sym_end = sym;
+    while (sym_end < end && !is_space(*sym_end))
+      ++sym_end;
+    const byte* dso = sym_end;
+    skip_spaces(&dso, end);
+    if (sym == sym_end || dso == end || *dso != '(')
+      continue;
+
+    String name = { sym, cast(usize, sym_end - sym) };
+    u64 offset = 0;
+    bool has_offset = false;
+    for (usize i = name.len; i >= 4; --i) {
+      if (name.ptr[i - 4] == '+' && name.ptr[i - 3] == '0' && name.ptr[i - 2] == 'x') {
+        const byte* off = &name.ptr[i - 1];
+        has_offset = parse_hex(&off, sym_end, &offset) && off == sym_end;
+        if (has_offset)
+          name.len = i - 4;
+        break;
+      }
+    }
+
+    u32 symbol = profile_symbol(p, name, false);
+    p->symbols.data[symbol].samples += 1000;
+    p->total += 1000;
+    if (has_offset) {
+      const byte* text = find_byte(dso, end, ')');
+      text = text < end ? text + 1 : end;
+      skip_spaces(&text, end);
+      // raw bytes without a disassembler
+      if (end - text >= 5 && memcmp(text, "insn:", 5) == 0)
+        text = end;
+      profile_insn(p, symbol, offset, (String){ text, cast(usize, end - text) }, 1000);
+    }
+    return true;
+  }
+  return false;
+}
+
+static void profile_line(
+    Profile* const restrict p,
+    const byte* ptr,
+    const byte* end)
+{
+  while (end > ptr && (end[-1] == '\r' || is_space(end[-1])))
+    --end;
+  const byte* q = ptr;
+  skip_spaces(&q, end);
+  if (q == end) {
+    p->leaf = false; // end of a callchain
+    return;
+  }
+
+  if (profile_annotate_header(p, ptr, end) || profile_annotate_line(p, ptr, end))
+    return;
+
+  // perf script prints the callchain of a sample on lines after it, starting with a
+  // tab. The first of them is where the sample hit.
+  if (*ptr == '\t') {
+    if (p->leaf && profile_script_frame(p, ptr, end))
+      p->leaf = false;
+    return;
+  }
+  p->leaf = !profile_script_frame(p, ptr, end);
+}
+
+static int profile_insn_cmp(
+    const void* a,
+    const void* b)
+{
+  const ProfileInsn* x = a;
+  const ProfileInsn* y = b;
+  if (x->symbol != y->symbol)
+    return x->symbol < y->symbol ? -1 : 1;
+  if (x->addr != y->addr)
+    return x->addr < y->addr ? -1 : 1;
+  return 0;
+}
+
+/// Sort instructions by symbol and address, and point symbols at theirs
+static void profile_finish(
+    Profile* const restrict p)
+{
+  ProfileInsns* const insns = &p->insns;
+  FREE(insns->hash);
+  insns->hash_cap = 0;
+  if (insns->size > 0)
+    qsort(insns->data, insns->size, sizeof(*insns->data), profile_insn_cmp);
+  for (u32 i = 0; i < insns->size; ++i) {
+    ProfileSymbol* sym = &p->symbols.data[insns->data[i].symbol];
+    if (sym->count == 0)
+      sym->first = i;
+    sym->count += 1;
+  }
+}
+
+/// Read a `perf annotate --stdio` or `perf script` dump, or both concatenated
+INTERFACE bool neobolt_profile_load(
+    Profile* const restrict p,
+    FILE* file)
+{
+  byte* buf = NULL;
+  if (setjmp(p->exception.jmpbuf) != 0) {
+    free(buf);
+    return false;
+  }
+
+  buf = malloc(NEOBOLT_PROFILE_READ_SIZE);
+  PROFILE_CHECK(buf != NULL);
+  usize size = 0;
+  bool skip = false; // rest of a line longer than the buffer
+  for (;;) {
+    usize n = fread(buf + size, 1, NEOBOLT_PROFILE_READ_SIZE - size, file);
+    if (n == 0) {
+      PROFILE_CHECK(!ferror(file));
+      if (size > 0 && !skip)
+        profile_line(p, buf, buf + size);
+      break;
+    }
+    size += n;
+
+    const byte* line = buf;
+    const byte* end = buf + size;
+    for (const byte* eol; (eol = memchr(line, EOL, cast(usize, end - line))) != NULL; line = eol + 1) {
+      if (!skip)
+        profile_line(p, line, eol);
+      skip = false;
+    }
+    size = cast(usize, end - line);
+    if (size == NEOBOLT_PROFILE_READ_SIZE) {
+      size = 0;
+      skip = true;
+    } else {
+      memmove(buf, line, size);
+    }
+  }
+
+  free(buf);
+  profile_finish(p);
+  return true;
+}
+
+
+// Compact form of a loaded profile, one record per line, so a profile read on a
+// worker thread can cross over to the main one:
+//
+//   neobolt-profile <total>
+//   s <dense> <samples> <name>
+//   i <addr> <samples> <text>      instructions of the last symbol
+//
+// fields are tab separated, samples are in thousandths.
+
+#define PROFILE_MAGIC "neobolt-profile"
+
+/// Profile in compact form, a malloc-ed string
+INTERFACE bool neobolt_profile_save(
+    Profile* const restrict p,
+    byte** res,
+    usize* res_len)
+{
+  byte* out = NULL;
+  if (setjmp(p->exception.jmpbuf) != 0) {
+    free(out);
+    return false;
+  }
+
+  usize len = 0;
+  usize cap = 4096 + p->text.top + cast(usize, p->insns.size + p->symbols.size) * 48;
+  out = malloc(cap);
+  PROFILE_CHECK(out != NULL);
+  len += cast(usize, snprintf(cast(char*, out), cap, PROFILE_MAGIC "\t%llu\n",
+                              cast(unsigned long long, p->total)));
+  for (u32 i = 0; i < p->symbols.size; ++i) {
+    const ProfileSymbol* sym = &p->symbols.data[i];
+    String name = STR(p->text.data, sym->name);
+    len += cast(usize, snprintf(cast(char*, out + len), cap - len, "s\t%d\t%llu\t%.*s\n",
+                                sym->dense ? 1 : 0, cast(unsigned long long, sym->samples),
+                                cast(int, name.len), name.ptr));
+    for (u32 k = sym->first; k < sym->first + sym->count; ++k) {
+      const ProfileInsn* insn = &p->insns.data[k];
+      String text = STR(p->text.data, insn->text);
+      if (cap - len < 64 + text.len) {
+        cap = cap * 2 + text.len;
+        byte* nout = realloc(out, cap);
+        PROFILE_CHECK(nout != NULL);
+        out = nout;
+      }
+      len += cast(usize, snprintf(cast(char*, out + len), cap - len, "i\t%llx\t%llu\t%.*s\n",
+                                  cast(unsigned long long, insn->addr),
+                                  cast(unsigned long long, insn->samples),
+                                  cast(int, text.len), text.ptr));
+    }
+    if (cap - len < 4096) {
+      cap *= 2;
+      byte* nout = realloc(out, cap);
+      PROFILE_CHECK(nout != NULL);
+      out = nout;
+    }
+  }
+
+  *res = out;
+  *res_len = len;
+  return true;
+}
+
+/// Read a profile in compact form, see neobolt_profile_save
+INTERFACE bool neobolt_profile_read(
+    Profile* const restrict p,
+    String data)
+{
+  if (setjmp(p->exception.jmpbuf) != 0)
+    return false;
+
+  const byte* q = data.ptr;
+  const byte* end = data.ptr + data.len;
+  const byte* eol = find_byte(q, end, EOL);
+  usize magic = sizeof(PROFILE_MAGIC) - 1;
+  PROFILE_CHECK(cast(usize, eol - q) > magic && memcmp(q, PROFILE_MAGIC "\t", magic + 1) == 0);
+  q += magic + 1;
+  PROFILE_CHECK(parse_dec(&q, eol, &p->total));
+
+  u32 symbol = 0;
+  bool any = false;
+  for (q = eol + 1; q < end; q = eol + 1) {
+    eol = find_byte(q, end, EOL);
+    PROFILE_CHECK(eol - q >= 2 && q[1] == '\t');
+    byte type = q[0];
+    q += 2;
+    u64 value, samples;
+    if (type == 's') {
+      PROFILE_CHECK(parse_dec(&q, eol, &value) && q < eol && *q++ == '\t');
+      PROFILE_CHECK(parse_dec(&q, eol, &samples) && q < eol && *q++ == '\t');
+      symbol = profile_symbol(p, (String){ q, cast(usize, eol - q) }, value != 0);
+      p->symbols.data[symbol].samples += samples;
+      any = true;
+    } else {
+      PROFILE_CHECK(type == 'i' && any);
+      PROFILE_CHECK(parse_hex(&q, eol, &value) && q < eol && *q++ == '\t');
+      PROFILE_CHECK(parse_dec(&q, eol, &samples) && q < eol && *q++ == '\t');
+      profile_insn(p, symbol, value, (String){ q, cast(usize, eol - q) }, samples);
+    }
+  }
+
+  profile_finish(p);
+  return true;
+}
+
+
+/// Instruction reduced to what survives between a compiler's asm and a disassembler:
+/// the mnemonic and the registers. Immediates, labels and addresses never match.
+typedef struct {
+  u32 line; ///< Index of the asm line, or of the profile instruction
+  u32 regs; ///< Sum of register name hashes, order doesn't matter
+  u8 len;
+  char name[15]; ///< Mnemonic without prefixes, lowercase
+} ProfileKey;
+
+/// Register names without the AT&T %, like rax, r8d, xmm1, or x0, w12, v3, a1 on arm
+/// and risc-v
+static inline bool is_bare_register(
+    String tok)
+{
+  static const char* const x86[] = {
+    "ax", "bx", "cx", "dx", "si", "di", "bp", "sp", "ip",
+    "al", "ah", "bl", "bh", "cl", "ch", "dl", "dh", "sil", "dil", "bpl", "spl",
+    "lr", "fp", "xzr", "wzr",
+  };
+  String base = tok;
+  if (base.len == 3 && (base.ptr[0] == 'r' || base.ptr[0] == 'e'))
+    ++base.ptr, --base.len;
+  for (usize i = 0; i < sizeof(x86) / sizeof(x86[0]); ++i)
+    if ((base.len == strlen(x86[i]) && memcmp(base.ptr, x86[i], base.len) == 0)
+        || (tok.len == strlen(x86[i]) && memcmp(tok.ptr, x86[i], tok.len) == 0))
+      return true;
+  if (tok.len > 3 && (memcmp(tok.ptr, "xmm", 3) == 0 || memcmp(tok.ptr, "ymm", 3) == 0
+                      || memcmp(tok.ptr, "zmm", 3) == 0))
+    tok.ptr += 2, tok.len -= 2;
+
+  // one or two letters, one or two digits, and r8d, r8w, r8b
+  usize i = 0;
+  while (i < tok.len && is_lower(tok.ptr[i]))
+    ++i;
+  usize digits = i;
+  while (digits < tok.len && is_digit(tok.ptr[digits]))
+    ++digits;
+  if (i == 0 || i > 2 || digits == i || digits - i > 2)
+    return false;
+  if (digits + 1 == tok.len && tok.ptr[0] == 'r'
+      && (tok.ptr[digits] == 'd' || tok.ptr[digits] == 'w' || tok.ptr[digits] == 'b'))
+    return true;
+  return digits == tok.len;
+}
+
+/// Key of an instruction, false for nops and empty text. Disassemblers pad functions
+/// with nops where the compiler emits .p2align, they never line up.
+static bool profile_key(
+    String text,
+    u32 line,
+    ProfileKey* key)
+{
+  const byte* q = text.ptr;
+  const byte* end = text.ptr + text.len;
+  String name = {0};
+  for (;;) {
+    skip_spaces(&q, end);
+    const byte* start = q;
+    while (q < end && !is_space(*q))
+      ++q;
+    name = (String){ start, cast(usize, q - start) };
+    if (!(STRTEST(name, "rep") || STRTEST(name, "repz") || STRTEST(name, "repe")
+          || STRTEST(name, "repnz") || STRTEST(name, "repne") || STRTEST(name, "lock")
+          || STRTEST(name, "notrack") || STRTEST(name, "bnd") || STRTEST(name, "data16")
+          || STRTEST(name, "addr32") || STRTEST(name, "cs") || STRTEST(name, "ds")
+          || STRTEST(name, "es") || STRTEST(name, "ss")))
+      break;
+  }
+  if (name.len == 0 || (name.len >= 3 && memcmp(name.ptr, "nop", 3) == 0))
+    return false;
+
+  *key = (ProfileKey){ .line = line };
+  for (usize i = 0; i < name.len && key->len < sizeof(key->name); ++i) {
+    byte ch = name.ptr[i];
+    // aarch64 b.ne is bne in gcc output
+    if (ch == '.' && i == 1 && name.ptr[0] == 'b')
+      continue;
+    key->name[key->len++] = cast(char, is_upper(ch) ? ch | 0x20 : ch);
+  }
+
+  u32 regs = 0;
+  u32 count = 0;
+  while (q < end) {
+    byte ch = *q;
+    if (ch == '<') { // objdump symbol, <main+0x10>
+      q = find_byte(q, end, '>');
+      continue;
+    }
+    if ((ch == '#' && (q + 1 == end || is_space(q[1])))
+        || (ch == '/' && q + 1 < end && q[1] == '/') || ch == ';')
+      break; // comment
+    if (ch == '%' || is_lower(ch) || is_upper(ch)) {
+      const byte* start = ch == '%' ? q + 1 : q;
+      q = start;
+      while (q < end && (is_alnum(*q) || *q == '_'))
+        ++q;
+      String tok = { start, cast(usize, q - start) };
+      if (ch == '%' || is_bare_register(tok)) {
+        regs += fnv1a(tok);
+        ++count;
+      }
+      continue;
+    }
+    if (is_digit(ch) || ch == '.' || ch == '_' || ch == '$') {
+      while (q < end && (is_symbol(*q) || *q == '$'))
+        ++q;
+      continue;
+    }
+    ++q;
+  }
+  key->regs = regs + count;
+
+  // xchg %ax,%ax is a 2-byte nop
+  if (STRTEST(name, "xchg") && count == 2 && regs == 2 * fnv1a((String){ cast(const byte*, "ax"), 2 }))
+    return false;
+  return true;
+}
+
+/// Same mnemonic, give or take an AT&T size suffix (mov and movl, retq and ret), and
+/// same registers
+static bool profile_key_eq(
+    const ProfileKey* a,
+    const ProfileKey* b)
+{
+  if (a->regs != b->regs)
+    return false;
+  if (a->len == b->len)
+    return memcmp(a->name, b->name, a->len) == 0;
+  const ProfileKey* l = a->len > b->len ? a : b;
+  const ProfileKey* s = a->len > b->len ? b : a;
+  char suffix = l->name[l->len - 1];
+  return l->len == s->len + 1 && s->len >= 2
+      && (suffix == 'b' || suffix == 'w' || suffix == 'l' || suffix == 'q')
+      && memcmp(l->name, s->name, s->len) == 0;
+}
+
+/// Align the instructions of one function with the sampled ones of its symbol, and
+/// add up samples of the matched asm lines
+static void profile_align(
+    const Profile* const restrict p,
+    const ProfileSymbol* sym,
+    const ProfileKey* asm_keys,
+    u32 n,
+    const ProfileKey* keys,
+    u32 m,
+    ProfileHit* hits)
+{
+  const ProfileInsn* insns = &p->insns.data[sym->first];
+
+  if (!sym->dense) {
+    // only sampled instructions, with gaps of unknown size between them. take the
+    // next asm line that fits, in order
+    u32 i = 0;
+    for (u32 j = 0; j < m; ++j) {
+      u32 k = i;
+      while (k < n && !profile_key_eq(&asm_keys[k], &keys[j]))
+        ++k;
+      if (k < n) {
+        hits[asm_keys[k].line].samples += insns[keys[j].line].samples;
+        i = k + 1;
+      }
+    }
+    return;
+  }
+
+  // every instruction, mostly the same ones as the asm. on a mismatch, skip the
+  // fewest instructions on either side until two in a row match again
+  u32 i = 0, j = 0;
+  while (i < n && j < m) {
+    if (profile_key_eq(&asm_keys[i], &keys[j])) {
+      hits[asm_keys[i].line].samples += insns[keys[j].line].samples;
+      ++i, ++j;
+      continue;
+    }
+
+    u32 skip_i = 1, skip_j = 1;
+    for (u32 d = 1; d <= 2 * PROFILE_WINDOW; ++d) {
+      bool found = false;
+      for (u32 di = d > PROFILE_WINDOW ? d - PROFILE_WINDOW : 0; di <= MIN(d, PROFILE_WINDOW); ++di) {
+        u32 ai = i + di, pj = j + (d - di);
+        if (ai >= n || pj >= m || !profile_key_eq(&asm_keys[ai], &keys[pj]))
+          continue;
+        if (ai + 1 < n && pj + 1 < m && !profile_key_eq(&asm_keys[ai + 1], &keys[pj + 1]))
+          continue;
+        skip_i = di, skip_j = d - di;
+        found = true;
+        break;
+      }
+      if (found)
+        break;
+    }
+    i += skip_i;
+    j += skip_j;
+  }
+}
+
+/// Name of a label line, up to the colon
+static String label_line_name(
+    String text)
+{
+  usize start = 0;
+  while (start < text.len && is_space(text.ptr[start]))
+    ++start;
+  usize len = start;
+  while (len < text.len && text.ptr[len] != ':')
+    ++len;
+  return (String){ text.ptr + start, len - start };
+}
+
+/// Match samples to asm lines. `kinds` has one byte per line like lib.parse `kinds`,
+/// 'l' for labels and 'i' for instructions. `hits` gets one entry per line.
+INTERFACE bool neobolt_profile_match(
+    Profile* const restrict p,
+    const String* lines,
+    const byte* kinds,
+    u32 count,
+    ProfileHit* hits)
+{
+  ProfileKey* keys = NULL;
+  if (setjmp(p->exception.jmpbuf) != 0) {
+    free(keys);
+    return false;
+  }
+
+  memset(hits, 0, cast(usize, count) * sizeof(*hits));
+  u32 max_insns = 0;
+  for (u32 i = 0; i < p->symbols.size; ++i)
+    max_insns = MAX(max_insns, p->symbols.data[i].count);
+  keys = malloc((cast(usize, count) + max_insns + 1) * sizeof(*keys));
+  PROFILE_CHECK(keys != NULL);
+  ProfileKey* asm_keys = &keys[max_insns];
+
+  u32 i = 0;
+  while (i < count) {
+    if (kinds[i] != 'l' || !is_function_label(label_line_name(lines[i]))) {
+      ++i;
+      continue;
+    }
+    u32 label = i++;
+    u32 n = 0;
+    for (; i < count; ++i) {
+      if (kinds[i] == 'l' && is_function_label(label_line_name(lines[i])))
+        break;
+      if (kinds[i] == 'i' && profile_key(lines[i], i, &asm_keys[n]))
+        ++n;
+    }
+
+    const ProfileSymbol* sym = profile_symbol_get(p, label_line_name(lines[label]));
+    if (sym == NULL)
+      continue;
+    u32 m = 0;
+    for (u32 k = 0; k < sym->count; ++k) {
+      const ProfileInsn* insn = &p->insns.data[sym->first + k];
+      if (profile_key(STR(p->text.data, insn->text), k, &keys[m]))
+        ++m;
+    }
+
+    hits[label].found = true;
+    hits[label].samples = sym->samples;
+    profile_align(p, sym, asm_keys, n, keys, m, hits);
+    u64 matched = 0;
+    for (u32 k = 0; k < n; ++k)
+      matched += hits[asm_keys[k].line].samples;
+    // also samples on nops, and perf script samples without instruction text
+    hits[label].unmatched = sym->samples > matched ? sym->samples - matched : 0;
+  }
+
+  free(keys);
+  return true;
+}
+
+// vim: sw=2 sts=2 et
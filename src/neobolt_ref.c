@@ -0,0 +1,487 @@
+// Reference implementation of the three-pass filter in neobolt.c.
+//
+// Deliberately simple and slow: no hash table, no queue, no arena, explicit bounds
+// checks everywhere. It exists only to be compared against the optimized parser,
+// see neobolt_difffuzz.c. Semantics, including the quirks, have to match neobolt.c.
+// When changing what the parser shows, change it here too.
+
+typedef struct {
+  u32 off; ///< Line byte offset
+  u32 len; ///< Line byte length, without EOL
+  u32 name_off;
+  u32 name_len;
+  u8 type; ///< LineType
+  bool show;
+  bool visited;
+  u32 file; ///< 1-based index into RefState.files, zero if no location
+  u32 lnum;
+  u32 col;
+} RefLine;
+
+typedef struct {
+  u32 id;
+  char* path; ///< NUL terminated
+  usize len;
+} RefFile;
+
+typedef struct {
+  const byte* text;
+  u32 size;
+
+  RefLine* lines;
+  u32 nlines;
+
+  RefFile* files;
+  u32 nfiles;
+
+  u32* labels; ///< 0-based line indices of labels, sorted by name, then by line
+  u32 nlabels;
+
+  u32* stack; ///< Labels waiting for pass 3
+  u32 nstack;
+  u32 stack_cap;
+} RefState;
+
+static const char* const ref_data_directives[] = {
+  "ascii", "asciz", "byte", "1byte", "2byte", "4byte", "8byte",
+  "dc", "dc.a", "dc.b", "dc.d", "dc.l", "dc.s", "dc.w", "dc.x",
+  "dcb", "dcb.b", "dcb.d", "dcb.l", "dcb.s", "dcb.w", "dcb.x",
+  "double", "ds", "ds.b", "ds.d", "ds.l", "ds.p", "ds.s", "ds.w", "ds.x",
+  "dword", "fill", "float", "hword", "int", "long", "octa", "quad",
+  "short", "single", "skip", "sleb128", "space", "string", "string8",
+  "string16", "string32", "string64", "uleb128", "value", "word", "xword",
+  "zero",
+};
+
+/// Grows arrays that only ever get appended to, on every power of two
+static void* ref_grow(
+    void* ptr,
+    u32 count,
+    usize elem)
+{
+  if (count != 0 && (count & (count - 1)) != 0)
+    return ptr;
+  void* nptr = realloc(ptr, (count == 0 ? 1 : cast(usize, count) * 2) * elem);
+  if (nptr == NULL)
+    abort();
+  return nptr;
+}
+
+static bool ref_space(byte c) { return c == ' ' || c == '\t'; }
+static bool ref_digit(byte c) { return c >= '0' && c <= '9'; }
+static bool ref_alpha(byte c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static bool ref_sym(byte c) { return ref_alpha(c) || ref_digit(c) || c == '_' || c == '.' || c == '$'; }
+static bool ref_sym1(byte c) { return ref_alpha(c) || c == '_' || c == '.'; }
+
+static bool ref_is_data(
+    const byte* name,
+    u32 len)
+{
+  for (usize i = 0; i < sizeof(ref_data_directives) / sizeof(ref_data_directives[0]); ++i) {
+    const char* d = ref_data_directives[i];
+    if (strlen(d) == len && memcmp(d, name, len) == 0)
+      return true;
+  }
+  return false;
+}
+
+static int ref_cmp_name(
+    const RefState* r,
+    const byte* name,
+    usize len,
+    u32 line)
+{
+  const RefLine* l = &r->lines[line];
+  usize n = MIN(len, cast(usize, l->name_len));
+  int c = n == 0 ? 0 : memcmp(name, r->text + l->name_off, n);
+  if (c != 0)
+    return c;
+  return (len > l->name_len) - (len < l->name_len);
+}
+
+// qsort has no context argument
+static const RefState* ref_sort_state;
+
+static int ref_cmp_labels(
+    const void* a,
+    const void* b)
+{
+  u32 la = *cast(const u32*, a);
+  u32 lb = *cast(const u32*, b);
+  const RefLine* l = &ref_sort_state->lines[la];
+  int c = ref_cmp_name(ref_sort_state, ref_sort_state->text + l->name_off, l->name_len, lb);
+  if (c != 0)
+    return c;
+  return (la > lb) - (la < lb);
+}
+
+static void ref_sort_labels(
+    RefState* r)
+{
+  for (u32 i = 0; i < r->nlines; ++i) {
+    if (r->lines[i].type == kLineLabel) {
+      r->labels = ref_grow(r->labels, r->nlabels, sizeof(*r->labels));
+      r->labels[r->nlabels++] = i;
+    }
+  }
+  ref_sort_state = r;
+  if (r->nlabels > 0)
+    qsort(r->labels, r->nlabels, sizeof(*r->labels), ref_cmp_labels);
+  ref_sort_state = NULL;
+}
+
+/// Binary search for the first label definition. Returns 1-based line, or zero
+static u32 ref_find_label(
+    const RefState* r,
+    const byte* name,
+    usize len)
+{
+  // lower bound, so duplicates resolve to the first definition
+  u32 lo = 0, hi = r->nlabels;
+  while (lo < hi) {
+    u32 mid = lo + (hi - lo) / 2;
+    if (ref_cmp_name(r, name, len, r->labels[mid]) > 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < r->nlabels && ref_cmp_name(r, name, len, r->labels[lo]) == 0)
+    return r->labels[lo] + 1;
+  return 0;
+}
+
+static void ref_reference(
+    RefState* r,
+    const byte* name,
+    usize len)
+{
+  u32 label = ref_find_label(r, name, len);
+  if (label == 0)
+    return;
+  RefLine* l = &r->lines[label - 1];
+  l->show = true;
+  if (!l->visited) {
+    l->visited = true;
+    if (r->nstack == r->stack_cap) {
+      r->stack_cap = r->stack_cap == 0 ? 16 : r->stack_cap * 2;
+      r->stack = realloc(r->stack, cast(usize, r->stack_cap) * sizeof(*r->stack));
+      if (r->stack == NULL)
+        abort();
+    }
+    r->stack[r->nstack++] = label - 1;
+  }
+}
+
+/// Line cursor. `p` never goes past `end`, which points at the EOL.
+typedef struct {
+  const byte* p;
+  const byte* end;
+} RefCursor;
+
+static bool ref_spaces(
+    RefCursor* c)
+{
+  if (c->p >= c->end || !ref_space(*c->p))
+    return false;
+  while (c->p < c->end && ref_space(*c->p))
+    c->p++;
+  return true;
+}
+
+static bool ref_u32(
+    RefCursor* c,
+    u32* res)
+{
+  if (c->p >= c->end || !ref_digit(*c->p))
+    return false;
+  u64 v = 0;
+  while (c->p < c->end && ref_digit(*c->p))
+    v = v * 10 + cast(u64, *c->p++ - '0');
+  *res = cast(u32, v);
+  return true;
+}
+
+/// Quoted string, backslash skips the next character. Can advance and still fail.
+static bool ref_string(
+    RefCursor* c,
+    const byte** ptr,
+    usize* len)
+{
+  if (c->p >= c->end || *c->p != '"')
+    return false;
+  const byte* start = ++c->p;
+  while (c->p < c->end) {
+    if (*c->p == '"') {
+      *ptr = start;
+      *len = cast(usize, c->p - start);
+      c->p++;
+      return true;
+    }
+    if (*c->p == '\\')
+      c->p++;
+    if (c->p < c->end)
+      c->p++;
+  }
+  return false;
+}
+
+static bool ref_symname(
+    RefCursor* c,
+    const byte** ptr,
+    usize* len)
+{
+  if (c->p >= c->end || !ref_sym1(*c->p))
+    return false;
+  const byte* start = c->p;
+  while (c->p < c->end && (ref_sym(*c->p) || *c->p == '@'))
+    c->p++;
+  *ptr = start;
+  *len = cast(usize, c->p - start);
+  return true;
+}
+
+static bool ref_char(
+    RefCursor* c,
+    byte ch)
+{
+  if (c->p >= c->end || *c->p != ch)
+    return false;
+  c->p++;
+  return true;
+}
+
+static void ref_references(
+    RefState* r,
+    RefCursor c)
+{
+  while (c.p < c.end) {
+    if (*c.p == '#')
+      return;
+    if (*c.p == '/' && c.p + 1 < c.end && c.p[1] == '/')
+      return;
+    const byte* name;
+    usize len;
+    if (ref_symname(&c, &name, &len)) {
+      ref_reference(r, name, len);
+      continue;
+    }
+    if (ref_string(&c, &name, &len))
+      continue;
+    if (c.p < c.end)
+      c.p++;
+  }
+}
+
+static RefCursor ref_args(
+    const RefState* r,
+    const RefLine* l)
+{
+  return (RefCursor){
+    .p = r->text + l->name_off + l->name_len,
+    .end = r->text + l->off + l->len,
+  };
+}
+
+static void ref_pass_1(
+    RefState* r)
+{
+  const byte* t = r->text;
+  u32 pos = 0;
+  while (pos < r->size) {
+    // only lines terminated with EOL count
+    const byte* nl = memchr(t + pos, EOL, r->size - pos);
+    if (nl == NULL)
+      return;
+    u32 end = cast(u32, nl - t);
+
+    RefLine l = { .off = pos, .len = end - pos };
+    u32 p = pos;
+    while (p < end && ref_space(t[p]))
+      p++;
+    l.name_off = p;
+
+    if (p < end && ref_sym(t[p])) {
+      while (p < end && ref_sym(t[p]))
+        p++;
+      l.name_len = p - l.name_off;
+      if (p < end && t[p] == ':') {
+        l.type = ref_sym1(t[l.name_off]) ? kLineLabel : kLineLocalLabel;
+      } else if (p == end || ref_space(t[p])) {
+        if (l.name_len > 1 && t[l.name_off] == '.') {
+          l.name_off += 1;
+          l.name_len -= 1;
+          l.type = ref_is_data(t + l.name_off, l.name_len) ? kLineData : kLineDirective;
+        } else {
+          l.type = kLineInstruction;
+          l.show = true;
+        }
+      }
+    } else if (p < end && t[p] == '#') {
+      l.type = kLineComment;
+    } else if (p + 1 < end && t[p] == '/' && t[p + 1] == '/') {
+      l.type = kLineComment;
+    }
+
+    r->lines = ref_grow(r->lines, r->nlines, sizeof(*r->lines));
+    r->lines[r->nlines++] = l;
+    pos = end + 1;
+  }
+}
+
+static void ref_pass_2(
+    RefState* r)
+{
+  // .loc caches the file lookup by ID. a .loc before its .file keeps pointing at
+  // no file until the ID changes, same as neobolt.c.
+  u32 cur_id = cast(u32, -1);
+  u32 cur_file = 0;
+  u32 cur_line = 0;
+  u32 cur_col = 0;
+
+  for (u32 i = 0; i < r->nlines; ++i) {
+    RefLine* l = &r->lines[i];
+    const byte* name = r->text + l->name_off;
+    RefCursor c = ref_args(r, l);
+
+    if (l->type == kLineInstruction) {
+      ref_references(r, c);
+      if (cur_file != 0) {
+        l->file = cur_file;
+        l->lnum = cur_line;
+        l->col = cur_col;
+      }
+      continue;
+    }
+    if (l->type != kLineDirective)
+      continue;
+
+#define NAME_IS(lit) (l->name_len == sizeof(lit) - 1 && memcmp(name, lit, sizeof(lit) - 1) == 0)
+    if (NAME_IS("loc")) {
+      u32 id, lnum, col = 0;
+      if (!ref_spaces(&c) || !ref_u32(&c, &id) || !ref_spaces(&c) || !ref_u32(&c, &lnum))
+        continue;
+      if (ref_spaces(&c))
+        ref_u32(&c, &col);
+      if (cur_id != id) {
+        cur_id = id;
+        cur_file = 0;
+        for (u32 f = 0; f < r->nfiles; ++f) {
+          if (r->files[f].id == id) {
+            cur_file = f + 1;
+            break;
+          }
+        }
+      }
+      cur_line = lnum;
+      cur_col = col;
+    } else if (NAME_IS("file")) {
+      u32 id;
+      const byte* f1 = NULL;
+      const byte* f2 = NULL;
+      usize f1len = 0, f2len = 0;
+      if (!ref_spaces(&c) || !ref_u32(&c, &id) || !ref_spaces(&c) || !ref_string(&c, &f1, &f1len))
+        continue;
+      if (ref_spaces(&c) && !ref_string(&c, &f2, &f2len))
+        f2len = 0;
+
+      char* path;
+      usize len;
+      if (f2len == 0) {
+        if (f1len == 0)
+          continue;
+        len = f1len;
+        path = malloc(len + 1);
+        if (path == NULL) abort();
+        memcpy(path, f1, f1len);
+      } else if (f2[0] == '/') {
+        len = f2len;
+        path = malloc(len + 1);
+        if (path == NULL) abort();
+        memcpy(path, f2, f2len);
+      } else {
+        len = f1len + 1 + f2len;
+        path = malloc(len + 1);
+        if (path == NULL) abort();
+        memcpy(path, f1, f1len);
+        path[f1len] = '/';
+        memcpy(path + f1len + 1, f2, f2len);
+      }
+      path[len] = '\0';
+      r->files = ref_grow(r->files, r->nfiles, sizeof(*r->files));
+      r->files[r->nfiles++] = (RefFile){ .id = id, .path = path, .len = len };
+    } else if (NAME_IS("global") || NAME_IS("globl") || NAME_IS("weak")) {
+      const byte* sym;
+      usize len;
+      if (ref_spaces(&c) && ref_symname(&c, &sym, &len))
+        ref_reference(r, sym, len);
+    } else if (NAME_IS("type")) {
+      const byte* sym;
+      const byte* type;
+      usize len, tlen;
+      if (!ref_spaces(&c) || !ref_symname(&c, &sym, &len))
+        continue;
+      ref_spaces(&c);
+      if (!ref_char(&c, ','))
+        continue;
+      ref_spaces(&c);
+      if (ref_char(&c, '"')) {
+        if (!ref_symname(&c, &type, &tlen) || !ref_char(&c, '"'))
+          continue;
+      } else {
+        if (!ref_char(&c, '#') && !ref_char(&c, '@') && !ref_char(&c, '%'))
+          continue;
+        if (!ref_symname(&c, &type, &tlen))
+          continue;
+      }
+      if (tlen == 8 && memcmp(type, "function", 8) == 0)
+        ref_reference(r, sym, len);
+    } else if (NAME_IS("data") || NAME_IS("text") || NAME_IS("section") || NAME_IS("cfi_endproc")) {
+      cur_id = cast(u32, -1);
+      cur_file = 0;
+    }
+#undef NAME_IS
+  }
+}
+
+static void ref_pass_3(
+    RefState* r)
+{
+  // order doesn't matter, the result is the closure of referenced labels
+  while (r->nstack > 0) {
+    u32 i = r->stack[--r->nstack];
+    for (; i < r->nlines; ++i) {
+      RefLine* l = &r->lines[i];
+      if (l->type == kLineInstruction || l->type == kLineDirective)
+        break;
+      if (l->type == kLineData) {
+        l->show = true;
+        ref_references(r, ref_args(r, l));
+      }
+    }
+  }
+}
+
+static void ref_parse(
+    RefState* r,
+    const byte* data,
+    u32 size)
+{
+  *r = (RefState){ .text = data, .size = size };
+  ref_pass_1(r);
+  ref_sort_labels(r);
+  ref_pass_2(r);
+  ref_pass_3(r);
+}
+
+static void ref_destroy(
+    RefState* r)
+{
+  for (u32 i = 0; i < r->nfiles; ++i)
+    free(r->files[i].path);
+  FREE(r->files);
+  FREE(r->lines);
+  FREE(r->labels);
+  FREE(r->stack);
+}
+
+// vim: sw=2 sts=2 et
@@ -0,0 +1,653 @@
+// Optimization remarks, from clang `-fsave-optimization-record` YAML or gcc `-fopt-info`
+// text. Record files of large translation units are tens of MB, mostly remarks of
+// headers and repeats of the same remark for every inlined copy, so they are streamed
+// line by line and only remarks of the wanted file are kept, once.
+//
+// Uses parse_dec, skip_spaces and find_byte from neobolt_profile.c.
+
+#include <stdio.h>
+
+enum RemarkKind {
+  kRemarkPassed = 0, ///< clang !Passed, gcc optimized
+  kRemarkMissed, ///< clang !Missed and !Failure, gcc missed
+  kRemarkAnalysis, ///< clang !Analysis*, gcc note
+
+  kRemarkKindCount,
+};
+
+static const char* const remark_kind_names[kRemarkKindCount] = {
+  "passed",
+  "missed",
+  "analysis",
+};
+
+typedef struct {
+  StrRef file; ///< In Remarks.text, shared by all remarks of one file
+  StrRef pass; ///< In Remarks.text, empty for gcc
+  StrRef function; ///< In Remarks.text, empty for gcc
+  StrRef message; ///< In Remarks.text, whitespace collapsed
+  u32 line;
+  u32 col; ///< Zero when unknown
+  u8 kind; ///< RemarkKind
+  u32 file_id; ///< Index into Remarks.files, files are in order of appearance
+  u32 hash;
+} Remark;
+
+typedef struct {
+  Remark* data;
+  u32* hash; ///< 1-based indices into `data`, zero means the slot is empty
+  u32 size; ///< `data` element count
+  u32 cap; ///< `data` allocation size
+  u32 hash_cap; ///< `hash` allocation size. Always a power of two
+  Arena text;
+  Exception exception;
+
+  String file; ///< Keep remarks of this file only, all when empty
+  u8 kinds; ///< Bit per RemarkKind to keep
+  StrRef* files; ///< Distinct file names, in `text`
+  u32 file_count;
+  u32 file_cap;
+  u32 last_file; ///< Index into `files` of the last remark
+
+  // YAML document being read, its strings are in `scratch` until it ends
+  Arena scratch;
+  bool yaml; ///< Seen a document start, the input is a YAML record
+  bool doc; ///< Inside a document of a known kind
+  bool loc; ///< Inside a multi-line DebugLoc flow mapping
+  bool args; ///< Inside Args, items are parts of the message
+  u8 kind;
+  u32 line;
+  u32 col;
+  StrRef doc_file;
+  StrRef doc_pass;
+  StrRef doc_function;
+  StrRef doc_message;
+} Remarks;
+
+#ifndef NEOBOLT_REMARKS_INITIAL_CAP
+# define NEOBOLT_REMARKS_INITIAL_CAP 256
+#endif
+#ifndef NEOBOLT_REMARKS_READ_SIZE
+# define NEOBOLT_REMARKS_READ_SIZE (1 << 20)
+#endif
+
+#define REMARKS_MAGIC "neobolt-remarks"
+
+NORETURN NOINLINE static void remarks_fail(
+    Remarks* const restrict r,
+    const char* msg,
+    const char* loc)
+{
+  r->exception.msg = msg;
+  r->exception.loc = loc;
+  longjmp(r->exception.jmpbuf, 1);
+}
+
+#define REMARKS_CHECK(cond) \
+  (LIKELY(cond) ? cast(void, 0) \
+   : remarks_fail(r, "assertion failed: " #cond, __FILE__ ":" STRINGIFY(__LINE__)))
+
+/// `file` is kept by reference, it must outlive the Remarks
+INTERFACE void neobolt_remarks_init(
+    Remarks* const restrict r,
+    String file,
+    u8 kinds)
+{
+  *r = (Remarks){ .file = file, .kinds = kinds };
+}
+
+INTERFACE void neobolt_remarks_destroy(
+    Remarks* const restrict r)
+{
+  FREE(r->data);
+  FREE(r->hash);
+  FREE(r->text.data);
+  FREE(r->scratch.data);
+  FREE(r->files);
+}
+
+static void remarks_reserve(
+    Remarks* const restrict r,
+    Arena* arena,
+    usize len)
+{
+  REMARKS_CHECK(len < UINT32_MAX - arena->top);
+  u32 need = arena->top + cast(u32, len);
+  // always one spare byte, so the data is allocated even for empty strings
+  if LIKELY (need < arena->cap)
+    return;
+  u32 ncap = nextpow2(MAX(need, 4096u));
+  REMARKS_CHECK(ncap != 0); // overflow
+  byte* ndata = realloc(arena->data, ncap);
+  REMARKS_CHECK(ndata != NULL);
+  arena->data = ndata;
+  arena->cap = ncap;
+}
+
+/// Copy a string to the text arena, trimmed and with whitespace runs collapsed
+static StrRef remarks_text(
+    Remarks* const restrict r,
+    String str)
+{
+  Arena* const self = &r->text;
+  remarks_reserve(r, self, str.len);
+  StrRef ref = { .off = self->top, .len = 0 };
+  bool space = false;
+  for (usize i = 0; i < str.len; ++i) {
+    byte ch = str.ptr[i];
+    if (is_space(ch)) {
+      space = ref.len > 0;
+      continue;
+    }
+    if (space)
+      self->data[ref.off + ref.len++] = ' ';
+    self->data[ref.off + ref.len++] = ch;
+    space = false;
+  }
+  self->top += ref.len;
+  return ref;
+}
+
+static void remarks_rehash(
+    Remarks* const restrict r,
+    u32 ncap)
+{
+  u32* nhash = calloc(ncap, sizeof(*nhash));
+  REMARKS_CHECK(nhash != NULL);
+  for (u32 i = 0; i < r->size; ++i) {
+    u32 slot = r->data[i].hash & (ncap - 1);
+    while (nhash[slot] != 0)
+      slot = (slot + 1) & (ncap - 1);
+    nhash[slot] = i + 1;
+  }
+  free(r->hash);
+  r->hash = nhash;
+  r->hash_cap = ncap;
+}
+
+static bool remark_eq(
+    const Remarks* const restrict r,
+    const Remark* a,
+    const Remark* b)
+{
+  return a->line == b->line && a->col == b->col && a->kind == b->kind
+      && a->file_id == b->file_id
+      && STREQ(STR(r->text.data, a->pass), STR(r->text.data, b->pass))
+      && STREQ(STR(r->text.data, a->message), STR(r->text.data, b->message));
+}
+
+/// Index of a file name in Remarks.files, added if new. Remarks come in runs of one
+/// file, and without a file filter there are a few hundred headers at most.
+static u32 remarks_file(
+    Remarks* const restrict r,
+    String file)
+{
+  if (r->last_file < r->file_count && STREQ(file, STR(r->text.data, r->files[r->last_file])))
+    return r->last_file;
+  for (u32 i = r->file_count; i-- > 0;) {
+    if (STREQ(file, STR(r->text.data, r->files[i])))
+      return r->last_file = i;
+  }
+
+  if UNLIKELY (r->file_count == r->file_cap) {
+    u32 ncap = r->file_cap == 0 ? 16 : r->file_cap << 1;
+    REMARKS_CHECK(ncap != 0); // overflow
+    StrRef* nfiles = realloc(r->files, cast(usize, ncap) * sizeof(*nfiles));
+    REMARKS_CHECK(nfiles != NULL);
+    r->files = nfiles;
+    r->file_cap = ncap;
+  }
+  // stored as is, so that lookups compare equal
+  remarks_reserve(r, &r->text, file.len);
+  StrRef ref = { .off = r->text.top, .len = cast(u32, file.len) };
+  if (file.len > 0)
+    memcpy(r->text.data + ref.off, file.ptr, file.len);
+  r->text.top += ref.len;
+  r->files[r->file_count] = ref;
+  return r->last_file = r->file_count++;
+}
+
+/// Add a remark, unless filtered out or already there
+static void remarks_add(
+    Remarks* const restrict r,
+    u8 kind,
+    String file,
+    u32 line,
+    u32 col,
+    String pass,
+    String function,
+    String message)
+{
+  if (kind >= kRemarkKindCount || !(r->kinds & (1u << kind)) || line == 0)
+    return;
+  if (r->file.len > 0 && !STREQ(file, r->file))
+    return;
+
+  u32 file_id = remarks_file(r, file);
+  u32 top = r->text.top;
+  Remark remark = {
+    .file = r->files[file_id],
+    .file_id = file_id,
+    .pass = remarks_text(r, pass),
+    .function = remarks_text(r, function),
+    .message = remarks_text(r, message),
+    .line = line,
+    .col = col,
+    .kind = kind,
+  };
+  if (remark.message.len == 0) {
+    r->text.top = top;
+    return;
+  }
+  String text = STR(r->text.data, remark.message);
+  remark.hash = fnv1a(text) ^ (line * 0x9E3779B1u) ^ (col << 8) ^ kind;
+
+  if UNLIKELY ((r->size + 1) * 2 > r->hash_cap)
+    remarks_rehash(r, r->hash_cap == 0 ? 2 * NEOBOLT_REMARKS_INITIAL_CAP : r->hash_cap << 1);
+  u32 slot = remark.hash & (r->hash_cap - 1);
+  for (u32 idx; (idx = r->hash[slot]) != 0; slot = (slot + 1) & (r->hash_cap - 1)) {
+    const Remark* other = &r->data[idx - 1];
+    if (other->hash == remark.hash && remark_eq(r, other, &remark)) {
+      // the same remark for another inlined copy
+      r->text.top = top;
+      return;
+    }
+  }
+
+  if UNLIKELY (r->size == r->cap) {
+    u32 ncap = r->cap == 0 ? NEOBOLT_REMARKS_INITIAL_CAP : r->cap << 1;
+    REMARKS_CHECK(ncap != 0); // overflow
+    Remark* ndata = realloc(r->data, cast(usize, ncap) * sizeof(*ndata));
+    REMARKS_CHECK(ndata != NULL);
+    r->data = ndata;
+    r->cap = ncap;
+  }
+  r->data[r->size++] = remark;
+  r->hash[slot] = r->size;
+}
+
+/// Copy a YAML scalar to the scratch arena, appending to what's there. In a flow
+/// mapping, plain scalars end at `,` and `}`.
+static StrRef remarks_scalar(
+    Remarks* const restrict r,
+    const byte** p,
+    const byte* end,
+    bool flow)
+{
+  Arena* const self = &r->scratch;
+  skip_spaces(p, end);
+  const byte* q = *p;
+  remarks_reserve(r, self, cast(usize, end - q));
+  StrRef ref = { .off = self->top, .len = 0 };
+  byte* out = self->data + self->top;
+
+  if (q < end && *q == '\'') {
+    // '' is a quote, nothing else is escaped
+    for (++q; q < end; ++q) {
+      if (*q == '\'') {
+        if (q + 1 < end && q[1] == '\'')
+          ++q;
+        else {
+          ++q;
+          break;
+        }
+      }
+      out[ref.len++] = *q;
+    }
+  } else if (q < end && *q == '"') {
+    for (++q; q < end && *q != '"'; ++q) {
+      if (*q == '\\' && q + 1 < end) {
+        ++q;
+        out[ref.len++] = *q == 'n' || *q == 't' ? ' ' : *q;
+      } else {
+        out[ref.len++] = *q;
+      }
+    }
+    if (q < end)
+      ++q;
+  } else {
+    while (q < end && !(flow && (*q == ',' || *q == '}')))
+      out[ref.len++] = *q++;
+    while (ref.len > 0 && is_space(out[ref.len - 1]))
+      --ref.len;
+  }
+
+  self->top += ref.len;
+  *p = q;
+  return ref;
+}
+
+/// `{ File: a.c, Line: 5, Column: 10 }`, possibly wrapped over several lines
+static void remarks_debug_loc(
+    Remarks* const restrict r,
+    const byte* q,
+    const byte* end)
+{
+  r->loc = true;
+  while (q < end) {
+    skip_spaces(&q, end);
+    if (q == end)
+      break;
+    if (*q == '{' || *q == ',') {
+      ++q;
+      continue;
+    }
+    if (*q == '}') {
+      r->loc = false;
+      break;
+    }
+    const byte* colon = find_byte(q, end, ':');
+    String key = { q, cast(usize, colon - q) };
+    if (colon == end)
+      break;
+    q = colon + 1;
+    skip_spaces(&q, end);
+    u64 value = 0;
+    if (STRTEST(key, "File")) {
+      r->doc_file = remarks_scalar(r, &q, end, true);
+    } else if (STRTEST(key, "Line") && parse_dec(&q, end, &value)) {
+      r->line = cast(u32, MIN(value, UINT32_MAX));
+    } else if (STRTEST(key, "Column") && parse_dec(&q, end, &value)) {
+      r->col = cast(u32, MIN(value, UINT32_MAX));
+    } else {
+      remarks_scalar(r, &q, end, true);
+    }
+  }
+}
+
+static void remarks_doc_end(
+    Remarks* const restrict r)
+{
+  if (r->doc) {
+    const byte* base = r->scratch.data;
+    remarks_add(r, r->kind, STR(base, r->doc_file), r->line, r->col,
+        STR(base, r->doc_pass), STR(base, r->doc_function), STR(base, r->doc_message));
+  }
+  r->doc = false;
+  r->loc = false;
+  r->args = false;
+}
+
+/// Line of a clang YAML record, false when it isn't one
+static bool remarks_yaml_line(
+    Remarks* const restrict r,
+    const byte* q,
+    const byte* end)
+{
+  String line = { q, cast(usize, end - q) };
+  if (line.len >= 5 && memcmp(q, "--- !", 5) == 0) {
+    remarks_doc_end(r);
+    r->yaml = true;
+    String tag = { q + 5, line.len - 5 };
+    while (tag.len > 0 && is_space(tag.ptr[tag.len - 1]))
+      --tag.len;
+    if (STRTEST(tag, "Passed"))
+      r->kind = kRemarkPassed;
+    else if (STRTEST(tag, "Missed") || STRTEST(tag, "Failure"))
+      r->kind = kRemarkMissed;
+    else if (tag.len >= 8 && memcmp(tag.ptr, "Analysis", 8) == 0)
+      r->kind = kRemarkAnalysis;
+    else
+      return true; // some other record, skipped up to the next one
+    r->doc = true;
+    r->scratch.top = 0;
+    r->line = r->col = 0;
+    r->doc_file = r->doc_pass = r->doc_function = r->doc_message = (StrRef){0};
+    return true;
+  }
+  if (STRTEST(line, "...")) {
+    remarks_doc_end(r);
+    return true;
+  }
+  if (!r->doc)
+    return r->yaml;
+
+  if (r->loc) {
+    remarks_debug_loc(r, q, end);
+    return true;
+  }
+  if (q < end && !is_space(*q)) {
+    // top-level key
+    r->args = false;
+    const byte* colon = find_byte(q, end, ':');
+    String key = { q, cast(usize, colon - q) };
+    if (colon == end)
+      return true;
+    q = colon + 1;
+    if (STRTEST(key, "Pass")) {
+      r->doc_pass = remarks_scalar(r, &q, end, false);
+    } else if (STRTEST(key, "Function")) {
+      r->doc_function = remarks_scalar(r, &q, end, false);
+    } else if (STRTEST(key, "DebugLoc")) {
+      remarks_debug_loc(r, q, end);
+    } else if (STRTEST(key, "Args")) {
+      r->args = true;
+      r->doc_message = (StrRef){ .off = r->scratch.top, .len = 0 };
+    }
+    return true;
+  }
+  if (!r->args)
+    return true;
+
+  // `  - String: ' will not be inlined into '`, deeper lines are the DebugLoc of an
+  // argument and such
+  skip_spaces(&q, end);
+  if (end - q < 2 || q[0] != '-' || !is_space(q[1]))
+    return true;
+  q += 2;
+  skip_spaces(&q, end);
+  const byte* colon = find_byte(q, end, ':');
+  if (colon == end)
+    return true;
+  q = colon + 1;
+  skip_spaces(&q, end);
+  if (q < end && *q == '{')
+    return true; // DebugLoc of an argument
+  StrRef part = remarks_scalar(r, &q, end, false);
+  // parts are appended to the message, nothing else gets into scratch meanwhile
+  REMARKS_CHECK(part.off == r->doc_message.off + r->doc_message.len);
+  r->doc_message.len += part.len;
+  return true;
+}
+
+/// gcc `file:line:col: kind: message`
+static void remarks_gcc_line(
+    Remarks* const restrict r,
+    const byte* start,
+    const byte* end)
+{
+  // the file name can have colons, `C:\a.c:5:3:`, the location is the first :N:
+  for (const byte* colon = find_byte(start, end, ':'); colon < end;
+       colon = find_byte(colon + 1, end, ':')) {
+    const byte* q = colon + 1;
+    u64 line = 0, col = 0;
+    if (!parse_dec(&q, end, &line) || q == end || *q != ':')
+      continue;
+    ++q;
+    if (parse_dec(&q, end, &col)) {
+      if (q == end || *q != ':')
+        continue;
+      ++q;
+    }
+    skip_spaces(&q, end);
+    const byte* kind_end = find_byte(q, end, ':');
+    String kind_name = { q, cast(usize, kind_end - q) };
+    u8 kind;
+    if (STRTEST(kind_name, "optimized"))
+      kind = kRemarkPassed;
+    else if (STRTEST(kind_name, "missed"))
+      kind = kRemarkMissed;
+    else if (STRTEST(kind_name, "note"))
+      kind = kRemarkAnalysis;
+    else
+      return;
+    q = kind_end < end ? kind_end + 1 : end;
+    String none = { q, 0 };
+    remarks_add(r, kind, (String){ start, cast(usize, colon - start) },
+        cast(u32, MIN(line, UINT32_MAX)), cast(u32, MIN(col, UINT32_MAX)),
+        none, none, (String){ q, cast(usize, end - q) });
+    return;
+  }
+}
+
+static void remarks_line(
+    Remarks* const restrict r,
+    const byte* q,
+    const byte* end)
+{
+  if (end > q && end[-1] == '\r')
+    --end;
+  if (!remarks_yaml_line(r, q, end))
+    remarks_gcc_line(r, q, end);
+}
+
+static int remark_cmp(
+    const void* a_,
+    const void* b_)
+{
+  const Remark* a = a_;
+  const Remark* b = b_;
+  if (a->file_id != b->file_id)
+    return a->file_id < b->file_id ? -1 : 1;
+  if (a->line != b->line)
+    return a->line < b->line ? -1 : 1;
+  if (a->col != b->col)
+    return a->col < b->col ? -1 : 1;
+  return (a->kind > b->kind) - (a->kind < b->kind);
+}
+
+/// Sort by file (in order of appearance), line and column
+static void remarks_finish(
+    Remarks* const restrict r)
+{
+  FREE(r->hash);
+  r->hash_cap = 0;
+  FREE(r->scratch.data);
+  r->scratch = (Arena){0};
+  if (r->size > 1)
+    qsort(r->data, r->size, sizeof(*r->data), remark_cmp);
+}
+
+/// Read a YAML record or gcc -fopt-info output. Lines longer than the read buffer
+/// are skipped.
+INTERFACE bool neobolt_remarks_load(
+    Remarks* const restrict r,
+    FILE* file)
+{
+  byte* buf = NULL;
+  if (setjmp(r->exception.jmpbuf) != 0) {
+    free(buf);
+    return false;
+  }
+
+  buf = malloc(NEOBOLT_REMARKS_READ_SIZE);
+  REMARKS_CHECK(buf != NULL);
+  usize size = 0;
+  bool skip = false; // rest of a line longer than the buffer
+  for (;;) {
+    usize n = fread(buf + size, 1, NEOBOLT_REMARKS_READ_SIZE - size, file);
+    if (n == 0) {
+      REMARKS_CHECK(!ferror(file));
+      if (size > 0 && !skip)
+        remarks_line(r, buf, buf + size);
+      break;
+    }
+    size += n;
+
+    const byte* line = buf;
+    const byte* end = buf + size;
+    for (const byte* eol; (eol = memchr(line, EOL, cast(usize, end - line))) != NULL; line = eol + 1) {
+      if (!skip)
+        remarks_line(r, line, eol);
+      skip = false;
+    }
+    size = cast(usize, end - line);
+    if (size == NEOBOLT_REMARKS_READ_SIZE) {
+      size = 0;
+      skip = true;
+    } else {
+      memmove(buf, line, size);
+    }
+  }
+  remarks_doc_end(r);
+
+  free(buf);
+  remarks_finish(r);
+  return true;
+}
+
+/// Compact form of loaded remarks, read back by neobolt_remarks_read: a header line,
+/// then `kind\tline\tcol\tfile\tpass\tfunction\tmessage` lines. Strings have no tabs
+/// or newlines, whitespace is collapsed.
+INTERFACE bool neobolt_remarks_save(
+    Remarks* const restrict r,
+    byte** res,
+    usize* res_len)
+{
+  byte* out = NULL;
+  if (setjmp(r->exception.jmpbuf) != 0) {
+    free(out);
+    return false;
+  }
+
+  usize len = 0;
+  usize cap = 64;
+  for (u32 i = 0; i < r->size; ++i) {
+    const Remark* remark = &r->data[i];
+    cap += 32 + remark->file.len + remark->pass.len + remark->function.len + remark->message.len;
+  }
+  out = malloc(cap);
+  REMARKS_CHECK(out != NULL);
+  len += cast(usize, snprintf(cast(char*, out), cap, REMARKS_MAGIC "\n"));
+  for (u32 i = 0; i < r->size; ++i) {
+    const Remark* remark = &r->data[i];
+    String file = STR(r->text.data, remark->file);
+    String pass = STR(r->text.data, remark->pass);
+    String function = STR(r->text.data, remark->function);
+    String message = STR(r->text.data, remark->message);
+    len += cast(usize, snprintf(cast(char*, out + len), cap - len, "%u\t%u\t%u\t%.*s\t%.*s\t%.*s\t%.*s\n",
+                                cast(unsigned, remark->kind), cast(unsigned, remark->line),
+                                cast(unsigned, remark->col),
+                                cast(int, file.len), file.ptr,
+                                cast(int, pass.len), pass.ptr,
+                                cast(int, function.len), function.ptr,
+                                cast(int, message.len), message.ptr));
+  }
+
+  *res = out;
+  *res_len = len;
+  return true;
+}
+
+INTERFACE bool neobolt_remarks_read(
+    Remarks* const restrict r,
+    String data)
+{
+  if (setjmp(r->exception.jmpbuf) != 0)
+    return false;
+
+  const byte* q = data.ptr;
+  const byte* end = data.ptr + data.len;
+  const byte* eol = find_byte(q, end, EOL);
+  REMARKS_CHECK(STRTEST(((String){ q, cast(usize, eol - q) }), REMARKS_MAGIC));
+
+  for (q = eol + 1; q < end; q = eol + 1) {
+    eol = find_byte(q, end, EOL);
+    u64 kind, line, col;
+    REMARKS_CHECK(parse_dec(&q, eol, &kind) && kind < kRemarkKindCount && q < eol && *q++ == '\t');
+    REMARKS_CHECK(parse_dec(&q, eol, &line) && line <= UINT32_MAX && q < eol && *q++ == '\t');
+    REMARKS_CHECK(parse_dec(&q, eol, &col) && col <= UINT32_MAX && q < eol && *q++ == '\t');
+    String fields[4];
+    for (int i = 0; i < 4; ++i) {
+      const byte* tab = i < 3 ? find_byte(q, eol, '\t') : eol;
+      REMARKS_CHECK(tab < eol || i == 3);
+      fields[i] = (String){ q, cast(usize, tab - q) };
+      q = tab + 1;
+    }
+    remarks_add(r, cast(u8, kind), fields[0], cast(u32, line), cast(u32, col),
+        fields[1], fields[2], fields[3]);
+  }
+
+  remarks_finish(r);
+  return true;
+}